@@ -45,7 +45,9 @@ int main(void)
 {
     init();
 
-    _delay_ms(1000);     // wait a bit for slave to initialize before sending commands
+    // wait for slave to initialize before sending commands, slave answers with [READY_CHAR] when it is ready
+    SPI_device_t slave = {&SPI_PORTx, SS_PIN_PORTxn, DEFAULT_SS_CONTROL, 0, 0};
+    SPI_waitReady(&slave, 1000);
 
     while(1)
     {
@@ -39,6 +39,8 @@ static void init()
     LED_DDRx |= (1 << LED_PORTxn);     // set led pin as output
 
     sei();                             // enable global interrupts since this library implements interrupt driven SPI communication
+
+    SPI_slaveReady();                  // let master know that slave is initialized
 }
 
 int main(void)
@@ -0,0 +1,112 @@
+/**
+ * @file AVR_SPI_bmi160.h
+ * @author Lukas Ternjej
+ *
+ * Header file for BMI160 IMU driver on master side.
+ * Sensor buffers accelerometer and gyroscope samples in its FIFO and signals a watermark on INT1 pin,
+ * which is connected to INT0 or INT1 of the microcontroller. Driver drains the whole FIFO in a single
+ * burst into a sample ring, instead of reading data registers one at a time.
+ ** Enable SPI_USE_ATTENTION_INT0 or SPI_USE_ATTENTION_INT1 in AVR_SPI_feature_defines.h for the used interrupt.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_BMI160_H_
+#define AVR_SPI_BMI160_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+// registers
+#define BMI160_READ          0x80     // set in register address for read access
+#define BMI160_CHIP_ID       0x00
+#define BMI160_FIFO_LENGTH   0x22     // 11-bit FIFO fill level in bytes, 2 registers
+#define BMI160_FIFO_DATA     0x24     // burst read of this register streams FIFO content
+#define BMI160_ACC_CONF      0x40
+#define BMI160_ACC_RANGE     0x41
+#define BMI160_GYR_CONF      0x42
+#define BMI160_GYR_RANGE     0x43
+#define BMI160_FIFO_CONFIG_0 0x46     // watermark level, in 4 byte units
+#define BMI160_FIFO_CONFIG_1 0x47
+#define BMI160_INT_EN_1      0x51
+#define BMI160_INT_OUT_CTRL  0x53
+#define BMI160_INT_MAP_1     0x56
+#define BMI160_CMD           0x7E
+#define BMI160_SPI_MODE      0x7F     // dummy read of this register switches interface to SPI after reset
+
+#define BMI160_CHIP_ID_VALUE 0xD1
+
+// commands, written to BMI160_CMD
+#define BMI160_CMD_ACC_NORMAL 0x11
+#define BMI160_CMD_GYR_NORMAL 0x15
+#define BMI160_CMD_FIFO_FLUSH 0xB0
+#define BMI160_CMD_SOFTRESET  0xB6
+
+// output data rates, for accelerometer and gyroscope
+#define BMI160_ODR_100HZ  0x08
+#define BMI160_ODR_200HZ  0x09
+#define BMI160_ODR_400HZ  0x0A
+#define BMI160_ODR_800HZ  0x0B
+#define BMI160_ODR_1600HZ 0x0C
+
+#define BMI160_FRAME_LENGTH 12     // headerless FIFO frame: gyroscope x, y, z, accelerometer x, y, z
+#define BMI160_RING_LENGTH  16     // number of samples in driver sample ring
+
+/**
+ * Structure that holds a single sample, in sensor units.
+ ** Layout matches a headerless FIFO frame on little-endian AVR, so frames are read directly into samples.
+ */
+typedef struct
+{
+    int16_t gyro[3];
+    int16_t accel[3];
+} SPI_imuSample_t;
+
+/**
+ * Structure that holds driver state of a single sensor.
+ */
+typedef struct
+{
+    SPI_device_t *device;                          // sensor on SPI bus
+    uint8_t interrupt;                             // ATTENTION_INT0 or ATTENTION_INT1, connected to sensor INT1 pin
+    uint8_t watermark;                             // number of samples that trigger the interrupt
+    SPI_imuSample_t ring[BMI160_RING_LENGTH];      // samples, oldest first from head
+    uint8_t head;                                  // index of oldest sample
+    uint8_t count;                                 // number of samples in ring
+    uint16_t overruns;                             // samples overwritten before they were read
+    uint16_t bursts;                               // number of FIFO drains
+} SPI_bmi160_t;
+
+/**
+ * Function that resets the sensor, starts accelerometer and gyroscope in normal mode, and enables FIFO watermark interrupt.
+ *! Blocks for about 100ms, while sensor starts up.
+ *
+ * @param imu driver state
+ * @param device sensor on SPI bus
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1, connected to sensor INT1 pin
+ * @param odr BMI160_ODR_100HZ - BMI160_ODR_1600HZ
+ * @param watermark number of samples that trigger the interrupt, 2 - BMI160_RING_LENGTH
+ * @return true if sensor responded with its chip ID; else, return false
+ */
+bool SPI_bmi160Init(SPI_bmi160_t *imu, SPI_device_t *device, uint8_t interrupt, uint8_t odr, uint8_t watermark);
+
+/**
+ * Function that drains sensor FIFO into the sample ring in a single burst, if watermark interrupt has been triggered.
+ * Samples that arrive during the burst are drained with another burst until FIFO is below the watermark,
+ * so INT1 is released and the next watermark gives a new falling edge.
+ ** Call this function from the main loop, between other bus work.
+ *
+ * @param imu driver state
+ * @return number of samples read from FIFO
+ */
+uint8_t SPI_bmi160Service(SPI_bmi160_t *imu);
+
+/**
+ * Function that takes the oldest sample from the sample ring.
+ *
+ * @param imu driver state
+ * @param sample where sample is stored
+ * @return true if sample is available; else, return false
+ */
+bool SPI_bmi160Read(SPI_bmi160_t *imu, SPI_imuSample_t *sample);
+
+#endif
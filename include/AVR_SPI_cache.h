@@ -0,0 +1,114 @@
+/**
+ * @file AVR_SPI_cache.h
+ * @author Lukas Ternjej
+ *
+ * Header file for RAM block cache between storage drivers (SPI flash, EEPROM, SD card) and the bus.
+ * Storage is divided in blocks of CACHE_BLOCK_LENGTH bytes; CACHE_LINES blocks are kept in RAM with
+ * LRU replacement. Writes are kept in RAM until the block is evicted or SPI_cacheFlush() is called,
+ * and sequential reads load following blocks in the same storage transaction (read-ahead).
+ * Blocks of a sequential stream are evicted first, so a long stream doesn't push out frequently used blocks;
+ * a stream block that is used again after the stream moved on becomes an ordinary LRU block.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_CACHE_H_
+#define AVR_SPI_CACHE_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+#ifndef CACHE_LINES
+    #define CACHE_LINES 4            // number of blocks kept in RAM, 2 - 255
+#endif
+
+#ifndef CACHE_BLOCK_LENGTH
+    #define CACHE_BLOCK_LENGTH 32    // bytes per block, power of 2 and not larger than storage page
+#endif
+
+#define CACHE_NO_BLOCK 0xFFFFFFFF     // block number that is never used, so no access matches it
+
+/**
+ * Structure that holds a single cached block.
+ */
+typedef struct
+{
+    uint32_t block;                       // storage address / CACHE_BLOCK_LENGTH
+    uint8_t rank;                         // 0 for most recently used line, CACHE_LINES - 1 for least recently used
+    bool valid;                           // line holds a block
+    bool dirty;                           // line was written and isn't stored yet
+    bool ahead;                           // block was read ahead and hasn't been used yet
+    bool stream;                          // block was loaded by a sequential stream, it stays at the LRU end while the stream reads it
+    uint8_t data[CACHE_BLOCK_LENGTH];
+} SPI_cacheLine_t;
+
+/**
+ * Structure that holds cache state of a single storage device.
+ * Storage driver provides read and write functions; storage pointer is passed to them unchanged.
+ */
+typedef struct
+{
+    void *storage;                                                                           // storage driver state
+    bool (*read)(void *storage, uint32_t address, uint8_t *blocks[], uint8_t count);         // reads count consecutive blocks in a single transaction
+    bool (*write)(void *storage, uint32_t address, const uint8_t block[]);                   // writes a single block, NULL for read-only storage
+    uint8_t readAhead;                                                                       // blocks loaded after a sequential miss, 0 disables read-ahead
+    uint32_t nextBlock;                                                                      // block after the last loaded block, miss on it is sequential
+    uint32_t streamBlock;                                                                    // block that the sequential stream reads, hit on another stream block promotes it
+    SPI_cacheLine_t lines[CACHE_LINES];
+    uint32_t hits;                                                                           // accesses served from RAM
+    uint32_t misses;                                                                         // accesses that loaded a block
+    uint32_t aheadBlocks;                                                                    // blocks loaded by read-ahead
+    uint32_t aheadHits;                                                                      // read-ahead blocks that were used
+    uint32_t writeBacks;                                                                     // dirty blocks written to storage
+} SPI_cache_t;
+
+/**
+ * Function that sets up an empty cache for a storage device.
+ *
+ * @param cache cache state
+ * @param storage storage driver state, passed to read and write functions
+ * @param read function that reads consecutive blocks in a single transaction
+ * @param write function that writes a single block, NULL for read-only storage
+ * @param readAhead number of blocks loaded after a sequential miss, 0 - CACHE_LINES / 2 - 1; a stream takes at most half of the lines
+ */
+void SPI_cacheInit(SPI_cache_t *cache, void *storage, bool (*read)(void *, uint32_t, uint8_t *[], uint8_t),
+                   bool (*write)(void *, uint32_t, const uint8_t[]), uint8_t readAhead);
+
+/**
+ * Function that reads bytes from storage through the cache.
+ *
+ * @param cache cache state
+ * @param address storage address of the first byte
+ * @param buffer array where bytes are stored
+ * @param numBytes number of bytes
+ * @return true if bytes are read; else, return false (storage read or write-back failed)
+ */
+bool SPI_cacheRead(SPI_cache_t *cache, uint32_t address, uint8_t buffer[], uint16_t numBytes);
+
+/**
+ * Function that writes bytes to the cache. Blocks are written to storage when they are evicted or flushed.
+ *
+ * @param cache cache state
+ * @param address storage address of the first byte
+ * @param data array of bytes that are going to be written
+ * @param numBytes number of bytes
+ * @return true if bytes are written; else, return false (read-only storage, storage read or write-back failed)
+ */
+bool SPI_cacheWrite(SPI_cache_t *cache, uint32_t address, const uint8_t data[], uint16_t numBytes);
+
+/**
+ * Function that writes all dirty blocks to storage. Blocks stay cached.
+ ** Call this function before power down or before storage is accessed without the cache.
+ *
+ * @param cache cache state
+ * @return true if all dirty blocks are written; else, return false
+ */
+bool SPI_cacheFlush(SPI_cache_t *cache);
+
+/**
+ * Function that drops all cached blocks without writing them, for example after storage was erased.
+ *
+ * @param cache cache state
+ */
+void SPI_cacheInvalidate(SPI_cache_t *cache);
+
+#endif
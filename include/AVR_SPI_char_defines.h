@@ -12,6 +12,31 @@
 
 #define DATA_END_CHAR 0x0D                // String message end character, 0x0D is carriage return (CR)
 #define DATA_LENGTH   50 + 1              // Mximum data in a message + end character
+#define DUMMY_CHAR    0xFF                // Byte that master writes to SPDR to generate SCK when reading from slave
+#define READY_CHAR    0xA5                // Byte that slave shifts out when idle, after it has signalled it is ready
+#define ESCAPE_CHAR   0x1B                // Precedes a data byte that would otherwise equal a control character, 0x1B is escape (ESC)
+#define ESCAPE_XOR    0x20                // Escaped data byte is sent xored with ESCAPE_XOR
+
+#define CIPHER_NONCE_CHAR 0x16            // Starts an encryption session message with the nonce, 0x16 is synchronous idle (SYN)
+
+#define STREAM_SYNC_CHAR 0x7E             // Starts a frame in stream mode, 0x7E is HDLC flag
+
+#define STATS_QUERY_CHAR        0x05      // Reserved message that queries slave statistics, 0x05 is enquiry (ENQ)
+#define STATS_LENGTH            7         // Number of bytes in statistics block
+#define STATS_RESPONSE_DELAY_US 20        // Time that master gives slave to queue statistics block
+
+#define ID_QUERY_CHAR           0x06      // Reserved message that queries slave device ID
+#define ID_RESPONSE_DELAY_US    20        // Time that master gives slave to queue its device ID
+
+#define READY_BACKOFF_MAX_MS 16           // Maximum delay between two ready polls on master side
+
+#define RESPONSE_QUEUE_LENGTH 16          // Maximum number of response bytes that slave can queue for master
+
+#define HUB_HEADER_CHAR 0x80              // First byte of a message that hub forwards downstream, hub port number is added to it
+
+#define FRAME_POOL_LENGTH 4               // Number of receive frames in frame pool, each takes DATA_LENGTH + 2 bytes of RAM
+
+#define DEDUP_CHANNELS 8                  // Number of channels (first message byte) that duplicate filter tracks, power of 2
 
 extern uint8_t SPI_data[DATA_LENGTH];     // Array for storing incoming SPI data
 
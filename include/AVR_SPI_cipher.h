@@ -0,0 +1,153 @@
+/**
+ * @file AVR_SPI_cipher.h
+ * @author Lukas Ternjej
+ *
+ * Header file for XTEA-CTR payload encryption.
+ * Keystream is precomputed in idle time with SPI_cipherRefill(), so encrypting
+ * or decrypting a byte while it is fed to (or read from) SPDR costs a single XOR.
+ * Counter block is nonce (fresh every session) and block counter; every message starts at a new block.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_CIPHER_H_
+#define AVR_SPI_CIPHER_H_
+
+#include <avr/eeprom.h>
+
+#include "AVR_SPI_with_interrupts.h"
+
+#define CIPHER_BLOCK_LENGTH     8      // XTEA block size in bytes
+#define CIPHER_KEYSTREAM_LENGTH 64     // precomputed keystream bytes, power of two and a multiple of CIPHER_BLOCK_LENGTH
+#define CIPHER_NONCE_LENGTH     4      // nonce bytes in a session start message
+#define CIPHER_SYNC_LENGTH      3      // block counter (2 bytes) and its check byte, sent in clear at the start of every encrypted message
+
+// check byte of block counter, a damaged block counter would move slave keystream away from master
+#define CIPHER_SYNC_CHECK(block) ((uint8_t)~(((block) >> 8) ^ (block)))
+
+/**
+ * Structure that holds cipher state of one SPI link. Master uses one per slave device, slave uses one for itself.
+ * Master starts every session with a fresh nonce (SPI_transmitNonce()); every message starts at a new keystream block
+ * and carries its block counter, so slave resynchronizes after a lost or damaged message.
+ */
+typedef struct
+{
+    uint32_t key[4];                                // 128 bit XTEA key
+    uint32_t nonce;                                 // per-session nonce, high half of counter block
+    uint32_t counter;                               // counter of the next block that is computed into keystream ring
+    uint8_t keystream[CIPHER_KEYSTREAM_LENGTH];     // precomputed keystream ring
+    volatile uint8_t head;                          // index of next keystream byte
+    volatile uint8_t count;                         // number of precomputed keystream bytes
+    volatile bool started;                          // session has a nonce, keystream can be computed
+    volatile uint16_t underruns;                    // messages dropped on slave side because keystream wasn't precomputed
+    volatile uint16_t resyncs;                      // messages whose block counter didn't follow the previous message
+} SPI_cipher_t;
+
+/**
+ * Function that initializes cipher state with a key. Keystream is computed after a session is started:
+ * with SPI_transmitNonce() on master side, when the session start message is received on slave side.
+ *
+ * @param cipher cipher state
+ * @param key 128 bit key
+ */
+void SPI_cipherInit(SPI_cipher_t *cipher, const uint32_t key[4]);
+
+/**
+ * Function that returns a nonce that hasn't been used with the key, from a boot counter in EEPROM that is
+ * incremented on every call. Master calls it once per session (for example after every reset).
+ *! Keystream repeats if a nonce is used twice with the same key, so the counter must never be reset while the key is used!
+ *
+ * @param bootCounter boot counter in EEPROM, declared with EEMEM
+ * @return fresh nonce
+ */
+uint32_t SPI_cipherSessionNonce(uint32_t *bootCounter);
+
+/**
+ * Function that precomputes keystream blocks until keystream ring is full. Call this function in idle time.
+ * Keystream is only computed here and on master side while transmitting, never in ISR routine.
+ *
+ * @param cipher cipher state
+ */
+void SPI_cipherRefill(SPI_cipher_t *cipher);
+
+/**
+ * Function that computes a single keystream block into keystream ring. Block that was computed while ISR routine
+ * restarted or resynchronized the keystream is discarded.
+ *
+ * @param cipher cipher state
+ */
+void SPI_cipherBlock(SPI_cipher_t *cipher);
+
+/**
+ * Function that moves keystream to the start of a block, where a message starts. Rest of the block that the previous
+ * message ended in is skipped. It doesn't compute blocks, so it can be called from ISR routine.
+ *
+ * @param cipher cipher state
+ * @param block low bits of the block counter that the message starts at
+ * @return true if keystream is at the block; false if block is behind keystream (repeated or stale message), or
+ * isn't precomputed yet (keystream ring continues from the block after the next refill)
+ */
+bool SPI_cipherSeek(SPI_cipher_t *cipher, uint16_t block);
+
+/**
+ * Function that starts a new session on slave side, called from ISR routine when session start message is received.
+ * Keystream ring is emptied and computed again by SPI_cipherRefill() in the main loop.
+ *
+ * @param cipher cipher state
+ * @param nonce nonce of the session
+ */
+void SPI_cipherRestart(SPI_cipher_t *cipher, uint32_t nonce);
+
+/**
+ * Function that returns next keystream byte. Caller checks that keystream isn't empty (count != 0).
+ *
+ * @param cipher cipher state
+ * @return keystream byte
+ */
+static inline uint8_t SPI_cipherNext(SPI_cipher_t *cipher)
+{
+    uint8_t key = cipher->keystream[cipher->head];
+    cipher->head = (cipher->head + 1) & (CIPHER_KEYSTREAM_LENGTH - 1);
+    cipher->count--;
+
+    return key;
+}
+
+/**
+ * Function that sets cipher state that slave uses to decrypt received messages in ISR routine.
+ * Slave has to be built with SPI_USE_CIPHER enabled.
+ *
+ * @param cipher cipher state, NULL to receive plain messages
+ */
+void SPI_cipherAttach(SPI_cipher_t *cipher);
+
+/**
+ * Function that starts a session: master cipher state restarts at block 0 with the nonce, and the nonce is sent to
+ * slave in clear as [CIPHER_NONCE_CHAR] message. Slave main loop needs time to refill keystream before the next
+ * encrypted message, messages that arrive earlier are dropped and counted in underruns.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param cipher cipher state of the slave device
+ * @param nonce fresh nonce, from SPI_cipherSessionNonce()
+ */
+void SPI_transmitNonce(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, SPI_cipher_t *cipher, uint32_t nonce);
+
+/**
+ * Function for transmitting an encrypted string of chars via SPI, with SS line control.
+ * Message starts with its keystream block counter and check byte in clear, followed by the encrypted string.
+ * Bytes that equal [DATA_END_CHAR], [DUMMY_CHAR], [ESCAPE_CHAR] or [CIPHER_NONCE_CHAR] are sent as [ESCAPE_CHAR], byte ^ [ESCAPE_XOR].
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param cipher cipher state of the slave device
+ * @param data char pointer that pints to an array element (string), for transmissio via SPI
+ * @return false if session hasn't been started with SPI_transmitNonce(), nothing is sent; else, return true
+ */
+bool SPI_transmitStringEncrypted(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, SPI_cipher_t *cipher, char *data);
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file AVR_SPI_feature_defines.h
+ * @author Lukas Ternjej
+ *
+ * Header file for enabling optional library features.
+ * Every feature can be enabled with a compiler flag, for example in platformio.ini:
+ * build_flags = -D SPI_USE_ATTENTION_INT0=1
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_FEATURE_DEFINES_H_
+#define AVR_SPI_FEATURE_DEFINES_H_
+
+// master side: library handles INT0/INT1 external interrupts as slave attention lines
+#ifndef SPI_USE_ATTENTION_INT0
+    #define SPI_USE_ATTENTION_INT0 0
+#endif
+
+#ifndef SPI_USE_ATTENTION_INT1
+    #define SPI_USE_ATTENTION_INT1 0
+#endif
+
+// slave side: decode Hamming(7,4) encoded messages in ISR routine, see AVR_SPI_fec.h
+#ifndef SPI_USE_FEC
+    #define SPI_USE_FEC 0
+#endif
+
+// slave side: decrypt XTEA-CTR encrypted messages in ISR routine, see AVR_SPI_cipher.h
+#ifndef SPI_USE_CIPHER
+    #define SPI_USE_CIPHER 0
+#endif
+
+// master side: account bus busy/idle time and per-device traffic with Timer1, see AVR_SPI_meter.h
+#ifndef SPI_USE_METER
+    #define SPI_USE_METER 0
+#endif
+
+// slave side: keep statistics in ISR routine and answer [STATS_QUERY_CHAR] messages
+#ifndef SPI_USE_STATS
+    #define SPI_USE_STATS 0
+#endif
+
+// slave side: answer [ID_QUERY_CHAR] messages with device ID, for bus discovery on master side
+#ifndef SPI_USE_DISCOVERY
+    #define SPI_USE_DISCOVERY 0
+#endif
+
+// slave side: detect repeated messages per channel with a hash computed in ISR routine
+#ifndef SPI_USE_DEDUP
+    #define SPI_USE_DEDUP 0
+#endif
+
+// slave side: forward messages downstream through USART in master SPI mode as bytes arrive, see AVR_SPI_hub.h
+#ifndef SPI_USE_HUB
+    #define SPI_USE_HUB 0
+#endif
+
+// slave side: receive messages into reference counted frames from a fixed pool, read them with SPI_readFrame()
+#ifndef SPI_USE_FRAME_POOL
+    #define SPI_USE_FRAME_POOL 0
+#endif
+
+// slave side: answer 25xx EEPROM commands from internal EEPROM and PROGMEM instead of receiving messages, see AVR_SPI_memory.h
+#ifndef SPI_USE_MEMORY
+    #define SPI_USE_MEMORY 0
+#endif
+
+// slave side: receive back-to-back frames with sync marker and CRC-8 while SS stays asserted, see AVR_SPI_stream.h
+#ifndef SPI_USE_STREAM
+    #define SPI_USE_STREAM 0
+#endif
+
+// slave side: receive with a bit-banged slave on pin change interrupts instead of SPI module, see AVR_SPI_soft_slave.h
+#ifndef SPI_USE_SOFT_SLAVE
+    #define SPI_USE_SOFT_SLAVE 0
+#endif
+
+// master side: drive a WS2812 LED strip from MOSI, needs F_CPU of 8MHz or 16MHz, see AVR_SPI_ws2812.h
+#ifndef SPI_USE_WS2812
+    #define SPI_USE_WS2812 0
+#endif
+
+#if SPI_USE_FEC && SPI_USE_CIPHER
+    #error "SPI_USE_FEC and SPI_USE_CIPHER can't be enabled at the same time"
+#endif
+
+#if SPI_USE_MEMORY && (SPI_USE_FEC || SPI_USE_CIPHER || SPI_USE_STATS || SPI_USE_DISCOVERY || SPI_USE_DEDUP || SPI_USE_HUB || SPI_USE_FRAME_POOL || SPI_USE_STREAM || SPI_USE_SOFT_SLAVE)
+    #error "SPI_USE_MEMORY replaces message reception on slave side, other slave side features can't be enabled with it"
+#endif
+
+#if SPI_USE_SOFT_SLAVE && SPI_USE_HUB
+    #error "SPI_USE_SOFT_SLAVE can't be enabled with SPI_USE_HUB, hub cut-through needs SPI module timing"
+#endif
+
+#if SPI_USE_STREAM && (SPI_USE_FEC || SPI_USE_CIPHER || SPI_USE_HUB)
+    #error "SPI_USE_STREAM has its own framing, it can't be enabled with SPI_USE_FEC, SPI_USE_CIPHER or SPI_USE_HUB"
+#endif
+
+#endif
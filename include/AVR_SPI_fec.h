@@ -0,0 +1,54 @@
+/**
+ * @file AVR_SPI_fec.h
+ * @author Lukas Ternjej
+ *
+ * Header file for Hamming(7,4) forward error correction.
+ * Every data byte is sent as two code bytes (high nibble first), so a single-bit error in a code byte
+ * is corrected on slave side without retransmission. [DATA_END_CHAR] isn't encoded and has no protection,
+ * and the first code byte of a message is dropped if an error turns it into [DUMMY_CHAR] (only 0xFE, high nibble 0xF).
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_FEC_H_
+#define AVR_SPI_FEC_H_
+
+#include <avr/pgmspace.h>
+
+#include "AVR_SPI_with_interrupts.h"
+
+#define FEC_CORRECTED 0x10     // set in decoded nibble when a bit error has been corrected
+
+// code byte has bit 7 set, so it never equals [DATA_END_CHAR]; without bit errors it never equals [DUMMY_CHAR]
+extern const uint8_t FEC_encodeTable[16] PROGMEM;      // nibble -> code byte
+extern const uint8_t FEC_decodeTable[128] PROGMEM;     // low 7 bits of code byte -> nibble | FEC_CORRECTED
+
+extern volatile uint16_t SPI_fecCorrected;     // number of bit errors corrected on slave side
+
+/**
+ * Function for transmitting a Hamming(7,4) encoded string of chars via SPI, with SS line control.
+ * Slave has to be built with SPI_USE_FEC enabled.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param data char pointer that pints to an array element (string), for transmissio via SPI
+ */
+void SPI_transmitStringFEC(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, char *data);
+
+/**
+ * Function for transmitting a Hamming(7,4) encoded hex number via SPI, with SS line control.
+ * Slave has to be built with SPI_USE_FEC enabled.
+ *! [HEX_DATA_BYTES] has to be less or equal to 8!
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param numBytes number of hex bytes that are going to be sent via SPI.
+ * @param hexNumber hex number that is going to be transmitted via SPI
+ */
+void SPI_transmitHexFEC(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t numBytes, uint64_t hexNumber);
+
+#endif
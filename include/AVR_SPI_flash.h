@@ -0,0 +1,138 @@
+/**
+ * @file AVR_SPI_flash.h
+ * @author Lukas Ternjej
+ *
+ * Header file for 25xx SPI NOR flash driver on master side (W25Qxx, AT25SF, MX25L and compatible).
+ * Program and erase only start the operation; memory is busy until it finishes, so the application
+ * can prepare the next page meanwhile. Every function that sends a command waits until memory is idle.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_FLASH_H_
+#define AVR_SPI_FLASH_H_
+
+#include "AVR_SPI_cache.h"
+
+#define FLASH_PAGE_LENGTH   256      // program wraps within a page
+#define FLASH_SECTOR_LENGTH 4096     // smallest erasable unit
+
+// commands
+#define FLASH_CMD_PAGE_PROGRAM  0x02
+#define FLASH_CMD_READ          0x03
+#define FLASH_CMD_READ_STATUS   0x05
+#define FLASH_CMD_WRITE_ENABLE  0x06
+#define FLASH_CMD_SECTOR_ERASE  0x20
+#define FLASH_CMD_ERASE_SUSPEND 0x75     // W25Qxx, AT25SF; MX25L uses 0xB0/0x30
+#define FLASH_CMD_ERASE_RESUME  0x7A
+#define FLASH_CMD_JEDEC_ID      0x9F
+
+#define FLASH_STATUS_BUSY 0x01     // program or erase in progress
+
+/**
+ * Structure that holds flash driver state.
+ */
+typedef struct
+{
+    SPI_device_t *device;     // flash on SPI bus
+    uint32_t size;            // bytes, from JEDEC ID
+    bool busy;                // program or erase may be in progress, status is read only then
+} SPI_flash_t;
+
+/**
+ * Function that reads JEDEC ID of flash and sets flash size.
+ *
+ * @param flash driver state
+ * @param device flash on SPI bus
+ * @return true if flash responded with a valid ID; else, return false
+ */
+bool SPI_flashInit(SPI_flash_t *flash, SPI_device_t *device);
+
+/**
+ * Function that checks if program or erase is in progress.
+ *
+ * @param flash driver state
+ * @return true if flash is busy; else, return false
+ */
+bool SPI_flashBusy(SPI_flash_t *flash);
+
+/**
+ * Function that waits until program or erase is finished.
+ *
+ * @param flash driver state
+ */
+void SPI_flashWait(SPI_flash_t *flash);
+
+/**
+ * Function that reads bytes in a single transaction.
+ *
+ * @param flash driver state
+ * @param address address of the first byte
+ * @param buffer array where bytes are stored
+ * @param numBytes number of bytes
+ */
+void SPI_flashRead(SPI_flash_t *flash, uint32_t address, uint8_t buffer[], uint16_t numBytes);
+
+/**
+ * Function that starts a read transaction; bytes from address on are read with SPI_masterReadUint8_t()
+ * until SPI_flashReadStop(). Reads any number of bytes without a buffer and without repeating the address.
+ *
+ * @param flash driver state
+ * @param address address of the first byte
+ */
+void SPI_flashReadStart(SPI_flash_t *flash, uint32_t address);
+
+/**
+ * Function that ends a read transaction started with SPI_flashReadStart().
+ *
+ * @param flash driver state
+ */
+void SPI_flashReadStop(SPI_flash_t *flash);
+
+/**
+ * Function that reads consecutive cache blocks in a single transaction, read function for SPI_cacheInit().
+ *
+ * @param flash driver state (SPI_flash_t)
+ * @param address address of the first block
+ * @param blocks arrays of CACHE_BLOCK_LENGTH bytes where blocks are stored
+ * @param count number of blocks
+ * @return always true
+ */
+bool SPI_flashReadBlocks(void *flash, uint32_t address, uint8_t *blocks[], uint8_t count);
+
+/**
+ * Function that starts programming bytes. Bits can only be cleared, programmed area has to be erased first.
+ *! Bytes have to be within a single page, program wraps to the start of the page.
+ *
+ * @param flash driver state
+ * @param address address of the first byte
+ * @param data array of bytes that are going to be programmed
+ * @param numBytes number of bytes, 1 - FLASH_PAGE_LENGTH
+ */
+void SPI_flashProgram(SPI_flash_t *flash, uint32_t address, const uint8_t data[], uint16_t numBytes);
+
+/**
+ * Function that starts erasing a sector, all its bytes become 0xFF.
+ *
+ * @param flash driver state
+ * @param address any address in the sector
+ */
+void SPI_flashEraseSector(SPI_flash_t *flash, uint32_t address);
+
+/**
+ * Function that suspends erase in progress and waits until flash accepts other commands.
+ * Other sectors can be read and programmed while erase is suspended.
+ *! Suspended sector must not be read or programmed, and no other erase can be started before SPI_flashResume().
+ *
+ * @param flash driver state
+ */
+void SPI_flashSuspend(SPI_flash_t *flash);
+
+/**
+ * Function that resumes suspended erase, flash is busy again until the erase is finished.
+ *
+ * @param flash driver state
+ */
+void SPI_flashResume(SPI_flash_t *flash);
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file AVR_SPI_hub.h
+ * @author Lukas Ternjej
+ *
+ * Header file for cut-through SPI hub.
+ * Hub is a slave on the upstream bus (SPI module) and a master on the downstream bus (USART in master SPI mode).
+ * First byte of a message selects the downstream port, every following byte is forwarded from ISR routine
+ * as soon as it arrives, so per-hop latency is a few byte times instead of a whole message.
+ * Slave side needs SPI_USE_HUB enabled in AVR_SPI_feature_defines.h, master side functions are always available.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_HUB_H_
+#define AVR_SPI_HUB_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+#if SPI_USE_HUB && !defined(USART_SCK_PIN_PORTxn)
+    #error "SPI_USE_HUB needs USART in master SPI mode, which this microcontroller doesn't have"
+#endif
+
+#if SPI_USE_HUB
+extern SPI_device_t *volatile SPI_hubTarget;     // downstream device of current message, NULL if message isn't forwarded
+extern volatile bool SPI_hubHeader;              // true until first byte after upstream SS is asserted
+
+/**
+ * Function that clocks a byte on the downstream bus. Called from ISR routine for every forwarded byte.
+ *
+ * @param data byte received from upstream master
+ * @return byte received from downstream slave
+ */
+static inline uint8_t SPI_hubExchange(uint8_t data)
+{
+    UDR0 = data;     // downstream SCK is at least as fast as upstream, so transmit buffer is always free
+
+    while(!(UCSR0A & (1 << RXC0)))
+        ;
+
+    return UDR0;
+}
+
+/**
+ * Function that initializes USART in master SPI mode as downstream bus, and SS pin change interrupt.
+ * Upstream SPI module has to be initialized with SPI_init() in SLAVE_MODE.
+ *! SS pins of downstream ports have to be set as outputs by application.
+ *
+ * @param ports array of downstream slave devices, port n is addressed with [HUB_HEADER_CHAR] + n
+ * @param count number of array elements
+ * @param dataOrder least or most significant bit first
+ * @param SPIMode SPI mode 0, 1, 2 or 3
+ * @param ubrr downstream SCK is F_CPU / (2 * (ubrr + 1)), 0 for F_CPU/2
+ */
+void SPI_hubInit(SPI_device_t ports[], uint8_t count, uint8_t dataOrder, uint8_t SPIMode, uint16_t ubrr);
+
+/**
+ * Function that selects downstream port for a message header. Called from ISR routine for first byte of a message.
+ *
+ * @param header first byte of a message
+ * @return true if message is forwarded downstream, false if it is handled by hub itself
+ */
+bool SPI_hubSelect(uint8_t header);
+#endif
+
+/**
+ * Function for transmitting a string of chars to a slave behind a hub, with SS line control.
+ *
+ * @param hub hub device on master bus
+ * @param port downstream port of the hub
+ * @param data char pointer that points to an array element (string), for transmission via SPI
+ */
+void SPI_hubTransmitString(SPI_device_t *hub, uint8_t port, char *data);
+
+/**
+ * Function that reads multiple bytes from a slave behind a hub, with SS line control.
+ * Hub returns downstream byte with the next upstream byte, so one extra byte is clocked.
+ *! Hub loads downstream byte into SPDR about 53 cycles after an upstream byte ends, hub device needs byteGap of at least BYTE_GAP_CYCLES(45)!
+ *
+ * @param hub hub device on master bus
+ * @param port downstream port of the hub
+ * @param buffer array where received bytes are going to be stored
+ * @param numBytes number of bytes that are going to be read
+ */
+void SPI_hubReceiveBytes(SPI_device_t *hub, uint8_t port, uint8_t buffer[], size_t numBytes);
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file AVR_SPI_kv.h
+ * @author Lukas Ternjej
+ *
+ * Header file for key-value store on 25xx SPI flash, on master side.
+ * Store area has two banks; every bank is a summary sector followed by KV_BANK_SECTORS data sectors.
+ * Records (key, length, check, value) are appended to data sectors, and every record is committed with a
+ * short entry (key, record offset, length) appended to the summary sector. At startup the summary sector is
+ * read in a single transaction and every key is put in a RAM hash index, so no record is read at boot and
+ * every lookup is a single read of the record. When a bank is full, live records are copied to the other
+ * bank (compaction), which then becomes the active bank.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_KV_H_
+#define AVR_SPI_KV_H_
+
+#include "AVR_SPI_flash.h"
+
+#ifndef KV_INDEX_BITS
+    #define KV_INDEX_BITS 5          // index has 2^KV_INDEX_BITS slots, 3 - 8; every slot takes 5 bytes of RAM
+#endif
+
+#ifndef KV_BANK_SECTORS
+    #define KV_BANK_SECTORS 2        // data sectors in every bank, 1 - 15
+#endif
+
+#ifndef KV_MAX_VALUE_LENGTH
+    #define KV_MAX_VALUE_LENGTH 64   // longest value, record of this size is kept on stack while it is read
+#endif
+
+#define KV_INDEX_LENGTH         (1 << KV_INDEX_BITS)
+#define KV_DATA_LENGTH          ((uint16_t)KV_BANK_SECTORS * FLASH_SECTOR_LENGTH)
+#define KV_MAGIC                0x564B     // "KV", start of bank header
+#define KV_HEADER_LENGTH        8          // bank header at the start of summary sector: magic, generation, reserved
+#define KV_ENTRY_LENGTH         6          // summary entry: key, record offset, length, check
+#define KV_RECORD_HEADER_LENGTH 4          // record: key, length, check, then value
+#define KV_NO_KEY               0xFFFF     // free index slot and erased summary entry, isn't a valid key
+
+/**
+ * Structure that holds an index slot.
+ */
+typedef struct
+{
+    uint16_t key;         // KV_NO_KEY if slot is free
+    uint16_t offset;      // record offset in data sectors of active bank
+    uint8_t length;       // value length
+} SPI_kvSlot_t;
+
+/**
+ * Structure that holds key-value store state.
+ */
+typedef struct
+{
+    SPI_flash_t *flash;
+    uint32_t areaAddress;                       // address of the first sector of bank 0
+    uint8_t bank;                               // active bank
+    uint16_t generation;                        // increases with every compaction, the newer bank is active
+    uint16_t dataEnd;                           // offset of the next record in data sectors
+    uint16_t summaryEnd;                        // offset of the next entry in summary sector
+    uint16_t keys;                              // used index slots
+    SPI_kvSlot_t index[KV_INDEX_LENGTH];
+    uint32_t compactions;
+} SPI_kv_t;
+
+/**
+ * Function that opens the store: finds the active bank and rebuilds the index from its summary sector in a
+ * single read transaction. Empty or foreign store area is formatted.
+ *! Blocks while the area is erased (about 45ms per sector), if it is formatted.
+ *
+ * @param kv store state
+ * @param flash flash driver state
+ * @param areaAddress address of the store area, sector aligned; area takes 2 * (1 + KV_BANK_SECTORS) sectors
+ * @return true if every stored key fits in the index; else, return false
+ */
+bool SPI_kvInit(SPI_kv_t *kv, SPI_flash_t *flash, uint32_t areaAddress);
+
+/**
+ * Function that reads the value of a key with a single read transaction.
+ *
+ * @param kv store state
+ * @param key key, 0 - 0xFFFE
+ * @param value array where value is stored
+ * @param maxLength size of value array, longer value is cut
+ * @return value length; 0 if key isn't stored or the record is damaged
+ */
+uint8_t SPI_kvGet(SPI_kv_t *kv, uint16_t key, uint8_t value[], uint8_t maxLength);
+
+/**
+ * Function that stores the value of a key. New record is appended and committed by its summary entry,
+ * so the old value stays valid until the new one is completely written. Unchanged value isn't written again.
+ *! Compacts the store if the active bank is full, which erases 1 + KV_BANK_SECTORS sectors and blocks.
+ *
+ * @param kv store state
+ * @param key key, 0 - 0xFFFE
+ * @param value array of value bytes
+ * @param length value length, 1 - KV_MAX_VALUE_LENGTH
+ * @return true if value is stored; else, return false (index or bank full, or invalid arguments)
+ */
+bool SPI_kvPut(SPI_kv_t *kv, uint16_t key, const uint8_t value[], uint8_t length);
+
+/**
+ * Function that removes a key.
+ *
+ * @param kv store state
+ * @param key key, 0 - 0xFFFE
+ * @return true if key was stored; else, return false
+ */
+bool SPI_kvDelete(SPI_kv_t *kv, uint16_t key);
+
+/**
+ * Function that copies live records to the other bank and makes it active. Old values, deleted keys and
+ * the summary entries of both are dropped.
+ ** SPI_kvPut() compacts when needed; call this function when the application is idle to avoid that.
+ *
+ * @param kv store state
+ */
+void SPI_kvCompact(SPI_kv_t *kv);
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file AVR_SPI_log.h
+ * @author Lukas Ternjej
+ *
+ * Header file for log-structured data logger on 25xx SPI flash, on master side.
+ * Records (timestamp + fixed length data) are appended into two page-sized RAM buffers; a full buffer is
+ * programmed as a whole page while the other one is filled. Log area is a ring of sectors, so every sector
+ * is erased once per pass (wear is spread evenly), and sectors ahead of the write position are erased when
+ * the application is idle; a full page that can't wait for such erase suspends it. Every sector starts with
+ * a header; first timestamp of every sector is kept in RAM as an index for seeking by time, and the index
+ * is rebuilt from sector headers at startup.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_LOG_H_
+#define AVR_SPI_LOG_H_
+
+#include "AVR_SPI_flash.h"
+
+#ifndef LOG_MAX_SECTORS
+    #define LOG_MAX_SECTORS 32       // maximum sectors in log area, every sector takes 4 bytes of RAM index
+#endif
+
+#ifndef LOG_ERASE_AHEAD
+    #define LOG_ERASE_AHEAD 2        // sectors that SPI_logService() keeps erased ahead of the write position
+#endif
+
+#ifndef LOG_ERASE_SUSPEND
+    #define LOG_ERASE_SUSPEND 1      // suspend erase ahead to program a full page, 0 for flash without erase suspend
+#endif
+
+#define LOG_MAGIC         0x4C47     // "LG", start of every sector header
+#define LOG_HEADER_LENGTH 12         // magic, record length, reserved, sequence, first timestamp
+#define LOG_EMPTY         0xFFFFFFFF // erased timestamp, marks sector without records in index and unwritten record on flash
+
+/**
+ * Structure that holds logger state.
+ */
+typedef struct
+{
+    SPI_flash_t *flash;
+    uint32_t areaAddress;                               // address of the first log sector
+    uint8_t sectorCount;                                // sectors in log area, 2 - LOG_MAX_SECTORS
+    uint8_t recordLength;                               // 4 byte timestamp + data
+    uint16_t sectorRecords;                             // records that fit in a sector after the header
+    uint32_t sectorTime[LOG_MAX_SECTORS];               // first timestamp of every sector, LOG_EMPTY if sector has no records
+    uint32_t sequence;                                  // sequence number of current sector, increases with every sector
+    uint8_t sector;                                     // sector that records are appended to
+    uint16_t records;                                   // records in current sector
+    uint8_t erasedAhead;                                // erased sectors after current sector
+    bool erasing;                                       // erase ahead may still be in progress
+    bool suspended;                                     // erase ahead is suspended
+    uint8_t buffer[2][FLASH_PAGE_LENGTH];               // page buffers
+    uint32_t bufferAddress[2];                          // flash address of page in every buffer
+    bool pending[2];                                    // buffer is full and waits to be programmed
+    uint8_t active;                                     // buffer that records are appended to
+    uint16_t fill;                                      // bytes in active buffer
+    uint32_t pagePrograms;
+    uint32_t erases;
+    uint32_t stalls;                                    // appends that waited for flash
+    uint32_t suspends;                                  // appends that suspended erase ahead instead of waiting for it
+} SPI_log_t;
+
+/**
+ * Structure that holds a read position in the log.
+ */
+typedef struct
+{
+    uint8_t sector;
+    uint16_t record;
+} SPI_logCursor_t;
+
+/**
+ * Function that opens the log area: reads every sector header, rebuilds the time index and finds the write
+ * position after the newest record. Empty or foreign log area is started from its first sector.
+ *! Blocks while the first sector is erased, if log area is empty.
+ *
+ * @param log logger state
+ * @param flash flash driver state
+ * @param areaAddress address of the first log sector, sector aligned
+ * @param sectorCount sectors in log area, 2 - LOG_MAX_SECTORS
+ * @param dataLength data bytes in every record, 1 - FLASH_PAGE_LENGTH - 4
+ */
+void SPI_logInit(SPI_log_t *log, SPI_flash_t *flash, uint32_t areaAddress, uint8_t sectorCount, uint8_t dataLength);
+
+/**
+ * Function that appends a record. Record is stored in RAM and programmed when its page is full.
+ * Waits only if the other page buffer is still being programmed or the next sector isn't erased yet.
+ * Erase ahead of the write position is suspended for the page program instead of waited for.
+ *
+ * @param log logger state
+ * @param timestamp record time, non-decreasing, LOG_EMPTY isn't allowed
+ * @param data array of dataLength bytes
+ */
+void SPI_logAppend(SPI_log_t *log, uint32_t timestamp, const uint8_t data[]);
+
+/**
+ * Function that programs a full page buffer if flash is idle, or else resumes suspended erase or erases
+ * the next sector ahead of the write position. Never waits for flash.
+ ** Call this function from the main loop, erase (about 45ms) is only started here.
+ *
+ * @param log logger state
+ */
+void SPI_logService(SPI_log_t *log);
+
+/**
+ * Function that programs all buffered records, including a partially filled page, and waits until they are stored.
+ ** Call this function before power down, buffered records are lost otherwise.
+ *
+ * @param log logger state
+ */
+void SPI_logFlush(SPI_log_t *log);
+
+/**
+ * Function that finds the first record with timestamp equal or later than the given time.
+ * Sector is found in RAM index, record within the sector with a binary search of record timestamps on flash.
+ *
+ * @param log logger state
+ * @param timestamp searched time
+ * @param cursor where read position is stored
+ */
+void SPI_logSeek(SPI_log_t *log, uint32_t timestamp, SPI_logCursor_t *cursor);
+
+/**
+ * Function that reads the record at read position and advances it. Buffered records are read from RAM.
+ *
+ * @param log logger state
+ * @param cursor read position
+ * @param timestamp where record time is stored
+ * @param data array where dataLength bytes are stored
+ * @return true if a record is read; else, return false (end of log)
+ */
+bool SPI_logRead(SPI_log_t *log, SPI_logCursor_t *cursor, uint32_t *timestamp, uint8_t data[]);
+
+#endif
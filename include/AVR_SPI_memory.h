@@ -0,0 +1,64 @@
+/**
+ * @file AVR_SPI_memory.h
+ * @author Lukas Ternjej
+ *
+ * Header file for 25xx memory personality on slave side.
+ * Slave answers the command set of 25xx SPI EEPROMs (25LC640, 25LC512 and compatible, 16-bit address), so a master
+ * that leaves a byte gap for the ISR routine can read internal EEPROM and a PROGMEM block without a custom protocol. ISR routine
+ * decodes commands and streams data with address auto-increment; every data byte is fetched one byte ahead,
+ * so SPDR is written with it as soon as the previous byte is received. Writes are buffered per page in RAM
+ * and programmed into EEPROM from the main loop, while status register reports write in progress.
+ * Needs SPI_USE_MEMORY enabled in AVR_SPI_feature_defines.h and SS on a pin change interrupt pin.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_MEMORY_H_
+#define AVR_SPI_MEMORY_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+#if SPI_USE_MEMORY && !defined(SS_PCINT_vect)
+    #error "SPI_USE_MEMORY needs SS pin change interrupt, which isn't defined for this microcontroller"
+#endif
+
+#ifndef MEMORY_PAGE_LENGTH
+    #define MEMORY_PAGE_LENGTH 16     // bytes, write command wraps within a page; 1 - 16
+#endif
+
+#ifndef MEMORY_PROGMEM_ADDRESS
+    #define MEMORY_PROGMEM_ADDRESS 0x8000     // memory address of the first PROGMEM byte, EEPROM starts at 0
+#endif
+
+// 25xx commands
+#define MEMORY_CMD_WRITE 0x02
+#define MEMORY_CMD_READ  0x03
+#define MEMORY_CMD_WRDI  0x04
+#define MEMORY_CMD_RDSR  0x05
+#define MEMORY_CMD_WREN  0x06
+
+// status register bits
+#define MEMORY_STATUS_WIP 0x01     // write in progress
+#define MEMORY_STATUS_WEL 0x02     // write enable latch
+
+#if SPI_USE_MEMORY
+extern volatile uint8_t SPI_memoryStatus;     // status register, as read by RDSR
+
+/**
+ * Function that sets memory map and enables SS pin change interrupt.
+ * SPI module has to be initialized with SPI_init() in SLAVE_MODE.
+ *
+ * @param progmemData array in PROGMEM that is read from MEMORY_PROGMEM_ADDRESS on, NULL if there isn't one
+ * @param progmemLength number of array elements
+ */
+void SPI_memoryInit(const uint8_t *progmemData, uint16_t progmemLength);
+
+/**
+ * Function that programs written bytes into EEPROM, one byte per call, and clears write in progress bit
+ * when the whole page is programmed. Returns right away while EEPROM is busy.
+ ** Call this function from the main loop, master polls RDSR until write is finished.
+ */
+void SPI_memoryService(void);
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file AVR_SPI_meter.h
+ * @author Lukas Ternjej
+ *
+ * Header file for bus utilisation and per-device accounting on master side.
+ * Timer1 runs free and is read when SS is asserted and released, so busy and idle
+ * time are measured without interrupts. Enable SPI_USE_METER in AVR_SPI_feature_defines.h.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_METER_H_
+#define AVR_SPI_METER_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+#define METER_DEVICES      8         // maximum number of accounted slave devices
+#define METER_WINDOWS      8         // number of slots in utilisation sliding window
+#define METER_WINDOW_TICKS 25000     // Timer1 ticks per window slot, 100ms at F_CPU 16MHz and METER_DIV64
+
+// Timer1 prescaler, written to clock select bits
+#define METER_DIV1    0x01     // FCPU/1, timer overflows every 65536 cycles
+#define METER_DIV8    0x02     // FCPU/8
+#define METER_DIV64   0x03     // FCPU/64
+#define METER_DIV256  0x04     // FCPU/256
+#define METER_DIV1024 0x05     // FCPU/1024
+
+/**
+ * Structure that holds accounting of a single slave device.
+ */
+typedef struct
+{
+    volatile uint8_t *SS_PORTx;     // slave select PORTx register
+    uint8_t SS_PORTxn;              // slave select PORTxn register
+    uint32_t bytes;                 // bytes transmitted or received
+    uint32_t transactions;          // number of SS assertions
+    uint32_t busyTicks;             // Timer1 ticks with SS asserted
+} SPI_meterDevice_t;
+
+extern SPI_meterDevice_t SPI_meterDevices[METER_DEVICES];     // accounted devices, in order of first transaction
+extern uint8_t SPI_meterDeviceCount;                          // number of used elements in SPI_meterDevices[]
+extern SPI_meterDevice_t *SPI_meterCurrent;                   // selected device, NULL when bus is idle or device table is full
+
+extern uint32_t SPI_meterBusyTicks;     // total Timer1 ticks with any SS asserted
+extern uint32_t SPI_meterIdleTicks;     // total Timer1 ticks with bus idle
+
+/**
+ * Function that starts Timer1 in normal mode and clears all accounting.
+ *! Timer1 can't be used by the application while meter is used.
+ *
+ * @param prescaler METER_DIV1, METER_DIV8, METER_DIV64, METER_DIV256 or METER_DIV1024
+ */
+void SPI_meterInit(uint8_t prescaler);
+
+/**
+ * Function that clears all accounting and sliding window.
+ */
+void SPI_meterReset(void);
+
+/**
+ * Function that is called by SPI_slaveSelect(); it starts accounting busy time of a device.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ */
+void SPI_meterSelect(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn);
+
+/**
+ * Function that is called by SPI_slaveRelease(); it ends accounting busy time of the selected device.
+ */
+void SPI_meterRelease(void);
+
+/**
+ * Function that accounts time elapsed since the last SS change.
+ ** Call this function from the main loop at least once per Timer1 overflow, so idle time isn't lost.
+ */
+void SPI_meterUpdate(void);
+
+/**
+ * Function that returns bus utilisation over the sliding window.
+ *
+ * @return percentage of time that any SS line was asserted, 0 - 100
+ */
+uint8_t SPI_meterUtilisation(void);
+
+#endif
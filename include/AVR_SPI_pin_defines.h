@@ -22,6 +22,38 @@
     #define SCK_PIN_PORTxn  PB5     // default SCK pin defines
     #define SS_PIN_PORTxn   PB2     // default SS pin defines
 
+    // external interrupt registers, used for slave attention line on master side
+    #define EXT_INT_CONTROLx EICRA
+    #define EXT_INT_MASKx    EIMSK
+
+    // USART in master SPI mode, used for downstream bus of SPI hub
+    #define USART_SPI_DDRx        DDRD
+    #define USART_MOSI_PIN_PORTxn PD1     // TXD0
+    #define USART_MISO_PIN_PORTxn PD0     // RXD0
+    #define USART_SCK_PIN_PORTxn  PD4     // XCK0
+
+    // pin change interrupt of SS pin, used for SS edges on slave side
+    #define SS_PCMSKx     PCMSK0
+    #define SS_PCINTn     PCINT2
+    #define SS_PCIEx      PCIE0
+    #define SS_PCINT_vect PCINT0_vect
+
+    // software slave pins, on one port with pin change interrupts; SCK and SS have to be on the bit-banged port
+    #define SOFT_SPI_PINx        PINC
+    #define SOFT_SPI_DDRx        DDRC
+    #define SOFT_SPI_PORTx       PORTC
+
+    #define SOFT_SCK_PIN_PORTxn  PC0
+    #define SOFT_MOSI_PIN_PORTxn PC1
+    #define SOFT_MISO_PIN_PORTxn PC2
+    #define SOFT_SS_PIN_PORTxn   PC3
+
+    #define SOFT_PCMSKx     PCMSK1
+    #define SOFT_SCK_PCINTn PCINT8
+    #define SOFT_SS_PCINTn  PCINT11
+    #define SOFT_PCIEx      PCIE1
+    #define SOFT_PCINT_vect PCINT1_vect
+
 #elif defined __AVR_ATmega32__
 
     // default SPI pin register defines
@@ -34,5 +66,9 @@
     #define SCK_PIN_PORTxn  PB7     // default SCK pin defines
     #define SS_PIN_PORTxn   PB4     // default SS pin defines
 
+    // external interrupt registers, used for slave attention line on master side
+    #define EXT_INT_CONTROLx MCUCR
+    #define EXT_INT_MASKx    GICR
+
 #endif
 #endif
\ No newline at end of file
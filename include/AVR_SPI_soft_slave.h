@@ -0,0 +1,44 @@
+/**
+ * @file AVR_SPI_soft_slave.h
+ * @author Lukas Ternjej
+ *
+ * Header file for bit-banged software slave, for boards that receive SPI on pins other than the SPI module pins.
+ * SCK and SS are on pin change interrupts (SOFT_* pins in AVR_SPI_pin_defines.h); an assembly ISR routine samples
+ * MOSI on rising SCK edges and shifts out MISO on falling edges, in SPI mode 0 with most significant bit first.
+ * Every complete byte goes through the same receive state machine as bytes from SPI module, so SPI_readAll(),
+ * SPI_queueResponse() and the slave side features work unchanged.
+ * Needs SPI_USE_SOFT_SLAVE enabled in AVR_SPI_feature_defines.h.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_SOFT_SLAVE_H_
+#define AVR_SPI_SOFT_SLAVE_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+#if SPI_USE_SOFT_SLAVE && !defined(SOFT_PCINT_vect)
+    #error "SPI_USE_SOFT_SLAVE needs pin change interrupts, which aren't defined for this microcontroller"
+#endif
+
+#if SPI_USE_SOFT_SLAVE
+extern volatile uint8_t SPI_softSlaveTx;     // byte that is shifted out on MISO, loaded by the receive state machine
+
+/**
+ * Function for initializing software slave: SCK, MOSI and SS as inputs, MISO released until SS is pulled low,
+ * pin change interrupts on SCK and SS. Use it instead of SPI_init() in SLAVE_MODE.
+ ** Interrupts have to be enabled with sei().
+ *! Master has to clock at most the SCK rate in README (Software slave), with a byte gap after every byte!
+ */
+void SPI_softSlaveInit(void);
+
+/**
+ * Function that passes a byte received by software slave through the receive state machine.
+ * Called from pin change ISR routine of software slave, see AVR_SPI_soft_slave.c.
+ *
+ * @param data received byte
+ */
+void SPI_softSlaveByte(uint8_t data);
+#endif
+
+#endif
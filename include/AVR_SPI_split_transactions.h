@@ -0,0 +1,67 @@
+/**
+ * @file AVR_SPI_split_transactions.h
+ * @author Lukas Ternjej
+ *
+ * Header file for split SPI transactions on master side.
+ * Master issues a command, releases the bus and serves other slaves
+ * while the addressed slave is busy, then returns to collect the response.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_SPLIT_TRANSACTIONS_H_
+#define AVR_SPI_SPLIT_TRANSACTIONS_H_
+
+#include "AVR_SPI_with_interrupts.h"
+
+// split transaction states
+#define SPLIT_IDLE     0     // no command issued, transaction can be reused
+#define SPLIT_PENDING  1     // command issued, waiting for slave to prepare response
+#define SPLIT_COMPLETE 2     // response collected into response buffer
+
+/**
+ * Structure that describes a single split transaction.
+ * Ticks are application defined (for example milliseconds from a timer ISR), library only compares differences.
+ */
+typedef struct
+{
+    SPI_device_t device;       // slave that the command is sent to
+    uint8_t state;             // SPLIT_IDLE, SPLIT_PENDING or SPLIT_COMPLETE
+    uint16_t issuedAt;         // tick when command was issued
+    uint16_t waitTicks;        // ticks that slave needs before response is available
+    bool (*isReady)(void);     // optional ready condition (for example slave ready pin), NULL if only waitTicks is used
+    uint8_t *response;         // buffer for slave response
+    size_t responseBytes;      // number of response bytes that are going to be collected
+} SPI_split_t;
+
+/**
+ * Function that transmits a command to slave and marks transaction as pending. Bus is released right after the command.
+ *
+ * @param transaction split transaction that is going to be issued
+ * @param command string command that is going to be transmitted via SPI
+ * @param now current application tick
+ * @return true if command is issued, false if transaction is still pending
+ */
+bool SPI_splitIssue(SPI_split_t *transaction, char *command, uint16_t now);
+
+/**
+ * Function that collects responses of all pending transactions whose slave is ready.
+ * Slave is ready when its ready condition returns true or when waitTicks have elapsed since the command was issued.
+ ** Call this function from the main loop, between other bus work.
+ *
+ * @param transactions array of split transactions
+ * @param count number of array elements
+ * @param now current application tick
+ * @return number of responses collected in this call
+ */
+uint8_t SPI_splitService(SPI_split_t transactions[], uint8_t count, uint16_t now);
+
+/**
+ * Function that checks if response of a transaction is collected. Completed transaction is set back to idle.
+ *
+ * @param transaction split transaction
+ * @return true if response is available in response buffer; else, return false
+ */
+bool SPI_splitComplete(SPI_split_t *transaction);
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file AVR_SPI_stream.h
+ * @author Lukas Ternjej
+ *
+ * Header file for continuous point-to-point stream mode. Master keeps SS asserted and sends frames back to back,
+ * every frame is [STREAM_SYNC_CHAR], escaped payload, escaped CRC-8 of the payload and [DATA_END_CHAR].
+ * Payload bytes that equal [STREAM_SYNC_CHAR], [DATA_END_CHAR], [DUMMY_CHAR] or [ESCAPE_CHAR] are sent as
+ * [ESCAPE_CHAR], byte ^ [ESCAPE_XOR], so [STREAM_SYNC_CHAR] only appears at the start of a frame.
+ * Slave built with SPI_USE_STREAM drops frames with a wrong CRC or length and ignores bytes until the next
+ * [STREAM_SYNC_CHAR], so a lost or corrupted byte costs one frame and the next frame is received again.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_STREAM_H_
+#define AVR_SPI_STREAM_H_
+
+#include <avr/pgmspace.h>
+
+#include "AVR_SPI_with_interrupts.h"
+
+#define STREAM_PAYLOAD_LENGTH (DATA_LENGTH - 2)     // payload bytes per frame, slave keeps DATA_LENGTH - 1 bytes: payload and its CRC byte
+
+extern const uint8_t STREAM_crcTable[256] PROGMEM;     // CRC-8, polynomial 0x07
+
+extern volatile uint16_t SPI_streamResyncs;     // frames on slave side that were cut off by [STREAM_SYNC_CHAR]
+extern volatile uint16_t SPI_streamErrors;      // frames on slave side dropped because of a wrong CRC or length
+
+/**
+ * Function that starts a stream: selects the slave device and keeps it selected until SPI_streamEnd().
+ * Inter-byte gap of the device is applied to every byte of the stream.
+ *
+ * @param device slave device
+ */
+void SPI_streamBegin(SPI_device_t *device);
+
+/**
+ * Function that ends a stream started with SPI_streamBegin().
+ *
+ * @param device slave device
+ */
+void SPI_streamEnd(SPI_device_t *device);
+
+/**
+ * Function that releases and selects the slave device again, without ending the stream.
+ * SS edge resets the bit counter of slave SPI module, which [STREAM_SYNC_CHAR] can't do: after a glitch on SCK
+ * every byte is shifted by some bits and no frame passes CRC until SS is toggled.
+ ** Call it when slave reports SPI_streamErrors on every frame, or periodically on a noisy link.
+ *
+ * @param device slave device
+ */
+void SPI_streamResync(SPI_device_t *device);
+
+/**
+ * Function for transmitting a frame of bytes in a stream started with SPI_streamBegin(). Slave receives
+ * the payload in SPI_data[], payload may contain any byte value.
+ ** Slave stores payload and CRC byte in SPI_buffer[], so payload is at most [STREAM_PAYLOAD_LENGTH] bytes.
+ *
+ * @param data bytes that are going to be transmitted
+ * @param size number of bytes in data, 0 - [STREAM_PAYLOAD_LENGTH]
+ * @return false if size is larger than [STREAM_PAYLOAD_LENGTH], nothing is sent; else, return true
+ */
+bool SPI_streamTransmitBytes(const uint8_t data[], size_t size);
+
+/**
+ * Function for transmitting a string of chars as a frame in a stream started with SPI_streamBegin().
+ *
+ * @param data char pointer that points to an array element (string), for transmission via SPI
+ * @return false if string is longer than [STREAM_PAYLOAD_LENGTH], nothing is sent; else, return true
+ */
+bool SPI_streamTransmitString(char *data);
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file AVR_SPI_templates.h
+ * @author Lukas Ternjej
+ *
+ * Header file for transaction templates on master side.
+ * A template is a compact bytecode program in flash that describes SS control, command/data bytes
+ * and delays of a whole sequence (for example a display init sequence), instead of a list of calls.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_TEMPLATES_H_
+#define AVR_SPI_TEMPLATES_H_
+
+#include <avr/pgmspace.h>
+
+#include "AVR_SPI_with_interrupts.h"
+
+// opcodes, upper 3 bits of an instruction byte; lower 5 bits hold byte count (1 - 31) where it is used
+#define TPL_OP_MASK    0xE0
+#define TPL_COUNT_MASK 0x1F
+
+#define TPL_END     0x00     // end of template
+#define TPL_SELECT  0x20     // assert SS of template device
+#define TPL_RELEASE 0x40     // release SS of template device
+#define TPL_OP_CMD  0x60     // pull DC pin low and transmit following count bytes
+#define TPL_OP_DATA 0x80     // pull DC pin high and transmit following count bytes
+#define TPL_OP_RAW  0xA0     // transmit following count bytes, DC pin isn't changed
+#define TPL_DELAY   0xC0     // wait number of ticks in the following byte, rounded up to one more tick
+// 0xE0 - 0xFF are not valid instructions
+
+// instruction macros for writing templates
+#define TPL_CMD(count)  (TPL_OP_CMD | ((count) & TPL_COUNT_MASK))
+#define TPL_DATA(count) (TPL_OP_DATA | ((count) & TPL_COUNT_MASK))
+#define TPL_RAW(count)  (TPL_OP_RAW | ((count) & TPL_COUNT_MASK))
+#define TPL_WAIT(ticks) TPL_DELAY, (ticks)
+
+/**
+ * Structure that holds state of a running template.
+ * Ticks are application defined (for example milliseconds from a timer ISR), library only compares differences.
+ */
+typedef struct
+{
+    SPI_device_t *device;           // slave that template is run on
+    volatile uint8_t *DC_PORTx;     // data/command PORTx register, NULL if device has no DC pin
+    uint8_t DC_PORTxn;              // data/command PORTxn register
+    const uint8_t *program;         // next instruction, in flash; NULL when template is finished
+    uint16_t waitStart;             // tick when current delay started
+    uint8_t waitTicks;              // ticks left in current delay, 0 if not waiting
+} SPI_template_t;
+
+/**
+ * Function that starts a template. Template runs in following SPI_templateService() calls.
+ *
+ * @param instance template state
+ * @param program template program in flash (PROGMEM)
+ */
+void SPI_templateStart(SPI_template_t *instance, const uint8_t *program);
+
+/**
+ * Function that runs template instructions until a delay or the end of template.
+ * Bytes between two delays are transmitted back to back. Delays don't block, function returns and resumes later.
+ ** Call this function from the main loop, between other bus work.
+ *
+ * @param instance template state
+ * @param now current application tick
+ * @return true if template is finished or stopped on an unknown opcode (program isn't NULL then); else, return false
+ */
+bool SPI_templateService(SPI_template_t *instance, uint16_t now);
+
+/**
+ * Function that runs a whole template, delays are busy waited with one tick being one millisecond.
+ *
+ * @param instance template state
+ * @param program template program in flash (PROGMEM)
+ */
+void SPI_templateRun(SPI_template_t *instance, const uint8_t *program);
+
+#endif
@@ -17,8 +17,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <util/delay.h>
+#include <util/delay_basic.h>
 
 #include "AVR_SPI_char_defines.h"
+#include "AVR_SPI_feature_defines.h"
 #include "AVR_SPI_pin_defines.h"
 
 // bit order
@@ -53,6 +55,53 @@
 #define INVERTED_SS_CONTROL 0
 #define DEFAULT_SS_CONTROL  1
 
+/**
+ * Structure that describes a slave device on master side.
+ * Holds everything that SPI_transmit* functions need for SS line control.
+ */
+typedef struct
+{
+    volatile uint8_t *SS_PORTx;     // slave select PORTx register
+    uint8_t SS_PORTxn;              // slave select PORTxn register
+    uint8_t SSmode;                 // DEFAULT_SS_CONTROL or INVERTED_SS_CONTROL
+    uint8_t byteGap;                // minimum gap after every byte, in _delay_loop_1() iterations, 0 for no gap
+    uint8_t id;                     // device ID reported in discovery, 0 if device didn't respond
+} SPI_device_t;
+
+// converts minimum inter-byte gap in CPU cycles to SPI_device_t.byteGap, one _delay_loop_1() iteration takes 3 cycles
+#define BYTE_GAP_CYCLES(cycles) (((cycles) + 2) / 3)
+
+/**
+ * Structure that holds slave statistics. Slave keeps it in ISR routine when SPI_USE_STATS is enabled,
+ * and master reads it with SPI_queryStats().
+ */
+typedef struct
+{
+    uint16_t framesReceived;     // number of received messages
+    uint16_t overruns;           // messages that overwrote an unread message or didn't fit in SPI_buffer[]
+    uint16_t maxIsrTicks;        // longest ISR routine, in Timer1 ticks (0 if Timer1 isn't running)
+    uint8_t highWaterMark;       // longest received message, in bytes
+} SPI_stats_t;
+
+/**
+ * Structure that holds a received message in frame pool. Frame is returned to the pool when its reference count drops to 0.
+ */
+typedef struct
+{
+    uint8_t data[DATA_LENGTH];     // message, terminated with [DATA_END_CHAR]
+    uint8_t length;                // number of received bytes, without [DATA_END_CHAR]
+    uint8_t refCount;              // number of consumers that hold the frame, 0 if frame is free
+    bool duplicate;                // true if message is a repeated message (SPI_USE_DEDUP in DEDUP_FLAG mode)
+} SPI_frame_t;
+
+// duplicate filter modes
+#define DEDUP_DROP 0     // repeated message isn't passed to SPI_readAll()
+#define DEDUP_FLAG 1     // repeated message is passed to SPI_readAll() and SPI_readDuplicate() returns true
+
+// external interrupts that can be used for slave attention line
+#define ATTENTION_INT0 0     // INT0 pin, see microcontroller datasheet
+#define ATTENTION_INT1 1     // INT1 pin, see microcontroller datasheet
+
 /**
  * Function for initializing SPI communication on Atmel AVR 8-bit microcontrollers that have a dedicated SPI module.
  ** This function doesn't handle multiple slave devices; manual control of multiple SS lines is mandatory.
@@ -113,6 +162,15 @@ bool SPI_readAll(void);
  */
 void SPI_masterPutUint8_t(uint8_t data);
 
+/**
+ * Function that writes the first byte of a message in SPDR register. Slave ignores [DUMMY_CHAR] at the start of
+ * a message, because master reads with it, so a first byte that equals [DUMMY_CHAR] or [ESCAPE_CHAR] is sent as
+ * [ESCAPE_CHAR], byte ^ [ESCAPE_XOR]; slave restores it before storing it.
+ *
+ * @param data first byte of a message
+ */
+void SPI_masterPutFirst(uint8_t data);
+
 /**
  * Writes an uint8_t to SPDR register.
  *
@@ -120,6 +178,85 @@ void SPI_masterPutUint8_t(uint8_t data);
  */
 void SPI_putUint8_t(uint8_t data);
 
+/**
+ * Function that selects a slave device, by pulling its SS pin low (default) or high (inverted).
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ */
+void SPI_slaveSelect(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode);
+
+/**
+ * Function that releases a slave device, by pulling its SS pin high (default) or low (inverted).
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ */
+void SPI_slaveRelease(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode);
+
+/**
+ * Function that selects a slave device and applies its inter-byte gap to every following
+ * SPI_masterPutUint8_t() and SPI_masterReadUint8_t() call, until SPI_deviceRelease().
+ *
+ * @param device slave device
+ */
+void SPI_deviceSelect(SPI_device_t *device);
+
+/**
+ * Function that releases a slave device selected with SPI_deviceSelect().
+ *
+ * @param device slave device
+ */
+void SPI_deviceRelease(SPI_device_t *device);
+
+/**
+ * Function for transmitting a string of chars via SPI, with SS line control and inter-byte gap of the device.
+ *
+ * @param device slave device
+ * @param data char pointer that points to an array element (string), for transmission via SPI
+ */
+void SPI_deviceTransmitString(SPI_device_t *device, char *data);
+
+/**
+ * Function that reads multiple bytes from slave, with SS line control and inter-byte gap of the device.
+ *
+ * @param device slave device
+ * @param buffer array where received bytes are going to be stored
+ * @param numBytes number of bytes that are going to be read
+ */
+void SPI_deviceReceiveBytes(SPI_device_t *device, uint8_t buffer[], size_t numBytes);
+
+/**
+ * Function for full-duplex transfer of raw bytes, with SS line control and inter-byte gap of the device.
+ * [DATA_END_CHAR] isn't added, this is meant for off-the-shelf SPI devices (sensors, memories, displays).
+ *
+ * @param device slave device
+ * @param txData bytes that are going to be transmitted, NULL to transmit [DUMMY_CHAR]
+ * @param rxData array where received bytes are going to be stored, NULL if received bytes aren't needed
+ * @param numBytes number of bytes that are going to be transferred
+ */
+void SPI_transferBytes(SPI_device_t *device, const uint8_t txData[], uint8_t rxData[], size_t numBytes);
+
+/**
+ * Function for pipelined request/response, with SS line control and inter-byte gap of the device. Request is transmitted
+ * terminated with [DATA_END_CHAR] and, in the same transaction, the response to the previous request is received:
+ * slave queues it with SPI_queueResponse() after SPI_readAll(), so it is preloaded into SPDR before this transaction.
+ * Transaction is as long as the longer of request and response, missing request bytes are sent as [DUMMY_CHAR].
+ ** Every request/response takes one transaction instead of two (SPI_transmitString() and SPI_receiveBytes()).
+ *! Slave needs time between two transactions to queue its response; response must not start with [DUMMY_CHAR] or [READY_CHAR].
+ *
+ * @param device slave device
+ * @param request string that is going to be transmitted, NULL to only read the response to the last request
+ * @param response array where response to the previous request is stored, NULL if it isn't needed
+ * @param responseLength number of response bytes, as queued by slave
+ * @return true if slave had a response queued; else, return false (idle byte was received, slave isn't done yet)
+ */
+bool SPI_pipelineExchange(SPI_device_t *device, const char *request, uint8_t response[], size_t responseLength);
+
 /**
  * Function for transmitting an uint8_t via SPI, with SS line control.
  *
@@ -153,6 +290,18 @@ void SPI_transmitString(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t S
  */
 uint8_t SPI_receiveUint8_t(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode);
 
+/**
+ * Function that reads multiple uint8_t values from slave in a single transmission, with SS line control.
+ *
+ * @param SS_PORTx select PORTx register
+ * @param SS_PORTxn select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param buffer array where received data is stored
+ * @param numBytes number of bytes that are going to be read from slave
+ */
+void SPI_receiveBytes(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t buffer[], size_t numBytes);
+
 /**
  * Takes an array that stores individual uint8_t values and returns combined uint64_t
  * value from all array elements.
@@ -177,4 +326,190 @@ uint64_t hexArrayToUint64_t(uint8_t array[], size_t size);
  */
 void SPI_transmitHex(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t numBytes, uint64_t hexNumber);
 
-#endif
\ No newline at end of file
+/**
+ * Function that sets up an attention line on slave side. Slave pulls attention pin low
+ * while it has queued response data, and releases it when master reads the whole response.
+ *
+ * @param DDRx attention pin DDRx register
+ * @param PORTx attention pin PORTx register
+ * @param PORTxn attention pin PORTxn register
+ */
+void SPI_attentionInit(volatile uint8_t *DDRx, volatile uint8_t *PORTx, uint8_t PORTxn);
+
+/**
+ * Function that queues response data on slave side. Queued bytes are shifted out to master
+ * one by one, on the following SPI transfers, and attention line is asserted until the queue is empty.
+ *! Call this function while master is not clocking data, or the first byte might be lost (SPDR write collision).
+ *
+ * @param data array of bytes that are going to be sent to master
+ * @param size number of array elements
+ * @return true if data is queued, false if there is not enough space in response queue
+ */
+bool SPI_queueResponse(uint8_t data[], size_t size);
+
+/**
+ * Function that maps slave attention line to an external interrupt on master side.
+ * Falling edge on the interrupt pin schedules a read of numBytes from the slave.
+ ** Library handles interrupt only if SPI_USE_ATTENTION_INT0 or SPI_USE_ATTENTION_INT1 is enabled in AVR_SPI_feature_defines.h.
+ *
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1
+ * @param device slave device that drives the attention line
+ * @param buffer array where slave response is stored
+ * @param numBytes number of bytes that are going to be read from slave
+ */
+void SPI_attentionAttach(uint8_t interrupt, SPI_device_t *device, uint8_t buffer[], size_t numBytes);
+
+/**
+ * Function that reads data from all slaves that asserted their attention line, with inter-byte gap of the device.
+ * Call this function from the main loop, so the read never interrupts an SPI transmission that is already in progress.
+ *
+ * @return number of slaves that were read
+ */
+uint8_t SPI_attentionService(void);
+
+/**
+ * Function that checks if a response from slave, attached to the interrupt, has been read.
+ *
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1
+ * @return true if new response is available in the buffer; else, return false
+ */
+bool SPI_attentionReceived(uint8_t interrupt);
+
+/**
+ * Function that checks and clears pending flag of an external interrupt, for drivers that read the slave themselves.
+ * Attach the interrupt with SPI_attentionAttach() and NULL device, so SPI_attentionService() leaves it alone.
+ *
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1
+ * @return true if interrupt has been triggered since the last call; else, return false
+ */
+bool SPI_attentionTake(uint8_t interrupt);
+
+/**
+ * Function that sets up a ready pin on slave side. Ready pin is held low until SPI_slaveReady() is called.
+ *
+ * @param DDRx ready pin DDRx register
+ * @param PORTx ready pin PORTx register
+ * @param PORTxn ready pin PORTxn register
+ */
+void SPI_readyPinInit(volatile uint8_t *DDRx, volatile uint8_t *PORTx, uint8_t PORTxn);
+
+/**
+ * Function that signals master that slave has finished initialization. From now on, slave shifts out
+ * [READY_CHAR] whenever it has no queued response, and ready pin (if used) is pulled high.
+ */
+void SPI_slaveReady(void);
+
+/**
+ * Function that polls slave with [DUMMY_CHAR] until it responds with [READY_CHAR], with SS line control.
+ * Delay between polls starts at 1ms and doubles up to [READY_BACKOFF_MAX_MS].
+ *
+ * @param device slave device that is polled
+ * @param timeoutMs maximum time to wait for slave, in milliseconds
+ * @return true if slave is ready, false if timeout has expired
+ */
+bool SPI_waitReady(SPI_device_t *device, uint16_t timeoutMs);
+
+/**
+ * Function that waits until slave ready pin goes high.
+ *
+ * @param PINx ready pin PINx register
+ * @param PINxn ready pin PINxn register
+ * @param timeoutMs maximum time to wait for slave, in milliseconds
+ * @return true if slave is ready, false if timeout has expired
+ */
+bool SPI_waitReadyPin(volatile uint8_t *PINx, uint8_t PINxn, uint16_t timeoutMs);
+
+/**
+ * Function that enables measuring ISR routine time on slave side, by starting Timer1 with no prescaler.
+ *! Timer1 can't be used by the application for anything but a free running counter.
+ */
+void SPI_statsInit(void);
+
+/**
+ * Function that returns a copy of slave statistics.
+ *
+ * @param slaveStats structure where statistics are copied
+ */
+void SPI_getStats(SPI_stats_t *slaveStats);
+
+/**
+ * Function that queries statistics block of a slave, with SS line control.
+ * Slave has to be built with SPI_USE_STATS enabled.
+ *
+ * @param device slave device that is queried
+ * @param slaveStats structure where statistics are stored
+ * @return true if statistics block is received, false if slave didn't respond
+ */
+bool SPI_queryStats(SPI_device_t *device, SPI_stats_t *slaveStats);
+
+/**
+ * Function that sets device ID that slave reports when master queries it with [ID_QUERY_CHAR].
+ * Slave has to be built with SPI_USE_DISCOVERY enabled.
+ *! ID must not be 0x00, [DUMMY_CHAR] or [READY_CHAR].
+ *
+ * @param id device ID
+ */
+void SPI_slaveSetID(uint8_t id);
+
+/**
+ * Function that probes every configured SS line with [ID_QUERY_CHAR] and builds a table of populated slaves.
+ * Each probe takes a few tens of microseconds, so absent slaves cost almost nothing.
+ *
+ * @param devices array of configured slave devices, id of every element is updated
+ * @param count number of array elements
+ * @param active array where pointers to populated slave devices are stored, at least count elements
+ * @return number of populated slave devices
+ */
+uint8_t SPI_discover(SPI_device_t devices[], uint8_t count, SPI_device_t *active[]);
+
+/**
+ * Function that selects what happens with a message that is identical to the previous message on its channel.
+ * Channel is the first message byte, modulo [DEDUP_CHANNELS]. Default mode is DEDUP_DROP.
+ *
+ * @param mode DEDUP_DROP or DEDUP_FLAG
+ */
+void SPI_dedupSetMode(uint8_t mode);
+
+/**
+ * Function that forgets the last message of every channel, so the next message on each channel is delivered.
+ */
+void SPI_dedupReset(void);
+
+/**
+ * Function that returns number of repeated messages detected since startup.
+ *
+ * @return number of repeated messages
+ */
+uint16_t SPI_dedupCount(void);
+
+/**
+ * Function that checks if message that was read with the last SPI_readAll() call is a repeated message.
+ * Only DEDUP_FLAG mode passes repeated messages to SPI_readAll().
+ *
+ * @return true if message is identical to the previous message on its channel; else, return false
+ */
+bool SPI_readDuplicate(void);
+
+/**
+ * Function that takes the oldest received message from frame pool. Caller holds one reference
+ * and has to call SPI_frameRelease() when it's done. Slave has to be built with SPI_USE_FRAME_POOL enabled.
+ *
+ * @return received frame, NULL if there is no new message
+ */
+SPI_frame_t *SPI_readFrame(void);
+
+/**
+ * Function that adds a reference to a frame, for handing it to another consumer without copying.
+ *
+ * @param frame received frame
+ */
+void SPI_frameRetain(SPI_frame_t *frame);
+
+/**
+ * Function that drops a reference to a frame. Frame is returned to the pool when the last reference is dropped.
+ *
+ * @param frame received frame
+ */
+void SPI_frameRelease(SPI_frame_t *frame);
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * @file AVR_SPI_ws2812.h
+ * @author Lukas Ternjej
+ *
+ * Header file for WS2812 LED strip output through the SPI module on master side.
+ * Strip data input is connected to MOSI; SCK runs at 4MHz and every WS2812 bit is sent as 4 SPI bits,
+ * 1000 for 0 and 1110 for 1, so a colour byte takes 4 SPI bytes. Encoding is a table read from flash
+ * per 2 colour bits, and the next colour byte is encoded while the current one is shifted out.
+ * Needs SPI_USE_WS2812 enabled in AVR_SPI_feature_defines.h.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef AVR_SPI_WS2812_H_
+#define AVR_SPI_WS2812_H_
+
+#include <avr/pgmspace.h>
+
+#include "AVR_SPI_with_interrupts.h"
+
+#if SPI_USE_WS2812
+// 4MHz SCK, a WS2812 bit takes 1us: high time is 250ns for 0 and 750ns for 1
+#if F_CPU == 16000000UL
+    #define WS2812_CLOCK FOSC_DIV4
+#elif F_CPU == 8000000UL
+    #define WS2812_CLOCK FOSC_DIV2
+#else
+    #error "WS2812 output needs 4MHz SCK, F_CPU has to be 8MHz or 16MHz"
+#endif
+
+#define WS2812_BYTES_PER_COLOUR 4       // SPI bytes per colour byte
+#define WS2812_RESET_US         300     // low time that latches colours, WS2812B needs 280us (older WS2812 50us)
+
+extern const uint8_t WS2812_encodeTable[4] PROGMEM;     // 2 colour bits -> SPI byte
+
+/**
+ * Function that sends colours to a WS2812 strip and latches them. SPI clock, bit order and SPI mode are set for
+ * the strip and restored afterwards, so the strip can share the bus with other slaves.
+ ** Other slaves' traffic must not reach the strip: gate its data input with a buffer (for example 74HC1G125)
+ ** whose enable pin is the SS line of device, with a pull-down on the strip side, or pass NULL if the strip is alone on MOSI.
+ *! Interrupt routines that take more than ~5us can make the strip latch in the middle of the data!
+ *
+ * @param device gate of the strip data input, NULL if there is none
+ * @param data colour bytes in strip order (G, R, B for WS2812)
+ * @param size number of colour bytes, 3 per LED
+ */
+void SPI_ws2812Show(SPI_device_t *device, const uint8_t data[], uint16_t size);
+#endif
+
+#endif
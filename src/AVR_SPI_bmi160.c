@@ -0,0 +1,197 @@
+/**
+ * @file AVR_SPI_bmi160.c
+ * @author Lukas Ternjej
+ *
+ * BMI160 IMU driver .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_bmi160.h"
+
+/**
+ * Function that writes a sensor register.
+ *
+ * @param device sensor on SPI bus
+ * @param reg register address
+ * @param value register value
+ */
+static void SPI_bmi160Write(SPI_device_t *device, uint8_t reg, uint8_t value)
+{
+    uint8_t command[2] = {reg, value};
+
+    SPI_transferBytes(device, command, NULL, 2);
+}
+
+/**
+ * Function that reads consecutive sensor registers in a single transfer.
+ *
+ * @param device sensor on SPI bus
+ * @param reg address of the first register
+ * @param buffer array where register values are stored
+ * @param numBytes number of registers
+ */
+static void SPI_bmi160ReadRegisters(SPI_device_t *device, uint8_t reg, uint8_t buffer[], uint8_t numBytes)
+{
+    SPI_deviceSelect(device);     // start transmission
+
+    SPI_masterPutUint8_t(reg | BMI160_READ);
+
+    for(uint8_t i = 0; i < numBytes; i++)
+        buffer[i] = SPI_masterReadUint8_t();
+
+    SPI_deviceRelease(device);     // end transmission
+}
+
+/**
+ * Function that returns number of whole frames in sensor FIFO.
+ *
+ * @param imu driver state
+ * @return number of frames
+ */
+static uint16_t SPI_bmi160FifoFrames(SPI_bmi160_t *imu)
+{
+    uint8_t length[2];
+    SPI_bmi160ReadRegisters(imu->device, BMI160_FIFO_LENGTH, length, 2);
+
+    return (length[0] | ((length[1] & 0x07) << 8)) / BMI160_FRAME_LENGTH;
+}
+
+/**
+ * Function that reads frames from sensor FIFO into the sample ring in a single burst.
+ *
+ * @param imu driver state
+ * @param frames number of frames in FIFO
+ */
+static void SPI_bmi160Burst(SPI_bmi160_t *imu, uint16_t frames)
+{
+    SPI_deviceSelect(imu->device);     // start transmission
+
+    SPI_masterPutUint8_t(BMI160_FIFO_DATA | BMI160_READ);
+
+    for(uint16_t i = 0; i < frames; i++)
+    {
+        if(imu->count == BMI160_RING_LENGTH)
+        {
+            // ring is full, oldest sample is overwritten
+            imu->head = (imu->head + 1) % BMI160_RING_LENGTH;
+            imu->count--;
+            imu->overruns++;
+        }
+
+        uint8_t *frame = (uint8_t *)&imu->ring[(imu->head + imu->count) % BMI160_RING_LENGTH];
+
+        for(uint8_t j = 0; j < BMI160_FRAME_LENGTH; j++)
+            frame[j] = SPI_masterReadUint8_t();
+
+        imu->count++;
+    }
+
+    SPI_deviceRelease(imu->device);     // end transmission
+
+    imu->bursts++;
+}
+
+/**
+ * Function that resets the sensor, starts accelerometer and gyroscope in normal mode, and enables FIFO watermark interrupt.
+ *! Blocks for about 100ms, while sensor starts up.
+ *
+ * @param imu driver state
+ * @param device sensor on SPI bus
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1, connected to sensor INT1 pin
+ * @param odr BMI160_ODR_100HZ - BMI160_ODR_1600HZ
+ * @param watermark number of samples that trigger the interrupt, 2 - BMI160_RING_LENGTH
+ * @return true if sensor responded with its chip ID; else, return false
+ */
+bool SPI_bmi160Init(SPI_bmi160_t *imu, SPI_device_t *device, uint8_t interrupt, uint8_t odr, uint8_t watermark)
+{
+    uint8_t value;
+
+    imu->device = device;
+    imu->interrupt = interrupt;
+    imu->watermark = watermark;
+    imu->head = 0;
+    imu->count = 0;
+    imu->overruns = 0;
+    imu->bursts = 0;
+
+    // sensor starts in I2C mode, rising edge of SS switches it to SPI
+    SPI_bmi160ReadRegisters(device, BMI160_SPI_MODE, &value, 1);
+    SPI_bmi160Write(device, BMI160_CMD, BMI160_CMD_SOFTRESET);
+    _delay_ms(1);
+    SPI_bmi160ReadRegisters(device, BMI160_SPI_MODE, &value, 1);
+
+    SPI_bmi160ReadRegisters(device, BMI160_CHIP_ID, &value, 1);
+
+    if(value != BMI160_CHIP_ID_VALUE)
+        return false;
+
+    SPI_bmi160Write(device, BMI160_CMD, BMI160_CMD_ACC_NORMAL);
+    _delay_ms(4);
+    SPI_bmi160Write(device, BMI160_CMD, BMI160_CMD_GYR_NORMAL);
+    _delay_ms(80);
+
+    SPI_bmi160Write(device, BMI160_ACC_CONF, 0x20 | odr);     // normal filter mode
+    SPI_bmi160Write(device, BMI160_GYR_CONF, 0x20 | odr);     // normal filter mode
+
+    // headerless FIFO with gyroscope and accelerometer frames, watermark is set in 4 byte units
+    SPI_bmi160Write(device, BMI160_FIFO_CONFIG_0, watermark * (BMI160_FRAME_LENGTH / 4));
+    SPI_bmi160Write(device, BMI160_FIFO_CONFIG_1, 0xC0);
+
+    // INT1 pin: push-pull, active low, driven by FIFO watermark
+    SPI_bmi160Write(device, BMI160_INT_OUT_CTRL, 0x08);
+    SPI_bmi160Write(device, BMI160_INT_MAP_1, 0x40);
+    SPI_bmi160Write(device, BMI160_INT_EN_1, 0x40);
+
+    SPI_bmi160Write(device, BMI160_CMD, BMI160_CMD_FIFO_FLUSH);
+
+    SPI_attentionAttach(interrupt, NULL, NULL, 0);     // falling edge on INTn, driver reads the sensor itself
+
+    return true;
+}
+
+/**
+ * Function that drains sensor FIFO into the sample ring in a single burst, if watermark interrupt has been triggered.
+ * Samples that arrive during the burst are drained with another burst until FIFO is below the watermark,
+ * so INT1 is released and the next watermark gives a new falling edge.
+ ** Call this function from the main loop, between other bus work.
+ *
+ * @param imu driver state
+ * @return number of samples read from FIFO
+ */
+uint8_t SPI_bmi160Service(SPI_bmi160_t *imu)
+{
+    if(!SPI_attentionTake(imu->interrupt))
+        return 0;
+
+    uint8_t samples = 0;
+    uint16_t frames;
+
+    // INT1 is low while FIFO holds a watermark, interrupt is on falling edge: drain until FIFO is below it
+    while((frames = SPI_bmi160FifoFrames(imu)) != 0 && (samples == 0 || frames >= imu->watermark))
+    {
+        SPI_bmi160Burst(imu, frames);
+        samples += frames;
+    }
+
+    return samples;
+}
+
+/**
+ * Function that takes the oldest sample from the sample ring.
+ *
+ * @param imu driver state
+ * @param sample where sample is stored
+ * @return true if sample is available; else, return false
+ */
+bool SPI_bmi160Read(SPI_bmi160_t *imu, SPI_imuSample_t *sample)
+{
+    if(imu->count == 0)
+        return false;
+
+    *sample = imu->ring[imu->head];
+    imu->head = (imu->head + 1) % BMI160_RING_LENGTH;
+    imu->count--;
+
+    return true;
+}
@@ -0,0 +1,373 @@
+/**
+ * @file AVR_SPI_cache.c
+ * @author Lukas Ternjej
+ *
+ * Storage block cache .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include <string.h>
+
+#include "AVR_SPI_cache.h"
+
+/**
+ * Function that sets up an empty cache for a storage device.
+ *
+ * @param cache cache state
+ * @param storage storage driver state, passed to read and write functions
+ * @param read function that reads consecutive blocks in a single transaction
+ * @param write function that writes a single block, NULL for read-only storage
+ * @param readAhead number of blocks loaded after a sequential miss, 0 - CACHE_LINES / 2 - 1; a stream takes at most half of the lines
+ */
+void SPI_cacheInit(SPI_cache_t *cache, void *storage, bool (*read)(void *, uint32_t, uint8_t *[], uint8_t),
+                   bool (*write)(void *, uint32_t, const uint8_t[]), uint8_t readAhead)
+{
+    cache->storage = storage;
+    cache->read = read;
+    cache->write = write;
+    cache->readAhead = readAhead > CACHE_LINES / 2 - 1 ? CACHE_LINES / 2 - 1 : readAhead;
+
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->aheadBlocks = 0;
+    cache->aheadHits = 0;
+    cache->writeBacks = 0;
+
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+        cache->lines[i].rank = i;
+
+    SPI_cacheInvalidate(cache);
+}
+
+/**
+ * Function that makes a line the most recently used line.
+ *
+ * @param cache cache state
+ * @param line used line
+ */
+static void SPI_cacheTouch(SPI_cache_t *cache, SPI_cacheLine_t *line)
+{
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+    {
+        if(cache->lines[i].rank < line->rank)
+            cache->lines[i].rank++;
+    }
+
+    line->rank = 0;
+}
+
+/**
+ * Function that makes a line the least recently used line.
+ *
+ * @param cache cache state
+ * @param line demoted line
+ */
+static void SPI_cacheDemote(SPI_cache_t *cache, SPI_cacheLine_t *line)
+{
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+    {
+        if(cache->lines[i].rank > line->rank)
+            cache->lines[i].rank--;
+    }
+
+    line->rank = CACHE_LINES - 1;
+}
+
+/**
+ * Function that finds the line that holds a block.
+ *
+ * @param cache cache state
+ * @param block storage address / CACHE_BLOCK_LENGTH
+ * @return line with the block, NULL if block isn't cached
+ */
+static SPI_cacheLine_t *SPI_cacheFind(SPI_cache_t *cache, uint32_t block)
+{
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+    {
+        if(cache->lines[i].valid && cache->lines[i].block == block)
+            return &cache->lines[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * Function that frees a line for a new block: an empty line if there is one, else the least recently used line.
+ * Dirty block is written to storage first. Freed line becomes the most recently used line.
+ *
+ * @param cache cache state
+ * @param taken number of lines already freed for the same load, they are the most recently used lines and are skipped
+ * @return freed line, NULL if write-back failed
+ */
+static SPI_cacheLine_t *SPI_cacheVictim(SPI_cache_t *cache, uint8_t taken)
+{
+    SPI_cacheLine_t *victim = NULL;
+
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+    {
+        SPI_cacheLine_t *line = &cache->lines[i];
+
+        if(line->rank < taken)
+            continue;
+
+        if(!line->valid)
+        {
+            victim = line;
+            break;
+        }
+
+        if(victim == NULL || line->rank > victim->rank)
+            victim = line;
+    }
+
+    if(victim->valid && victim->dirty)
+    {
+        if(!cache->write(cache->storage, victim->block * CACHE_BLOCK_LENGTH, victim->data))
+            return NULL;
+
+        victim->dirty = false;
+        cache->writeBacks++;
+    }
+
+    victim->valid = false;
+    victim->ahead = false;
+    victim->stream = false;
+    SPI_cacheTouch(cache, victim);
+
+    return victim;
+}
+
+/**
+ * Function that loads a block from storage. If the block follows the last loaded block, up to ahead following
+ * blocks are loaded in the same storage transaction; read-ahead stops at the first block that is already cached.
+ * Blocks of a sequential stream are kept at the LRU end, so a long stream doesn't evict frequently used blocks.
+ *
+ * @param cache cache state
+ * @param block storage address / CACHE_BLOCK_LENGTH
+ * @param ahead maximum number of blocks read ahead
+ * @return line with the block, NULL if storage read or write-back failed
+ */
+static SPI_cacheLine_t *SPI_cacheLoad(SPI_cache_t *cache, uint32_t block, uint8_t ahead)
+{
+    SPI_cacheLine_t *loaded[CACHE_LINES] = {NULL};
+    uint8_t *blocks[CACHE_LINES];
+    uint8_t count = 1;
+    bool sequential = (block == cache->nextBlock);
+
+    if(!sequential)
+        ahead = 0;     // random access, read-ahead would only evict useful blocks
+
+    while(count <= ahead && SPI_cacheFind(cache, block + count) == NULL)
+        count++;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        loaded[i] = SPI_cacheVictim(cache, i);
+
+        if(loaded[i] == NULL)
+            return NULL;
+
+        loaded[i]->block = block + i;
+        loaded[i]->ahead = (i > 0);
+        blocks[i] = loaded[i]->data;
+    }
+
+    if(!cache->read(cache->storage, block * CACHE_BLOCK_LENGTH, blocks, count))
+        return NULL;
+
+    for(uint8_t i = count; i > 0; i--)
+    {
+        loaded[i - 1]->valid = true;
+        loaded[i - 1]->stream = sequential;
+
+        // requested block ends up first in eviction order of a stream, or the most recently used block otherwise
+        if(sequential)
+            SPI_cacheDemote(cache, loaded[i - 1]);
+    }
+
+    if(sequential)
+        cache->streamBlock = block;
+
+    else
+        SPI_cacheTouch(cache, loaded[0]);
+
+    cache->misses++;
+    cache->aheadBlocks += count - 1;
+    cache->nextBlock = block + count;
+
+    return loaded[0];
+}
+
+/**
+ * Function that returns the line with a block, from RAM if it is cached or else loaded from storage.
+ *
+ * @param cache cache state
+ * @param block storage address / CACHE_BLOCK_LENGTH
+ * @param ahead maximum number of blocks read ahead on a miss
+ * @return line with the block, NULL if storage read or write-back failed
+ */
+static SPI_cacheLine_t *SPI_cacheGet(SPI_cache_t *cache, uint32_t block, uint8_t ahead)
+{
+    SPI_cacheLine_t *line = SPI_cacheFind(cache, block);
+
+    if(line == NULL)
+        return SPI_cacheLoad(cache, block, ahead);
+
+    if(line->stream)
+    {
+        // stream reads its current block or the next read-ahead block; other block of a stream is used again, so it is kept
+        if(line->ahead || block == cache->streamBlock)
+            cache->streamBlock = block;
+
+        else
+            line->stream = false;
+    }
+
+    if(line->ahead)
+    {
+        line->ahead = false;
+        cache->aheadHits++;
+    }
+
+    cache->hits++;
+
+    if(!line->stream)
+        SPI_cacheTouch(cache, line);
+
+    return line;
+}
+
+/**
+ * Function that reads bytes from storage through the cache.
+ *
+ * @param cache cache state
+ * @param address storage address of the first byte
+ * @param buffer array where bytes are stored
+ * @param numBytes number of bytes
+ * @return true if bytes are read; else, return false (storage read or write-back failed)
+ */
+bool SPI_cacheRead(SPI_cache_t *cache, uint32_t address, uint8_t buffer[], uint16_t numBytes)
+{
+    while(numBytes > 0)
+    {
+        uint16_t offset = address % CACHE_BLOCK_LENGTH;
+        uint16_t chunk = CACHE_BLOCK_LENGTH - offset;
+
+        if(chunk > numBytes)
+            chunk = numBytes;
+
+        SPI_cacheLine_t *line = SPI_cacheGet(cache, address / CACHE_BLOCK_LENGTH, cache->readAhead);
+
+        if(line == NULL)
+            return false;
+
+        memcpy(buffer, &line->data[offset], chunk);
+
+        buffer += chunk;
+        address += chunk;
+        numBytes -= chunk;
+    }
+
+    return true;
+}
+
+/**
+ * Function that writes bytes to the cache. Blocks are written to storage when they are evicted or flushed.
+ *
+ * @param cache cache state
+ * @param address storage address of the first byte
+ * @param data array of bytes that are going to be written
+ * @param numBytes number of bytes
+ * @return true if bytes are written; else, return false (read-only storage, storage read or write-back failed)
+ */
+bool SPI_cacheWrite(SPI_cache_t *cache, uint32_t address, const uint8_t data[], uint16_t numBytes)
+{
+    if(cache->write == NULL)
+        return false;
+
+    while(numBytes > 0)
+    {
+        uint32_t block = address / CACHE_BLOCK_LENGTH;
+        uint16_t offset = address % CACHE_BLOCK_LENGTH;
+        uint16_t chunk = CACHE_BLOCK_LENGTH - offset;
+
+        if(chunk > numBytes)
+            chunk = numBytes;
+
+        SPI_cacheLine_t *line;
+
+        if(chunk == CACHE_BLOCK_LENGTH && SPI_cacheFind(cache, block) == NULL)
+        {
+            // whole block is overwritten, so it isn't read from storage
+            line = SPI_cacheVictim(cache, 0);
+
+            if(line != NULL)
+            {
+                line->block = block;
+                line->valid = true;
+                cache->misses++;
+            }
+        }
+
+        else
+            line = SPI_cacheGet(cache, block, 0);
+
+        if(line == NULL)
+            return false;
+
+        memcpy(&line->data[offset], data, chunk);
+        line->dirty = true;
+
+        data += chunk;
+        address += chunk;
+        numBytes -= chunk;
+    }
+
+    return true;
+}
+
+/**
+ * Function that writes all dirty blocks to storage. Blocks stay cached.
+ ** Call this function before power down or before storage is accessed without the cache.
+ *
+ * @param cache cache state
+ * @return true if all dirty blocks are written; else, return false
+ */
+bool SPI_cacheFlush(SPI_cache_t *cache)
+{
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+    {
+        SPI_cacheLine_t *line = &cache->lines[i];
+
+        if(!line->valid || !line->dirty)
+            continue;
+
+        if(!cache->write(cache->storage, line->block * CACHE_BLOCK_LENGTH, line->data))
+            return false;
+
+        line->dirty = false;
+        cache->writeBacks++;
+    }
+
+    return true;
+}
+
+/**
+ * Function that drops all cached blocks without writing them, for example after storage was erased.
+ *
+ * @param cache cache state
+ */
+void SPI_cacheInvalidate(SPI_cache_t *cache)
+{
+    for(uint8_t i = 0; i < CACHE_LINES; i++)
+    {
+        cache->lines[i].valid = false;
+        cache->lines[i].dirty = false;
+        cache->lines[i].ahead = false;
+        cache->lines[i].stream = false;
+    }
+
+    cache->nextBlock = CACHE_NO_BLOCK;     // block 0 isn't sequential after invalidation
+    cache->streamBlock = CACHE_NO_BLOCK;
+}
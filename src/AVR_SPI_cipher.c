@@ -0,0 +1,295 @@
+/**
+ * @file AVR_SPI_cipher.c
+ * @author Lukas Ternjej
+ *
+ * XTEA-CTR payload encryption .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_cipher.h"
+
+#define XTEA_DELTA  0x9E3779B9
+#define XTEA_ROUNDS 32
+
+/**
+ * Function that encrypts a single 64 bit block with XTEA.
+ *
+ * @param block two 32 bit halves of the block, encrypted in place
+ * @param key 128 bit key
+ */
+static void XTEA_encipher(uint32_t block[2], const uint32_t key[4])
+{
+    uint32_t v0 = block[0], v1 = block[1], sum = 0;
+
+    for(uint8_t i = 0; i < XTEA_ROUNDS; i++)
+    {
+        v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + key[sum & 3]);
+        sum += XTEA_DELTA;
+        v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ (sum + key[(sum >> 11) & 3]);
+    }
+
+    block[0] = v0;
+    block[1] = v1;
+}
+
+/**
+ * Function that computes a single keystream block into keystream ring. Block that was computed while ISR routine
+ * restarted or resynchronized the keystream is discarded.
+ *
+ * @param cipher cipher state
+ */
+void SPI_cipherBlock(SPI_cipher_t *cipher)
+{
+    uint8_t sreg = SREG;
+    cli();     // ISR routine can restart or move the keystream, nonce and counter have to be read together
+
+    uint32_t nonce = cipher->nonce;
+    uint32_t counter = cipher->counter;
+
+    SREG = sreg;
+
+    uint32_t block[2] = {nonce, counter};
+
+    XTEA_encipher(block, cipher->key);     // slow part is done outside of critical section
+
+    cli();
+
+    // block depends only on key, nonce and counter, so it is valid as long as keystream continues from that block
+    if(cipher->nonce == nonce && cipher->counter == counter && CIPHER_KEYSTREAM_LENGTH - cipher->count >= CIPHER_BLOCK_LENGTH)
+    {
+        uint8_t tail = cipher->head + cipher->count;
+
+        for(uint8_t i = 0; i < CIPHER_BLOCK_LENGTH; i++)
+            cipher->keystream[(tail + i) & (CIPHER_KEYSTREAM_LENGTH - 1)] = block[i >> 2] >> ((i & 3) * 8);
+
+        cipher->count += CIPHER_BLOCK_LENGTH;
+        cipher->counter++;
+    }
+
+    SREG = sreg;
+}
+
+/**
+ * Function that moves keystream to the start of the next block. Ring is filled with whole blocks, so bytes that
+ * don't make a whole block are the rest of the block that the previous message ended in.
+ *
+ * @param cipher cipher state
+ */
+static void SPI_cipherAlign(SPI_cipher_t *cipher)
+{
+    uint8_t rest = cipher->count % CIPHER_BLOCK_LENGTH;
+
+    cipher->head = (cipher->head + rest) & (CIPHER_KEYSTREAM_LENGTH - 1);
+    cipher->count -= rest;
+}
+
+/**
+ * Function that precomputes keystream blocks until keystream ring is full. Call this function in idle time.
+ * Keystream is only computed here and on master side while transmitting, never in ISR routine.
+ *
+ * @param cipher cipher state
+ */
+void SPI_cipherRefill(SPI_cipher_t *cipher)
+{
+    while(cipher->started && CIPHER_KEYSTREAM_LENGTH - cipher->count >= CIPHER_BLOCK_LENGTH)
+        SPI_cipherBlock(cipher);
+}
+
+/**
+ * Function that moves keystream to the start of a block, where a message starts. Rest of the block that the previous
+ * message ended in is skipped. It doesn't compute blocks, so it can be called from ISR routine.
+ *
+ * @param cipher cipher state
+ * @param block low bits of the block counter that the message starts at
+ * @return true if keystream is at the block; false if block is behind keystream (repeated or stale message), or
+ * isn't precomputed yet (keystream ring continues from the block after the next refill)
+ */
+bool SPI_cipherSeek(SPI_cipher_t *cipher, uint16_t block)
+{
+    uint8_t sreg = SREG;
+    cli();     // keystream ring is shared between main loop and ISR routine
+
+    SPI_cipherAlign(cipher);
+
+    uint8_t blocks = cipher->count / CIPHER_BLOCK_LENGTH;
+    uint32_t headBlock = cipher->counter - blocks;
+    uint16_t ahead = block - (uint16_t)headBlock;     // blocks that master is ahead, behind if >= 0x8000
+    bool ready = false;
+
+    if(ahead != 0)
+        cipher->resyncs++;
+
+    if(ahead < blocks)
+    {
+        // messages were lost, skip their keystream
+        cipher->head = (cipher->head + ahead * CIPHER_BLOCK_LENGTH) & (CIPHER_KEYSTREAM_LENGTH - 1);
+        cipher->count -= ahead * CIPHER_BLOCK_LENGTH;
+        ready = true;
+    }
+
+    else if(ahead < 0x8000)
+    {
+        // block isn't precomputed, ring is refilled from it
+        cipher->counter = headBlock + ahead;
+        cipher->head = (cipher->head + cipher->count) & (CIPHER_KEYSTREAM_LENGTH - 1);
+        cipher->count = 0;
+        cipher->underruns++;
+    }
+
+    SREG = sreg;
+
+    return ready && cipher->started;
+}
+
+/**
+ * Function that starts a new session on slave side, called from ISR routine when session start message is received.
+ * Keystream ring is emptied and computed again by SPI_cipherRefill() in the main loop.
+ *
+ * @param cipher cipher state
+ * @param nonce nonce of the session
+ */
+void SPI_cipherRestart(SPI_cipher_t *cipher, uint32_t nonce)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    cipher->nonce = nonce;
+    cipher->counter = 0;
+    cipher->head = 0;
+    cipher->count = 0;
+    cipher->started = true;
+
+    SREG = sreg;
+}
+
+/**
+ * Function that initializes cipher state with a key. Keystream is computed after a session is started:
+ * with SPI_transmitNonce() on master side, when the session start message is received on slave side.
+ *
+ * @param cipher cipher state
+ * @param key 128 bit key
+ */
+void SPI_cipherInit(SPI_cipher_t *cipher, const uint32_t key[4])
+{
+    for(uint8_t i = 0; i < 4; i++)
+        cipher->key[i] = key[i];
+
+    cipher->nonce = 0;
+    cipher->counter = 0;
+    cipher->head = 0;
+    cipher->count = 0;
+    cipher->started = false;
+    cipher->underruns = 0;
+    cipher->resyncs = 0;
+}
+
+/**
+ * Function that returns a nonce that hasn't been used with the key, from a boot counter in EEPROM that is
+ * incremented on every call. Master calls it once per session (for example after every reset).
+ *! Keystream repeats if a nonce is used twice with the same key, so the counter must never be reset while the key is used!
+ *
+ * @param bootCounter boot counter in EEPROM, declared with EEMEM
+ * @return fresh nonce
+ */
+uint32_t SPI_cipherSessionNonce(uint32_t *bootCounter)
+{
+    uint32_t nonce = eeprom_read_dword(bootCounter) + 1;
+
+    eeprom_update_dword(bootCounter, nonce);     // stored before it is used, so a reset can't reuse it
+
+    return nonce;
+}
+
+/**
+ * Function that writes a byte to SPDR register, escaped if it equals a control character.
+ *
+ * @param data uint8_t that is going to be written to SPDR register
+ */
+static void SPI_masterPutEscaped(uint8_t data)
+{
+    if(data == DATA_END_CHAR || data == DUMMY_CHAR || data == ESCAPE_CHAR || data == CIPHER_NONCE_CHAR)
+    {
+        SPI_masterPutUint8_t(ESCAPE_CHAR);
+        data ^= ESCAPE_XOR;
+    }
+
+    SPI_masterPutUint8_t(data);
+}
+
+/**
+ * Function that starts a session: master cipher state restarts at block 0 with the nonce, and the nonce is sent to
+ * slave in clear as [CIPHER_NONCE_CHAR] message. Slave main loop needs time to refill keystream before the next
+ * encrypted message, messages that arrive earlier are dropped and counted in underruns.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param cipher cipher state of the slave device
+ * @param nonce fresh nonce, from SPI_cipherSessionNonce()
+ */
+void SPI_transmitNonce(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, SPI_cipher_t *cipher, uint32_t nonce)
+{
+    SPI_cipherRestart(cipher, nonce);
+
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    SPI_masterPutUint8_t(CIPHER_NONCE_CHAR);
+
+    for(int8_t i = CIPHER_NONCE_LENGTH - 1; i >= 0; i--)
+        SPI_masterPutEscaped(nonce >> (i * 8));     // most significant byte first
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+
+    SPI_cipherRefill(cipher);
+}
+
+/**
+ * Function for transmitting an encrypted string of chars via SPI, with SS line control.
+ * Message starts with its keystream block counter and check byte in clear, followed by the encrypted string.
+ * Bytes that equal [DATA_END_CHAR], [DUMMY_CHAR], [ESCAPE_CHAR] or [CIPHER_NONCE_CHAR] are sent as [ESCAPE_CHAR], byte ^ [ESCAPE_XOR].
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param cipher cipher state of the slave device
+ * @param data char pointer that pints to an array element (string), for transmissio via SPI
+ * @return false if session hasn't been started with SPI_transmitNonce(), nothing is sent; else, return true
+ */
+bool SPI_transmitStringEncrypted(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, SPI_cipher_t *cipher, char *data)
+{
+    if(!cipher->started)
+        return false;
+
+    SPI_cipherAlign(cipher);     // message starts at a new block
+
+    if(cipher->count == 0)
+        SPI_cipherBlock(cipher);
+
+    uint16_t block = cipher->counter - cipher->count / CIPHER_BLOCK_LENGTH;
+
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    SPI_masterPutEscaped(block >> 8);     // block counter in clear, slave resynchronizes to it
+    SPI_masterPutEscaped(block);
+    SPI_masterPutEscaped(CIPHER_SYNC_CHECK(block));
+
+    while(*data)
+    {
+        if(cipher->count == 0)
+            SPI_cipherBlock(cipher);     // master computes keystream on the spot, between two bytes
+
+        SPI_masterPutEscaped(*data ^ SPI_cipherNext(cipher));     // encrypt and write data to SPDR register
+        data++;
+    }
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // [DATA_END_CHAR] is not encrypted
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+
+    return true;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file AVR_SPI_fec.c
+ * @author Lukas Ternjej
+ *
+ * Hamming(7,4) forward error correction .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_fec.h"
+
+// codeword bit order is p1 p2 d1 p3 d2 d3 d4 (bit 0 to bit 6), xored with 0x01 so all-ones codeword isn't [DUMMY_CHAR]
+const uint8_t FEC_encodeTable[16] PROGMEM = {
+    0x81, 0xCA, 0xAB, 0xE0, 0x98, 0xD3, 0xB2, 0xF9, 0x86, 0xCD, 0xAC, 0xE7, 0x9F, 0xD4, 0xB5, 0xFE,
+};
+
+// syndrome of every 7 bit value is precomputed, so decoding is a single table read in ISR routine
+const uint8_t FEC_decodeTable[128] PROGMEM = {
+    0x10, 0x00, 0x18, 0x10, 0x18, 0x10, 0x08, 0x18, 0x14, 0x10, 0x11, 0x12, 0x1A, 0x19, 0x18, 0x1C,
+    0x14, 0x10, 0x16, 0x15, 0x1D, 0x1E, 0x18, 0x1C, 0x04, 0x14, 0x14, 0x1C, 0x14, 0x1C, 0x1C, 0x0C,
+    0x13, 0x10, 0x16, 0x12, 0x1A, 0x1E, 0x18, 0x1B, 0x1A, 0x12, 0x12, 0x02, 0x0A, 0x1A, 0x1A, 0x12,
+    0x16, 0x1E, 0x06, 0x16, 0x1E, 0x0E, 0x16, 0x1E, 0x14, 0x17, 0x16, 0x12, 0x1A, 0x1E, 0x1F, 0x1C,
+    0x13, 0x10, 0x11, 0x15, 0x1D, 0x19, 0x18, 0x1B, 0x11, 0x19, 0x01, 0x11, 0x19, 0x09, 0x11, 0x19,
+    0x1D, 0x15, 0x15, 0x05, 0x0D, 0x1D, 0x1D, 0x15, 0x14, 0x17, 0x11, 0x15, 0x1D, 0x19, 0x1F, 0x1C,
+    0x03, 0x13, 0x13, 0x1B, 0x13, 0x1B, 0x1B, 0x0B, 0x13, 0x17, 0x11, 0x12, 0x1A, 0x19, 0x1F, 0x1B,
+    0x13, 0x17, 0x16, 0x15, 0x1D, 0x1E, 0x1F, 0x1B, 0x17, 0x07, 0x1F, 0x17, 0x1F, 0x17, 0x0F, 0x1F,
+};
+
+volatile uint16_t SPI_fecCorrected = 0;
+
+/**
+ * Function that writes a data byte to SPDR register as two code bytes, high nibble first.
+ *
+ * @param data uint8_t that is going to be encoded and written to SPDR register
+ */
+static void SPI_masterPutFEC(uint8_t data)
+{
+    SPI_masterPutUint8_t(pgm_read_byte(&FEC_encodeTable[data >> 4]));
+    SPI_masterPutUint8_t(pgm_read_byte(&FEC_encodeTable[data & 0x0F]));
+}
+
+/**
+ * Function for transmitting a Hamming(7,4) encoded string of chars via SPI, with SS line control.
+ * Slave has to be built with SPI_USE_FEC enabled.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param data char pointer that pints to an array element (string), for transmissio via SPI
+ */
+void SPI_transmitStringFEC(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, char *data)
+{
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    while(*data)
+    {
+        SPI_masterPutFEC(*data);     // encode and write data to SPDR register
+        data++;
+    }
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // [DATA_END_CHAR] is not encoded
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+}
+
+/**
+ * Function for transmitting a Hamming(7,4) encoded hex number via SPI, with SS line control.
+ * Slave has to be built with SPI_USE_FEC enabled.
+ *! [HEX_DATA_BYTES] has to be less or equal to 8!
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param numBytes number of hex bytes that are going to be sent via SPI.
+ * @param hexNumber hex number that is going to be transmitted via SPI
+ */
+void SPI_transmitHexFEC(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t numBytes, uint64_t hexNumber)
+{
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    for(int i = numBytes - 1; i >= 0; i--)
+        SPI_masterPutFEC((hexNumber >> (i * 8)) & 0xFF);     // encode and send each byte of the hexadecimal number
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);                     // [DATA_END_CHAR] is not encoded
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+}
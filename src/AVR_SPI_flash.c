@@ -0,0 +1,228 @@
+/**
+ * @file AVR_SPI_flash.c
+ * @author Lukas Ternjej
+ *
+ * 25xx SPI NOR flash driver .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_flash.h"
+
+/**
+ * Function that selects flash and transmits a command with a 24-bit address.
+ *
+ * @param flash driver state
+ * @param command command byte
+ * @param address memory address
+ */
+static void SPI_flashCommand(SPI_flash_t *flash, uint8_t command, uint32_t address)
+{
+    SPI_deviceSelect(flash->device);     // start transmission
+
+    SPI_masterPutUint8_t(command);
+    SPI_masterPutUint8_t(address >> 16);
+    SPI_masterPutUint8_t(address >> 8);
+    SPI_masterPutUint8_t(address);
+}
+
+/**
+ * Function that sets write enable latch, flash clears it after every program or erase.
+ *
+ * @param flash driver state
+ */
+static void SPI_flashWriteEnable(SPI_flash_t *flash)
+{
+    SPI_deviceSelect(flash->device);
+    SPI_masterPutUint8_t(FLASH_CMD_WRITE_ENABLE);
+    SPI_deviceRelease(flash->device);
+}
+
+/**
+ * Function that reads JEDEC ID of flash and sets flash size.
+ *
+ * @param flash driver state
+ * @param device flash on SPI bus
+ * @return true if flash responded with a valid ID; else, return false
+ */
+bool SPI_flashInit(SPI_flash_t *flash, SPI_device_t *device)
+{
+    uint8_t id[4] = {FLASH_CMD_JEDEC_ID, DUMMY_CHAR, DUMMY_CHAR, DUMMY_CHAR};
+
+    flash->device = device;
+    flash->size = 0;
+    flash->busy = true;     // program or erase from before reset can still be in progress
+
+    SPI_transferBytes(device, id, id, 4);
+
+    // manufacturer, memory type, capacity as power of 2; floating or shorted MISO reads 0xFF or 0x00
+    if(id[1] == 0xFF || id[1] == 0x00 || id[3] < 16 || id[3] > 24)
+        return false;
+
+    flash->size = 1UL << id[3];
+
+    return true;
+}
+
+/**
+ * Function that checks if program or erase is in progress.
+ *
+ * @param flash driver state
+ * @return true if flash is busy; else, return false
+ */
+bool SPI_flashBusy(SPI_flash_t *flash)
+{
+    uint8_t status[2] = {FLASH_CMD_READ_STATUS, DUMMY_CHAR};
+
+    if(!flash->busy)
+        return false;     // nothing was started since flash was idle, no need to ask
+
+    SPI_transferBytes(flash->device, status, status, 2);
+    flash->busy = status[1] & FLASH_STATUS_BUSY;
+
+    return flash->busy;
+}
+
+/**
+ * Function that waits until program or erase is finished.
+ *
+ * @param flash driver state
+ */
+void SPI_flashWait(SPI_flash_t *flash)
+{
+    while(SPI_flashBusy(flash))
+        _delay_us(50);     // page program takes about 400us, sector erase about 45ms
+}
+
+/**
+ * Function that reads bytes in a single transaction.
+ *
+ * @param flash driver state
+ * @param address address of the first byte
+ * @param buffer array where bytes are stored
+ * @param numBytes number of bytes
+ */
+void SPI_flashRead(SPI_flash_t *flash, uint32_t address, uint8_t buffer[], uint16_t numBytes)
+{
+    SPI_flashReadStart(flash, address);
+
+    for(uint16_t i = 0; i < numBytes; i++)
+        buffer[i] = SPI_masterReadUint8_t();
+
+    SPI_flashReadStop(flash);
+}
+
+/**
+ * Function that starts a read transaction; bytes from address on are read with SPI_masterReadUint8_t()
+ * until SPI_flashReadStop(). Reads any number of bytes without a buffer and without repeating the address.
+ *
+ * @param flash driver state
+ * @param address address of the first byte
+ */
+void SPI_flashReadStart(SPI_flash_t *flash, uint32_t address)
+{
+    SPI_flashWait(flash);
+    SPI_flashCommand(flash, FLASH_CMD_READ, address);
+}
+
+/**
+ * Function that ends a read transaction started with SPI_flashReadStart().
+ *
+ * @param flash driver state
+ */
+void SPI_flashReadStop(SPI_flash_t *flash)
+{
+    SPI_deviceRelease(flash->device);     // end transmission
+}
+
+/**
+ * Function that reads consecutive cache blocks in a single transaction, read function for SPI_cacheInit().
+ *
+ * @param flash driver state (SPI_flash_t)
+ * @param address address of the first block
+ * @param blocks arrays of CACHE_BLOCK_LENGTH bytes where blocks are stored
+ * @param count number of blocks
+ * @return always true
+ */
+bool SPI_flashReadBlocks(void *flash, uint32_t address, uint8_t *blocks[], uint8_t count)
+{
+    SPI_flashWait(flash);
+    SPI_flashCommand(flash, FLASH_CMD_READ, address);
+
+    for(uint8_t b = 0; b < count; b++)
+    {
+        for(uint16_t i = 0; i < CACHE_BLOCK_LENGTH; i++)
+            blocks[b][i] = SPI_masterReadUint8_t();
+    }
+
+    SPI_deviceRelease(((SPI_flash_t *)flash)->device);     // end transmission
+
+    return true;
+}
+
+/**
+ * Function that starts programming bytes. Bits can only be cleared, programmed area has to be erased first.
+ *! Bytes have to be within a single page, program wraps to the start of the page.
+ *
+ * @param flash driver state
+ * @param address address of the first byte
+ * @param data array of bytes that are going to be programmed
+ * @param numBytes number of bytes, 1 - FLASH_PAGE_LENGTH
+ */
+void SPI_flashProgram(SPI_flash_t *flash, uint32_t address, const uint8_t data[], uint16_t numBytes)
+{
+    SPI_flashWait(flash);
+    SPI_flashWriteEnable(flash);
+    SPI_flashCommand(flash, FLASH_CMD_PAGE_PROGRAM, address);
+
+    for(uint16_t i = 0; i < numBytes; i++)
+        SPI_masterPutUint8_t(data[i]);
+
+    SPI_deviceRelease(flash->device);     // end transmission, flash starts programming
+    flash->busy = true;
+}
+
+/**
+ * Function that starts erasing a sector, all its bytes become 0xFF.
+ *
+ * @param flash driver state
+ * @param address any address in the sector
+ */
+void SPI_flashEraseSector(SPI_flash_t *flash, uint32_t address)
+{
+    SPI_flashWait(flash);
+    SPI_flashWriteEnable(flash);
+    SPI_flashCommand(flash, FLASH_CMD_SECTOR_ERASE, address);
+    SPI_deviceRelease(flash->device);     // end transmission, flash starts erasing
+    flash->busy = true;
+}
+
+/**
+ * Function that suspends erase in progress and waits until flash accepts other commands.
+ * Other sectors can be read and programmed while erase is suspended.
+ *! Suspended sector must not be read or programmed, and no other erase can be started before SPI_flashResume().
+ *
+ * @param flash driver state
+ */
+void SPI_flashSuspend(SPI_flash_t *flash)
+{
+    SPI_deviceSelect(flash->device);
+    SPI_masterPutUint8_t(FLASH_CMD_ERASE_SUSPEND);
+    SPI_deviceRelease(flash->device);
+    flash->busy = true;
+
+    SPI_flashWait(flash);     // busy bit clears after about 20us
+}
+
+/**
+ * Function that resumes suspended erase, flash is busy again until the erase is finished.
+ *
+ * @param flash driver state
+ */
+void SPI_flashResume(SPI_flash_t *flash)
+{
+    SPI_deviceSelect(flash->device);
+    SPI_masterPutUint8_t(FLASH_CMD_ERASE_RESUME);
+    SPI_deviceRelease(flash->device);
+    flash->busy = true;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file AVR_SPI_hub.c
+ * @author Lukas Ternjej
+ *
+ * Cut-through SPI hub .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_hub.h"
+
+#if SPI_USE_HUB
+SPI_device_t *volatile SPI_hubTarget = NULL;
+volatile bool SPI_hubHeader = false;
+
+static SPI_device_t *hubPorts = NULL;
+static uint8_t hubPortCount = 0;
+
+/**
+ * Function that initializes USART in master SPI mode as downstream bus, and SS pin change interrupt.
+ * Upstream SPI module has to be initialized with SPI_init() in SLAVE_MODE.
+ *! SS pins of downstream ports have to be set as outputs by application.
+ *
+ * @param ports array of downstream slave devices, port n is addressed with [HUB_HEADER_CHAR] + n
+ * @param count number of array elements
+ * @param dataOrder least or most significant bit first
+ * @param SPIMode SPI mode 0, 1, 2 or 3
+ * @param ubrr downstream SCK is F_CPU / (2 * (ubrr + 1)), 0 for F_CPU/2
+ */
+void SPI_hubInit(SPI_device_t ports[], uint8_t count, uint8_t dataOrder, uint8_t SPIMode, uint16_t ubrr)
+{
+    hubPorts = ports;
+    hubPortCount = count;
+
+    for(uint8_t i = 0; i < count; i++)
+        SPI_slaveRelease(ports[i].SS_PORTx, ports[i].SS_PORTxn, ports[i].SSmode);
+
+    UBRR0 = 0;
+
+    // XCK as output selects master mode, set MOSI (TXD) as output and MISO (RXD) as input
+    USART_SPI_DDRx |= (1 << USART_SCK_PIN_PORTxn) | (1 << USART_MOSI_PIN_PORTxn);
+    USART_SPI_DDRx &= ~(1 << USART_MISO_PIN_PORTxn);
+
+    UCSR0C = (1 << UMSEL01) | (1 << UMSEL00);     // master SPI mode
+
+    if(dataOrder == LSB_FIRST)
+        UCSR0C |= (1 << UDORD0);
+
+    if(SPIMode == SPI_MODE_1 || SPIMode == SPI_MODE_3)
+        UCSR0C |= (1 << UCPHA0);
+
+    if(SPIMode == SPI_MODE_2 || SPIMode == SPI_MODE_3)
+        UCSR0C |= (1 << UCPOL0);
+
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0);
+    UBRR0 = ubrr;     // baud rate has to be set after transmitter is enabled
+
+    // interrupt on both edges of upstream SS
+    SS_PCMSKx |= (1 << SS_PCINTn);
+    PCICR |= (1 << SS_PCIEx);
+}
+
+/**
+ * Function that selects downstream port for a message header. Called from ISR routine for first byte of a message.
+ *
+ * @param header first byte of a message
+ * @return true if message is forwarded downstream, false if it is handled by hub itself
+ */
+bool SPI_hubSelect(uint8_t header)
+{
+    uint8_t port = header - HUB_HEADER_CHAR;
+
+    if(header < HUB_HEADER_CHAR || port >= hubPortCount)
+        return false;
+
+    SPI_device_t *device = &hubPorts[port];
+
+    SPI_slaveSelect(device->SS_PORTx, device->SS_PORTxn, device->SSmode);
+    SPI_hubTarget = device;
+
+    return true;
+}
+
+/**
+ * Interrupt service routine for upstream SS pin changes. Falling edge starts a message,
+ * rising edge releases the downstream port.
+ */
+ISR(SS_PCINT_vect)
+{
+    if(!(SPI_PINx & (1 << SS_PIN_PORTxn)))
+    {
+        SPI_hubHeader = true;
+        return;
+    }
+
+    SPI_hubHeader = false;
+
+    if(SPI_hubTarget != NULL)
+    {
+        // this interrupt has priority over SPI_STC_vect, forward the last byte if it is still pending
+        if(SPSR & (1 << SPIF))
+            SPDR = SPI_hubExchange(SPDR);
+
+        SPI_slaveRelease(SPI_hubTarget->SS_PORTx, SPI_hubTarget->SS_PORTxn, SPI_hubTarget->SSmode);
+        SPI_hubTarget = NULL;
+    }
+}
+#endif
+
+/**
+ * Function for transmitting a string of chars to a slave behind a hub, with SS line control.
+ *
+ * @param hub hub device on master bus
+ * @param port downstream port of the hub
+ * @param data char pointer that points to an array element (string), for transmission via SPI
+ */
+void SPI_hubTransmitString(SPI_device_t *hub, uint8_t port, char *data)
+{
+    SPI_deviceSelect(hub);     // start transmission
+
+    SPI_masterPutUint8_t(HUB_HEADER_CHAR + port);     // header selects downstream port
+
+    if(*data)
+        SPI_masterPutFirst(*data++);     // downstream slave receives data from this byte on
+
+    while(*data)
+    {
+        SPI_masterPutUint8_t(*data);     // write data to SPDR register
+        data++;
+    }
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
+
+    SPI_deviceRelease(hub);     // end transmission
+}
+
+/**
+ * Function that reads multiple bytes from a slave behind a hub, with SS line control.
+ * Hub returns downstream byte with the next upstream byte, so one extra byte is clocked.
+ *! Hub loads downstream byte into SPDR about 53 cycles after an upstream byte ends, hub device needs byteGap of at least BYTE_GAP_CYCLES(45)!
+ *
+ * @param hub hub device on master bus
+ * @param port downstream port of the hub
+ * @param buffer array where received bytes are going to be stored
+ * @param numBytes number of bytes that are going to be read
+ */
+void SPI_hubReceiveBytes(SPI_device_t *hub, uint8_t port, uint8_t buffer[], size_t numBytes)
+{
+    SPI_deviceSelect(hub);     // start transmission
+
+    SPI_masterPutUint8_t(HUB_HEADER_CHAR + port);     // header selects downstream port
+    SPI_masterReadUint8_t();                          // clocks first downstream byte into hub
+
+    for(size_t i = 0; i < numBytes; i++)
+        buffer[i] = SPI_masterReadUint8_t();
+
+    SPI_deviceRelease(hub);     // end transmission
+}
@@ -0,0 +1,467 @@
+/**
+ * @file AVR_SPI_kv.c
+ * @author Lukas Ternjej
+ *
+ * Key-value store on SPI flash .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include <string.h>
+
+#include "AVR_SPI_kv.h"
+
+/**
+ * Function that returns flash address of summary sector of a bank, data sectors follow it.
+ *
+ * @param kv store state
+ * @param bank bank, 0 or 1
+ * @return flash address
+ */
+static uint32_t SPI_kvBankAddress(SPI_kv_t *kv, uint8_t bank)
+{
+    return kv->areaAddress + (uint32_t)bank * (1 + KV_BANK_SECTORS) * FLASH_SECTOR_LENGTH;
+}
+
+/**
+ * Function that returns home slot of a key, multiplicative hash.
+ *
+ * @param key key
+ * @return slot
+ */
+static uint8_t SPI_kvHash(uint16_t key)
+{
+    return (uint16_t)(key * 40503U) >> (16 - KV_INDEX_BITS);     // 40503 = 2^16 / golden ratio
+}
+
+/**
+ * Function that finds the slot of a key with linear probing.
+ *
+ * @param kv store state
+ * @param key key
+ * @return slot that holds the key, else the free slot where key would be put; KV_INDEX_LENGTH if index is full
+ */
+static uint16_t SPI_kvFind(SPI_kv_t *kv, uint16_t key)
+{
+    uint8_t slot = SPI_kvHash(key);
+
+    for(uint16_t i = 0; i < KV_INDEX_LENGTH; i++)
+    {
+        if(kv->index[slot].key == key || kv->index[slot].key == KV_NO_KEY)
+            return slot;
+
+        slot = (slot + 1) & (KV_INDEX_LENGTH - 1);
+    }
+
+    return KV_INDEX_LENGTH;
+}
+
+/**
+ * Function that frees a slot; following slots of the probe sequence are moved back, so no key is cut off
+ * from its home slot by the free slot.
+ *
+ * @param kv store state
+ * @param slot slot that is freed
+ */
+static void SPI_kvRemove(SPI_kv_t *kv, uint8_t slot)
+{
+    uint8_t next = slot;
+
+    kv->index[slot].key = KV_NO_KEY;
+    kv->keys--;
+
+    while(1)
+    {
+        next = (next + 1) & (KV_INDEX_LENGTH - 1);
+
+        if(kv->index[next].key == KV_NO_KEY)
+            return;
+
+        uint8_t home = SPI_kvHash(kv->index[next].key);
+
+        // key can move to the free slot if it doesn't get before its home slot
+        if(((next - home) & (KV_INDEX_LENGTH - 1)) >= ((next - slot) & (KV_INDEX_LENGTH - 1)))
+        {
+            kv->index[slot] = kv->index[next];
+            kv->index[next].key = KV_NO_KEY;
+            slot = next;
+        }
+    }
+}
+
+/**
+ * Function that returns check byte of a record or summary entry, inverted sum so erased bytes don't match.
+ *
+ * @param data array of bytes
+ * @param numBytes number of bytes
+ * @return check byte
+ */
+static uint8_t SPI_kvCheck(const uint8_t data[], uint8_t numBytes)
+{
+    uint8_t sum = 0;
+
+    for(uint8_t i = 0; i < numBytes; i++)
+        sum += data[i];
+
+    return ~sum;
+}
+
+/**
+ * Function that programs bytes that can cross page boundaries, one page program per page.
+ *
+ * @param kv store state
+ * @param address flash address of the first byte
+ * @param data array of bytes
+ * @param numBytes number of bytes
+ */
+static void SPI_kvProgram(SPI_kv_t *kv, uint32_t address, const uint8_t data[], uint16_t numBytes)
+{
+    while(numBytes > 0)
+    {
+        uint16_t length = FLASH_PAGE_LENGTH - (address & (FLASH_PAGE_LENGTH - 1));
+
+        if(length > numBytes)
+            length = numBytes;
+
+        SPI_flashProgram(kv->flash, address, data, length);
+
+        address += length;
+        data += length;
+        numBytes -= length;
+    }
+}
+
+/**
+ * Function that appends a summary entry to a bank.
+ *
+ * @param kv store state
+ * @param bank bank, 0 or 1
+ * @param position offset of the entry in summary sector
+ * @param slot index slot, length 0 marks a deleted key
+ */
+static void SPI_kvPutEntry(SPI_kv_t *kv, uint8_t bank, uint16_t position, SPI_kvSlot_t *slot)
+{
+    uint8_t entry[KV_ENTRY_LENGTH] = {slot->key, slot->key >> 8, slot->offset, slot->offset >> 8, slot->length};
+
+    entry[5] = SPI_kvCheck(entry, KV_ENTRY_LENGTH - 1);
+    SPI_kvProgram(kv, SPI_kvBankAddress(kv, bank) + position, entry, KV_ENTRY_LENGTH);
+}
+
+/**
+ * Function that reads the record of a slot with a single read transaction and checks it.
+ *
+ * @param kv store state
+ * @param slot index slot
+ * @param record array of KV_RECORD_HEADER_LENGTH + KV_MAX_VALUE_LENGTH bytes where record is stored
+ * @return true if record matches the slot and its check byte; else, return false
+ */
+static bool SPI_kvReadRecord(SPI_kv_t *kv, SPI_kvSlot_t *slot, uint8_t record[])
+{
+    uint32_t address = SPI_kvBankAddress(kv, kv->bank) + FLASH_SECTOR_LENGTH + slot->offset;
+    uint8_t check;
+
+    SPI_flashRead(kv->flash, address, record, KV_RECORD_HEADER_LENGTH + slot->length);
+
+    check = record[3];
+    record[3] = 0;
+
+    if((record[0] | (record[1] << 8)) != slot->key || record[2] != slot->length)
+        return false;
+
+    return SPI_kvCheck(record, KV_RECORD_HEADER_LENGTH + slot->length) == check;
+}
+
+/**
+ * Function that erases a bank and writes its header, which makes it valid.
+ *
+ * @param kv store state
+ * @param bank bank, 0 or 1
+ * @param generation bank generation
+ */
+static void SPI_kvFormat(SPI_kv_t *kv, uint8_t bank, uint16_t generation)
+{
+    uint8_t header[4] = {KV_MAGIC & 0xFF, KV_MAGIC >> 8, generation, generation >> 8};
+
+    for(uint8_t s = 0; s < 1 + KV_BANK_SECTORS; s++)
+        SPI_flashEraseSector(kv->flash, SPI_kvBankAddress(kv, bank) + (uint32_t)s * FLASH_SECTOR_LENGTH);
+
+    SPI_flashProgram(kv->flash, SPI_kvBankAddress(kv, bank), header, 4);
+}
+
+/**
+ * Function that opens the store: finds the active bank and rebuilds the index from its summary sector in a
+ * single read transaction. Empty or foreign store area is formatted.
+ *! Blocks while the area is erased (about 45ms per sector), if it is formatted.
+ *
+ * @param kv store state
+ * @param flash flash driver state
+ * @param areaAddress address of the store area, sector aligned; area takes 2 * (1 + KV_BANK_SECTORS) sectors
+ * @return true if every stored key fits in the index; else, return false
+ */
+bool SPI_kvInit(SPI_kv_t *kv, SPI_flash_t *flash, uint32_t areaAddress)
+{
+    bool valid[2];
+    uint16_t generation[2];
+    bool fits = true;
+
+    kv->flash = flash;
+    kv->areaAddress = areaAddress;
+    kv->dataEnd = 0;
+    kv->summaryEnd = KV_HEADER_LENGTH;
+    kv->keys = 0;
+    kv->compactions = 0;
+
+    for(uint16_t i = 0; i < KV_INDEX_LENGTH; i++)
+        kv->index[i].key = KV_NO_KEY;
+
+    for(uint8_t b = 0; b < 2; b++)
+    {
+        uint8_t header[4];
+
+        SPI_flashRead(flash, SPI_kvBankAddress(kv, b), header, 4);
+        valid[b] = (header[0] | (header[1] << 8)) == KV_MAGIC;
+        generation[b] = header[2] | (header[3] << 8);
+    }
+
+    if(!valid[0] && !valid[1])
+    {
+        kv->bank = 0;
+        kv->generation = 0;
+        SPI_kvFormat(kv, 0, 0);
+
+        return true;
+    }
+
+    // compaction erases the old bank after the new one is valid, both are valid only if it was cut off by reset
+    kv->bank = (!valid[0] || (valid[1] && (int16_t)(generation[1] - generation[0]) > 0)) ? 1 : 0;
+    kv->generation = generation[kv->bank];
+
+    SPI_flashReadStart(flash, SPI_kvBankAddress(kv, kv->bank) + KV_HEADER_LENGTH);
+
+    while(kv->summaryEnd + KV_ENTRY_LENGTH <= FLASH_SECTOR_LENGTH)
+    {
+        uint8_t entry[KV_ENTRY_LENGTH];
+        uint8_t erased = 0xFF;
+
+        for(uint8_t i = 0; i < KV_ENTRY_LENGTH; i++)
+        {
+            entry[i] = SPI_masterReadUint8_t();
+            erased &= entry[i];
+        }
+
+        if(erased == 0xFF)
+            break;     // end of summary
+
+        if(SPI_kvCheck(entry, KV_ENTRY_LENGTH - 1) != entry[5])
+        {
+            // entry cut off by reset; entries can't be appended after it, next put compacts
+            kv->dataEnd = KV_DATA_LENGTH;
+            break;
+        }
+
+        SPI_kvSlot_t slot = {entry[0] | (entry[1] << 8), entry[2] | (entry[3] << 8), entry[4]};
+        uint16_t s = SPI_kvFind(kv, slot.key);
+
+        kv->summaryEnd += KV_ENTRY_LENGTH;
+
+        if(slot.length > 0)
+            kv->dataEnd = slot.offset + KV_RECORD_HEADER_LENGTH + slot.length;
+
+        if(s == KV_INDEX_LENGTH)
+            fits = false;
+
+        else if(slot.length == 0)
+        {
+            if(kv->index[s].key == slot.key)
+                SPI_kvRemove(kv, s);
+        }
+
+        else
+        {
+            if(kv->index[s].key == KV_NO_KEY)
+                kv->keys++;
+
+            kv->index[s] = slot;
+        }
+    }
+
+    SPI_flashReadStop(flash);
+
+    // record after the last committed one has to be erased, else its summary entry was cut off by reset
+    if(kv->dataEnd + KV_RECORD_HEADER_LENGTH <= KV_DATA_LENGTH)
+    {
+        uint8_t header[KV_RECORD_HEADER_LENGTH];
+
+        SPI_flashRead(flash, SPI_kvBankAddress(kv, kv->bank) + FLASH_SECTOR_LENGTH + kv->dataEnd, header,
+                      KV_RECORD_HEADER_LENGTH);
+
+        if((header[0] & header[1] & header[2] & header[3]) != 0xFF)
+            kv->dataEnd = KV_DATA_LENGTH;
+    }
+
+    return fits;
+}
+
+/**
+ * Function that reads the value of a key with a single read transaction.
+ *
+ * @param kv store state
+ * @param key key, 0 - 0xFFFE
+ * @param value array where value is stored
+ * @param maxLength size of value array, longer value is cut
+ * @return value length; 0 if key isn't stored or the record is damaged
+ */
+uint8_t SPI_kvGet(SPI_kv_t *kv, uint16_t key, uint8_t value[], uint8_t maxLength)
+{
+    uint8_t record[KV_RECORD_HEADER_LENGTH + KV_MAX_VALUE_LENGTH];
+    uint16_t s = SPI_kvFind(kv, key);
+
+    if(key == KV_NO_KEY || s == KV_INDEX_LENGTH || kv->index[s].key != key)
+        return 0;
+
+    if(!SPI_kvReadRecord(kv, &kv->index[s], record))
+        return 0;
+
+    memcpy(value, &record[KV_RECORD_HEADER_LENGTH], kv->index[s].length < maxLength ? kv->index[s].length : maxLength);
+
+    return kv->index[s].length;
+}
+
+/**
+ * Function that stores the value of a key. New record is appended and committed by its summary entry,
+ * so the old value stays valid until the new one is completely written. Unchanged value isn't written again.
+ *! Compacts the store if the active bank is full, which erases 1 + KV_BANK_SECTORS sectors and blocks.
+ *
+ * @param kv store state
+ * @param key key, 0 - 0xFFFE
+ * @param value array of value bytes
+ * @param length value length, 1 - KV_MAX_VALUE_LENGTH
+ * @return true if value is stored; else, return false (index or bank full, or invalid arguments)
+ */
+bool SPI_kvPut(SPI_kv_t *kv, uint16_t key, const uint8_t value[], uint8_t length)
+{
+    uint8_t record[KV_RECORD_HEADER_LENGTH + KV_MAX_VALUE_LENGTH];
+    uint16_t s = SPI_kvFind(kv, key);
+
+    if(key == KV_NO_KEY || length == 0 || length > KV_MAX_VALUE_LENGTH || s == KV_INDEX_LENGTH)
+        return false;
+
+    SPI_kvSlot_t *slot = &kv->index[s];
+
+    if(slot->key == key && slot->length == length && SPI_kvReadRecord(kv, slot, record) &&
+       memcmp(&record[KV_RECORD_HEADER_LENGTH], value, length) == 0)
+        return true;
+
+    if(kv->dataEnd + KV_RECORD_HEADER_LENGTH + length > KV_DATA_LENGTH ||
+       kv->summaryEnd + KV_ENTRY_LENGTH > FLASH_SECTOR_LENGTH)
+    {
+        SPI_kvCompact(kv);
+
+        if(kv->dataEnd + KV_RECORD_HEADER_LENGTH + length > KV_DATA_LENGTH)
+            return false;
+    }
+
+    record[0] = key;
+    record[1] = key >> 8;
+    record[2] = length;
+    record[3] = 0;
+    memcpy(&record[KV_RECORD_HEADER_LENGTH], value, length);
+    record[3] = SPI_kvCheck(record, KV_RECORD_HEADER_LENGTH + length);
+
+    // record first, its summary entry commits it
+    SPI_kvProgram(kv, SPI_kvBankAddress(kv, kv->bank) + FLASH_SECTOR_LENGTH + kv->dataEnd, record,
+                  KV_RECORD_HEADER_LENGTH + length);
+
+    if(slot->key == KV_NO_KEY)
+        kv->keys++;
+
+    slot->key = key;
+    slot->offset = kv->dataEnd;
+    slot->length = length;
+    SPI_kvPutEntry(kv, kv->bank, kv->summaryEnd, slot);
+
+    kv->dataEnd += KV_RECORD_HEADER_LENGTH + length;
+    kv->summaryEnd += KV_ENTRY_LENGTH;
+
+    return true;
+}
+
+/**
+ * Function that removes a key.
+ *
+ * @param kv store state
+ * @param key key, 0 - 0xFFFE
+ * @return true if key was stored; else, return false
+ */
+bool SPI_kvDelete(SPI_kv_t *kv, uint16_t key)
+{
+    uint16_t s = SPI_kvFind(kv, key);
+
+    if(key == KV_NO_KEY || s == KV_INDEX_LENGTH || kv->index[s].key != key)
+        return false;
+
+    SPI_kvSlot_t deleted = {key, kv->dataEnd, 0};
+
+    SPI_kvRemove(kv, s);
+
+    // compaction leaves the key out, else an entry with length 0 marks it deleted
+    if(kv->summaryEnd + KV_ENTRY_LENGTH > FLASH_SECTOR_LENGTH)
+        SPI_kvCompact(kv);
+
+    else
+    {
+        SPI_kvPutEntry(kv, kv->bank, kv->summaryEnd, &deleted);
+        kv->summaryEnd += KV_ENTRY_LENGTH;
+    }
+
+    return true;
+}
+
+/**
+ * Function that copies live records to the other bank and makes it active. Old values, deleted keys and
+ * the summary entries of both are dropped.
+ ** SPI_kvPut() compacts when needed; call this function when the application is idle to avoid that.
+ *
+ * @param kv store state
+ */
+void SPI_kvCompact(SPI_kv_t *kv)
+{
+    uint8_t record[KV_RECORD_HEADER_LENGTH + KV_MAX_VALUE_LENGTH];
+    uint8_t target = !kv->bank;
+    uint8_t header[4] = {KV_MAGIC & 0xFF, KV_MAGIC >> 8, kv->generation + 1, (kv->generation + 1) >> 8};
+    uint16_t dataEnd = 0;
+    uint16_t summaryEnd = KV_HEADER_LENGTH;
+
+    for(uint8_t s = 0; s < 1 + KV_BANK_SECTORS; s++)
+        SPI_flashEraseSector(kv->flash, SPI_kvBankAddress(kv, target) + (uint32_t)s * FLASH_SECTOR_LENGTH);
+
+    for(uint16_t i = 0; i < KV_INDEX_LENGTH; i++)
+    {
+        SPI_kvSlot_t *slot = &kv->index[i];
+
+        if(slot->key == KV_NO_KEY)
+            continue;
+
+        uint8_t numBytes = KV_RECORD_HEADER_LENGTH + slot->length;
+
+        // damaged record is copied as it is, get keeps reporting it
+        SPI_flashRead(kv->flash, SPI_kvBankAddress(kv, kv->bank) + FLASH_SECTOR_LENGTH + slot->offset, record, numBytes);
+        SPI_kvProgram(kv, SPI_kvBankAddress(kv, target) + FLASH_SECTOR_LENGTH + dataEnd, record, numBytes);
+
+        slot->offset = dataEnd;
+        SPI_kvPutEntry(kv, target, summaryEnd, slot);
+
+        dataEnd += numBytes;
+        summaryEnd += KV_ENTRY_LENGTH;
+    }
+
+    // header makes the new bank valid, then the old one is invalidated
+    SPI_flashProgram(kv->flash, SPI_kvBankAddress(kv, target), header, 4);
+    SPI_flashEraseSector(kv->flash, SPI_kvBankAddress(kv, kv->bank));
+
+    kv->bank = target;
+    kv->generation++;
+    kv->dataEnd = dataEnd;
+    kv->summaryEnd = summaryEnd;
+    kv->compactions++;
+}
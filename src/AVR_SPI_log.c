@@ -0,0 +1,503 @@
+/**
+ * @file AVR_SPI_log.c
+ * @author Lukas Ternjej
+ *
+ * Log-structured data logger .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include <string.h>
+
+#include "AVR_SPI_log.h"
+
+/**
+ * Function that returns flash address of a log sector.
+ *
+ * @param log logger state
+ * @param sector sector in log area
+ * @return flash address
+ */
+static uint32_t SPI_logSectorAddress(SPI_log_t *log, uint8_t sector)
+{
+    return log->areaAddress + (uint32_t)sector * FLASH_SECTOR_LENGTH;
+}
+
+/**
+ * Function that returns flash address of a record.
+ *
+ * @param log logger state
+ * @param sector sector in log area
+ * @param record record in sector
+ * @return flash address
+ */
+static uint32_t SPI_logRecordAddress(SPI_log_t *log, uint8_t sector, uint16_t record)
+{
+    return SPI_logSectorAddress(log, sector) + LOG_HEADER_LENGTH + (uint32_t)record * log->recordLength;
+}
+
+/**
+ * Function that reads log bytes from flash; bytes that are still in page buffers are taken from RAM.
+ *
+ * @param log logger state
+ * @param address flash address of the first byte
+ * @param buffer array where bytes are stored
+ * @param numBytes number of bytes
+ */
+static void SPI_logReadBytes(SPI_log_t *log, uint32_t address, uint8_t buffer[], uint16_t numBytes)
+{
+    SPI_flashRead(log->flash, address, buffer, numBytes);
+
+    for(uint8_t b = 0; b < 2; b++)
+    {
+        uint16_t length = (b == log->active) ? log->fill : (log->pending[b] ? FLASH_PAGE_LENGTH : 0);
+
+        for(uint16_t i = 0; i < numBytes; i++)
+        {
+            uint32_t offset = address + i - log->bufferAddress[b];     // wraps to a large value below buffer page
+
+            if(offset < length)
+                buffer[i] = log->buffer[b][offset];
+        }
+    }
+}
+
+/**
+ * Function that reads the timestamp of a record.
+ *
+ * @param log logger state
+ * @param sector sector in log area
+ * @param record record in sector
+ * @return record time, LOG_EMPTY if record isn't written
+ */
+static uint32_t SPI_logReadTime(SPI_log_t *log, uint8_t sector, uint16_t record)
+{
+    uint8_t bytes[4];
+
+    SPI_logReadBytes(log, SPI_logRecordAddress(log, sector, record), bytes, 4);
+
+    return bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+/**
+ * Function that programs the full page buffer, if there is one. Waits until flash is idle.
+ *
+ * @param log logger state
+ */
+static void SPI_logWritePending(SPI_log_t *log)
+{
+    uint8_t b = !log->active;     // full buffer is always the one that isn't being filled
+
+    if(!log->pending[b])
+        return;
+
+    SPI_flashProgram(log->flash, log->bufferAddress[b], log->buffer[b], FLASH_PAGE_LENGTH);
+
+    if(!log->suspended)
+        log->erasing = false;     // program only starts on idle flash, so erase ahead is finished
+
+    log->pending[b] = false;
+    log->pagePrograms++;
+}
+
+/**
+ * Function that suspends erase ahead of the write position, if it is still in progress.
+ *
+ * @param log logger state
+ * @return true if erase is suspended; else, return false
+ */
+static bool SPI_logSuspend(SPI_log_t *log)
+{
+#if LOG_ERASE_SUSPEND
+    if(!log->erasing || log->suspended || !SPI_flashBusy(log->flash))
+        return false;
+
+    SPI_flashSuspend(log->flash);
+
+    log->suspended = true;
+    log->suspends++;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Function that queues the active page buffer for programming and continues in the other buffer.
+ * Full buffer is programmed right away if flash is idle.
+ *
+ * @param log logger state
+ * @param nextAddress flash address of the page that follows
+ */
+static void SPI_logSwap(SPI_log_t *log, uint32_t nextAddress)
+{
+    if(log->pending[!log->active])
+    {
+        // flash hasn't taken the previous page yet; page program is short, erase ahead is suspended for it
+        if(!SPI_logSuspend(log))
+            log->stalls++;
+
+        SPI_logWritePending(log);
+    }
+
+    log->pending[log->active] = true;
+    log->active = !log->active;
+    log->bufferAddress[log->active] = nextAddress;
+    log->fill = 0;
+    memset(log->buffer[log->active], 0xFF, FLASH_PAGE_LENGTH);     // unused end of a sector stays erased
+
+    if(!SPI_flashBusy(log->flash))
+        SPI_logWritePending(log);
+}
+
+/**
+ * Function that puts a byte in the active page buffer.
+ *
+ * @param log logger state
+ * @param data byte
+ */
+static void SPI_logPut(SPI_log_t *log, uint8_t data)
+{
+    log->buffer[log->active][log->fill++] = data;
+
+    if(log->fill == FLASH_PAGE_LENGTH)
+        SPI_logSwap(log, log->bufferAddress[log->active] + FLASH_PAGE_LENGTH);
+}
+
+/**
+ * Function that puts an uint32_t in the active page buffer, little endian.
+ *
+ * @param log logger state
+ * @param data value
+ */
+static void SPI_logPutUint32(SPI_log_t *log, uint32_t data)
+{
+    for(uint8_t i = 0; i < 4; i++)
+        SPI_logPut(log, data >> (8 * i));
+}
+
+/**
+ * Function that moves write position to the start of the next sector in the ring.
+ * If the next sector hasn't been erased ahead, it is erased now and the append waits for it.
+ *
+ * @param log logger state
+ */
+static void SPI_logNextSector(SPI_log_t *log)
+{
+    uint8_t next = (log->sector + 1) % log->sectorCount;
+
+    if(log->fill > 0)
+        SPI_logSwap(log, SPI_logSectorAddress(log, next));
+
+    else
+        log->bufferAddress[log->active] = SPI_logSectorAddress(log, next);
+
+    if(log->erasedAhead == 1 && log->erasing)
+    {
+        // erase of the new current sector can't be suspended anymore, programs wait for it
+        if(log->suspended)
+        {
+            SPI_flashWait(log->flash);
+            SPI_flashResume(log->flash);
+        }
+
+        log->suspended = false;
+        log->erasing = false;
+    }
+
+    if(log->erasedAhead == 0)
+    {
+        log->stalls++;
+        SPI_logWritePending(log);
+
+        log->sectorTime[next] = LOG_EMPTY;
+        SPI_flashEraseSector(log->flash, SPI_logSectorAddress(log, next));
+        log->erases++;
+    }
+
+    else
+        log->erasedAhead--;
+
+    log->sector = next;
+    log->sequence++;
+    log->records = 0;
+}
+
+/**
+ * Function that opens the log area: reads every sector header, rebuilds the time index and finds the write
+ * position after the newest record. Empty or foreign log area is started from its first sector.
+ *! Blocks while the first sector is erased, if log area is empty.
+ *
+ * @param log logger state
+ * @param flash flash driver state
+ * @param areaAddress address of the first log sector, sector aligned
+ * @param sectorCount sectors in log area, 2 - LOG_MAX_SECTORS
+ * @param dataLength data bytes in every record, 1 - FLASH_PAGE_LENGTH - 4
+ */
+void SPI_logInit(SPI_log_t *log, SPI_flash_t *flash, uint32_t areaAddress, uint8_t sectorCount, uint8_t dataLength)
+{
+    bool found = false;
+
+    log->flash = flash;
+    log->areaAddress = areaAddress;
+    log->sectorCount = sectorCount > LOG_MAX_SECTORS ? LOG_MAX_SECTORS : sectorCount;
+    log->recordLength = 4 + dataLength;
+    log->sectorRecords = (FLASH_SECTOR_LENGTH - LOG_HEADER_LENGTH) / log->recordLength;
+    log->erasedAhead = 0;
+    log->erasing = false;
+    log->suspended = false;
+    log->pending[0] = false;
+    log->pending[1] = false;
+    log->active = 0;
+    log->pagePrograms = 0;
+    log->erases = 0;
+    log->stalls = 0;
+    log->suspends = 0;
+
+    // sector headers are the index on flash, the newest sector has the highest sequence
+    for(uint8_t s = 0; s < log->sectorCount; s++)
+    {
+        uint8_t header[LOG_HEADER_LENGTH];
+        SPI_flashRead(flash, SPI_logSectorAddress(log, s), header, LOG_HEADER_LENGTH);
+
+        uint16_t magic = header[0] | (header[1] << 8);
+        uint32_t sequence = header[4] | ((uint32_t)header[5] << 8) | ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 24);
+
+        log->sectorTime[s] = LOG_EMPTY;
+
+        if(magic != LOG_MAGIC || header[2] != log->recordLength)
+            continue;
+
+        log->sectorTime[s] = header[8] | ((uint32_t)header[9] << 8) | ((uint32_t)header[10] << 16) | ((uint32_t)header[11] << 24);
+
+        if(!found || sequence > log->sequence)
+        {
+            log->sequence = sequence;
+            log->sector = s;
+            found = true;
+        }
+    }
+
+    log->fill = 0;
+    log->bufferAddress[0] = SPI_logSectorAddress(log, 0);
+    memset(log->buffer[0], 0xFF, FLASH_PAGE_LENGTH);
+
+    if(!found)
+    {
+        log->sector = 0;
+        log->sequence = 0;
+        log->records = 0;
+
+        SPI_flashEraseSector(flash, log->areaAddress);
+        SPI_flashWait(flash);
+        log->erases++;
+
+        return;
+    }
+
+    // records are written in order, so the first unwritten record is found with a binary search
+    uint16_t low = 0;
+    uint16_t high = log->sectorRecords;
+
+    while(low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+
+        if(SPI_logReadTime(log, log->sector, middle) == LOG_EMPTY)
+            high = middle;
+
+        else
+            low = middle + 1;
+    }
+
+    log->records = low;
+
+    // continue in the page that holds the write position, its programmed part is programmed again unchanged
+    uint32_t position = SPI_logRecordAddress(log, log->sector, log->records);
+
+    log->bufferAddress[0] = position & ~(uint32_t)(FLASH_PAGE_LENGTH - 1);
+    log->fill = position - log->bufferAddress[0];
+    SPI_flashRead(flash, log->bufferAddress[0], log->buffer[0], log->fill);
+}
+
+/**
+ * Function that appends a record. Record is stored in RAM and programmed when its page is full.
+ * Waits only if the other page buffer is still being programmed or the next sector isn't erased yet.
+ * Erase ahead of the write position is suspended for the page program instead of waited for.
+ *
+ * @param log logger state
+ * @param timestamp record time, non-decreasing, LOG_EMPTY isn't allowed
+ * @param data array of dataLength bytes
+ */
+void SPI_logAppend(SPI_log_t *log, uint32_t timestamp, const uint8_t data[])
+{
+    if(log->records == log->sectorRecords)
+        SPI_logNextSector(log);
+
+    if(log->records == 0)
+    {
+        SPI_logPut(log, LOG_MAGIC & 0xFF);
+        SPI_logPut(log, LOG_MAGIC >> 8);
+        SPI_logPut(log, log->recordLength);
+        SPI_logPut(log, 0xFF);     // reserved
+        SPI_logPutUint32(log, log->sequence);
+        SPI_logPutUint32(log, timestamp);
+
+        log->sectorTime[log->sector] = timestamp;
+    }
+
+    SPI_logPutUint32(log, timestamp);
+
+    for(uint8_t i = 4; i < log->recordLength; i++)
+        SPI_logPut(log, *data++);
+
+    log->records++;
+}
+
+/**
+ * Function that programs a full page buffer if flash is idle, or else resumes suspended erase or erases
+ * the next sector ahead of the write position. Never waits for flash.
+ ** Call this function from the main loop, erase (about 45ms) is only started here.
+ *
+ * @param log logger state
+ */
+void SPI_logService(SPI_log_t *log)
+{
+    if(SPI_flashBusy(log->flash))
+        return;
+
+    if(log->pending[!log->active])
+    {
+        SPI_logWritePending(log);
+        return;
+    }
+
+    if(log->suspended)
+    {
+        SPI_flashResume(log->flash);
+        log->suspended = false;
+        return;
+    }
+
+    log->erasing = false;
+
+    // current sector is never erased, and the oldest records are dropped only LOG_ERASE_AHEAD sectors early
+    if(log->erasedAhead < LOG_ERASE_AHEAD && log->erasedAhead < log->sectorCount - 1)
+    {
+        uint8_t s = (log->sector + 1 + log->erasedAhead) % log->sectorCount;
+
+        log->sectorTime[s] = LOG_EMPTY;
+        SPI_flashEraseSector(log->flash, SPI_logSectorAddress(log, s));
+
+        log->erasing = true;
+        log->erasedAhead++;
+        log->erases++;
+    }
+}
+
+/**
+ * Function that programs all buffered records, including a partially filled page, and waits until they are stored.
+ ** Call this function before power down, buffered records are lost otherwise.
+ *
+ * @param log logger state
+ */
+void SPI_logFlush(SPI_log_t *log)
+{
+    SPI_logWritePending(log);
+
+    if(log->fill > 0)
+    {
+        // erased end of the page can be programmed later, programmed part is programmed again unchanged
+        SPI_flashProgram(log->flash, log->bufferAddress[log->active], log->buffer[log->active], log->fill);
+        log->pagePrograms++;
+    }
+
+    if(log->suspended)
+    {
+        SPI_flashWait(log->flash);
+        SPI_flashResume(log->flash);
+        log->suspended = false;
+    }
+
+    SPI_flashWait(log->flash);
+}
+
+/**
+ * Function that finds the first record with timestamp equal or later than the given time.
+ * Sector is found in RAM index, record within the sector with a binary search of record timestamps on flash.
+ *
+ * @param log logger state
+ * @param timestamp searched time
+ * @param cursor where read position is stored
+ */
+void SPI_logSeek(SPI_log_t *log, uint32_t timestamp, SPI_logCursor_t *cursor)
+{
+    bool found = false;
+
+    cursor->sector = log->sector;
+    cursor->record = 0;
+
+    // sectors in time order start after current sector; take the last one that starts at or before timestamp
+    for(uint8_t k = 1; k <= log->sectorCount; k++)
+    {
+        uint8_t s = (log->sector + k) % log->sectorCount;
+
+        if(log->sectorTime[s] == LOG_EMPTY)
+            continue;
+
+        if(!found || log->sectorTime[s] <= timestamp)
+            cursor->sector = s;     // oldest sector if timestamp is earlier than the whole log
+
+        found = true;
+    }
+
+    uint16_t low = 0;
+    uint16_t high = (cursor->sector == log->sector) ? log->records : log->sectorRecords;
+
+    while(low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+
+        if(SPI_logReadTime(log, cursor->sector, middle) < timestamp)
+            low = middle + 1;
+
+        else
+            high = middle;
+    }
+
+    cursor->record = low;
+}
+
+/**
+ * Function that reads the record at read position and advances it. Buffered records are read from RAM.
+ *
+ * @param log logger state
+ * @param cursor read position
+ * @param timestamp where record time is stored
+ * @param data array where dataLength bytes are stored
+ * @return true if a record is read; else, return false (end of log)
+ */
+bool SPI_logRead(SPI_log_t *log, SPI_logCursor_t *cursor, uint32_t *timestamp, uint8_t data[])
+{
+    if(cursor->sector != log->sector && cursor->record >= log->sectorRecords)
+    {
+        cursor->sector = (cursor->sector + 1) % log->sectorCount;
+        cursor->record = 0;
+    }
+
+    if(log->sectorTime[cursor->sector] == LOG_EMPTY)
+        return false;     // sector was erased ahead after seek
+
+    if(cursor->sector == log->sector && cursor->record >= log->records)
+        return false;
+
+    uint32_t address = SPI_logRecordAddress(log, cursor->sector, cursor->record);
+
+    *timestamp = SPI_logReadTime(log, cursor->sector, cursor->record);
+    SPI_logReadBytes(log, address + 4, data, log->recordLength - 4);
+
+    cursor->record++;
+
+    return true;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file AVR_SPI_memory.c
+ * @author Lukas Ternjej
+ *
+ * 25xx memory personality .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_memory.h"
+
+#if SPI_USE_MEMORY
+    #include <avr/eeprom.h>
+    #include <avr/pgmspace.h>
+
+// command decoding states
+#define MEMORY_STATE_COMMAND      0
+#define MEMORY_STATE_ADDRESS_HIGH 1
+#define MEMORY_STATE_ADDRESS_LOW  2
+#define MEMORY_STATE_READ         3
+#define MEMORY_STATE_WRITE        4
+#define MEMORY_STATE_STATUS       5
+#define MEMORY_STATE_IGNORE       6     // rest of transaction is ignored
+
+volatile uint8_t SPI_memoryStatus = 0;
+
+static const uint8_t *memoryProgmem = NULL;
+static uint16_t memoryProgmemLength = 0;
+
+static volatile uint8_t memoryState = MEMORY_STATE_IGNORE;
+static volatile uint8_t memoryCommand = 0;
+static volatile uint16_t memoryAddress = 0;     // address of preloaded byte when reading, of next byte when writing
+static volatile uint8_t memoryNext = DUMMY_CHAR;     // byte that is written to SPDR as soon as a byte is received
+
+static uint8_t memoryPage[MEMORY_PAGE_LENGTH];     // bytes of write command, programmed by SPI_memoryService()
+static volatile uint16_t memoryPageAddress = 0;
+static volatile uint16_t memoryPageUsed = 0;        // bit n is set if memoryPage[n] was written
+
+/**
+ * Function that reads a byte of memory map: EEPROM from 0, PROGMEM block from MEMORY_PROGMEM_ADDRESS, else 0xFF.
+ * EEPROM is read through its registers, without a function call, to keep ISR routine short.
+ *
+ * @param address memory address
+ * @return memory byte
+ */
+static inline uint8_t SPI_memoryFetch(uint16_t address)
+{
+    if(address <= E2END)
+    {
+        EEAR = address;
+        EECR |= (1 << EERE);
+
+        return EEDR;
+    }
+
+    if((uint16_t)(address - MEMORY_PROGMEM_ADDRESS) < memoryProgmemLength)
+        return pgm_read_byte(&memoryProgmem[address - MEMORY_PROGMEM_ADDRESS]);
+
+    return 0xFF;
+}
+
+/**
+ * Function that decodes a received byte. Called from ISR routines after the preloaded byte was written to SPDR.
+ *
+ * @param data byte received from master
+ */
+static inline void SPI_memoryReceive(uint8_t data)
+{
+    switch(memoryState)
+    {
+    case MEMORY_STATE_COMMAND:
+        memoryState = MEMORY_STATE_IGNORE;
+
+        // memory that is writing only answers RDSR
+        if(data == MEMORY_CMD_RDSR)
+        {
+            SPDR = SPI_memoryStatus;     // over the preloaded dummy byte, as the first byte of READ
+            memoryNext = SPI_memoryStatus;
+            memoryState = MEMORY_STATE_STATUS;
+        }
+
+        else if(SPI_memoryStatus & MEMORY_STATUS_WIP)
+            break;
+
+        else if(data == MEMORY_CMD_READ || (data == MEMORY_CMD_WRITE && (SPI_memoryStatus & MEMORY_STATUS_WEL)))
+        {
+            memoryCommand = data;
+            memoryState = MEMORY_STATE_ADDRESS_HIGH;
+        }
+
+        else if(data == MEMORY_CMD_WREN)
+            SPI_memoryStatus |= MEMORY_STATUS_WEL;
+
+        else if(data == MEMORY_CMD_WRDI)
+            SPI_memoryStatus &= ~MEMORY_STATUS_WEL;
+
+        break;
+
+    case MEMORY_STATE_ADDRESS_HIGH:
+        memoryAddress = data << 8;
+        memoryState = MEMORY_STATE_ADDRESS_LOW;
+        break;
+
+    case MEMORY_STATE_ADDRESS_LOW:
+        memoryAddress |= data;
+
+        if(memoryCommand == MEMORY_CMD_READ)
+        {
+            // first data byte can't be fetched ahead, it is written to SPDR over the preloaded dummy byte
+            SPDR = SPI_memoryFetch(memoryAddress);
+            memoryAddress++;
+            memoryNext = SPI_memoryFetch(memoryAddress);
+            memoryState = MEMORY_STATE_READ;
+        }
+
+        else
+        {
+            memoryPageAddress = memoryAddress & ~(MEMORY_PAGE_LENGTH - 1);
+            memoryPageUsed = 0;
+            memoryState = MEMORY_STATE_WRITE;
+        }
+
+        break;
+
+    case MEMORY_STATE_READ:
+        memoryAddress++;
+        memoryNext = SPI_memoryFetch(memoryAddress);
+        break;
+
+    case MEMORY_STATE_WRITE:
+    {
+        uint8_t offset = memoryAddress & (MEMORY_PAGE_LENGTH - 1);
+
+        memoryPage[offset] = data;
+        memoryPageUsed |= ((uint16_t)1 << offset);
+        memoryAddress = memoryPageAddress | ((offset + 1) & (MEMORY_PAGE_LENGTH - 1));     // address wraps within page
+        break;
+    }
+
+    case MEMORY_STATE_STATUS:
+        memoryNext = SPI_memoryStatus;     // status is repeated until SS is released
+        break;
+    }
+}
+
+/**
+ * Function that sets memory map and enables SS pin change interrupt.
+ * SPI module has to be initialized with SPI_init() in SLAVE_MODE.
+ *
+ * @param progmemData array in PROGMEM that is read from MEMORY_PROGMEM_ADDRESS on, NULL if there isn't one
+ * @param progmemLength number of array elements
+ */
+void SPI_memoryInit(const uint8_t *progmemData, uint16_t progmemLength)
+{
+    memoryProgmem = progmemData;
+    memoryProgmemLength = progmemData != NULL ? progmemLength : 0;
+
+    SPI_memoryStatus = 0;
+    memoryState = MEMORY_STATE_IGNORE;
+    memoryNext = DUMMY_CHAR;
+    SPDR = DUMMY_CHAR;
+
+    // interrupt on both edges of SS
+    SS_PCMSKx |= (1 << SS_PCINTn);
+    PCICR |= (1 << SS_PCIEx);
+}
+
+/**
+ * Function that programs written bytes into EEPROM, one byte per call, and clears write in progress bit
+ * when the whole page is programmed. Returns right away while EEPROM is busy.
+ ** Call this function from the main loop, master polls RDSR until write is finished.
+ */
+void SPI_memoryService(void)
+{
+    if(!(SPI_memoryStatus & MEMORY_STATUS_WIP) || !eeprom_is_ready())
+        return;
+
+    // ISR routine doesn't touch EEPROM registers or the page while write is in progress
+    for(uint8_t i = 0; i < MEMORY_PAGE_LENGTH; i++)
+    {
+        if(!(memoryPageUsed & ((uint16_t)1 << i)))
+            continue;
+
+        uint16_t address = memoryPageAddress | i;
+        memoryPageUsed &= ~((uint16_t)1 << i);
+
+        if(address <= E2END)
+        {
+            eeprom_update_byte((uint8_t *)(uintptr_t)address, memoryPage[i]);     // unchanged byte isn't programmed
+            return;
+        }
+    }
+
+    SPI_memoryStatus &= ~MEMORY_STATUS_WIP;     // PROGMEM and unmapped addresses are read-only, their bytes are dropped
+}
+
+// SPI transfer complete, SPDR is written first so the next byte is ready before master clocks it
+ISR(SPI_STC_vect)
+{
+    uint8_t data = SPDR;
+
+    SPDR = memoryNext;
+    memoryNext = DUMMY_CHAR;
+
+    SPI_memoryReceive(data);
+}
+
+/**
+ * Interrupt service routine for SS pin changes. Falling edge starts a command,
+ * rising edge ends it and starts write cycle of a write command.
+ */
+ISR(SS_PCINT_vect)
+{
+    if(!(SPI_PINx & (1 << SS_PIN_PORTxn)))
+    {
+        memoryState = MEMORY_STATE_COMMAND;
+        return;
+    }
+
+    // this interrupt has priority over SPI_STC_vect, decode the last byte if it is still pending
+    if(SPSR & (1 << SPIF))
+    {
+        uint8_t data = SPDR;
+        SPI_memoryReceive(data);
+    }
+
+    if(memoryState == MEMORY_STATE_WRITE && memoryPageUsed != 0)
+    {
+        SPI_memoryStatus |= MEMORY_STATUS_WIP;
+        SPI_memoryStatus &= ~MEMORY_STATUS_WEL;     // write clears write enable latch, as on 25xx
+    }
+
+    memoryState = MEMORY_STATE_IGNORE;
+    memoryNext = DUMMY_CHAR;
+    SPDR = DUMMY_CHAR;
+}
+#endif
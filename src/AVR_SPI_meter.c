@@ -0,0 +1,171 @@
+/**
+ * @file AVR_SPI_meter.c
+ * @author Lukas Ternjej
+ *
+ * Bus utilisation and per-device accounting .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_meter.h"
+
+SPI_meterDevice_t SPI_meterDevices[METER_DEVICES];
+uint8_t SPI_meterDeviceCount = 0;
+SPI_meterDevice_t *SPI_meterCurrent = NULL;
+
+uint32_t SPI_meterBusyTicks = 0;
+uint32_t SPI_meterIdleTicks = 0;
+
+static bool busy = false;        // true while any SS line is asserted
+static uint16_t lastTick = 0;    // Timer1 value at the last accounting
+
+// sliding window, every slot holds METER_WINDOW_TICKS of accounted time
+static uint32_t windowTotal[METER_WINDOWS];
+static uint32_t windowBusy[METER_WINDOWS];
+static uint8_t window = 0;
+
+/**
+ * Function that adds time elapsed since the last accounting to busy or idle time.
+ */
+static void SPI_meterAccumulate(void)
+{
+    uint16_t now = TCNT1;
+    uint16_t elapsed = now - lastTick;     // unsigned subtraction handles a single timer overflow
+    lastTick = now;
+
+    windowTotal[window] += elapsed;
+
+    if(busy)
+    {
+        windowBusy[window] += elapsed;
+        SPI_meterBusyTicks += elapsed;
+
+        if(SPI_meterCurrent != NULL)
+            SPI_meterCurrent->busyTicks += elapsed;
+    }
+
+    else
+        SPI_meterIdleTicks += elapsed;
+
+    if(windowTotal[window] >= METER_WINDOW_TICKS)
+    {
+        // slot is full, oldest slot is reused
+        window = (window + 1) % METER_WINDOWS;
+        windowTotal[window] = 0;
+        windowBusy[window] = 0;
+    }
+}
+
+/**
+ * Function that starts Timer1 in normal mode and clears all accounting.
+ *! Timer1 can't be used by the application while meter is used.
+ *
+ * @param prescaler METER_DIV1, METER_DIV8, METER_DIV64, METER_DIV256 or METER_DIV1024
+ */
+void SPI_meterInit(uint8_t prescaler)
+{
+    TCCR1A = 0;                                               // normal mode, output compare pins disconnected
+    TCCR1B = prescaler & ((1 << CS12) | (1 << CS11) | (1 << CS10));
+
+    SPI_meterReset();
+}
+
+/**
+ * Function that clears all accounting and sliding window.
+ */
+void SPI_meterReset(void)
+{
+    for(uint8_t i = 0; i < METER_WINDOWS; i++)
+    {
+        windowTotal[i] = 0;
+        windowBusy[i] = 0;
+    }
+
+    window = 0;
+    SPI_meterDeviceCount = 0;
+    SPI_meterCurrent = NULL;
+    SPI_meterBusyTicks = 0;
+    SPI_meterIdleTicks = 0;
+    busy = false;
+    lastTick = TCNT1;
+}
+
+/**
+ * Function that is called by SPI_slaveSelect(); it starts accounting busy time of a device.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ */
+void SPI_meterSelect(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn)
+{
+    SPI_meterAccumulate();     // time until now was idle
+
+    SPI_meterCurrent = NULL;
+
+    for(uint8_t i = 0; i < SPI_meterDeviceCount; i++)
+    {
+        if(SPI_meterDevices[i].SS_PORTx == SS_PORTx && SPI_meterDevices[i].SS_PORTxn == SS_PORTxn)
+        {
+            SPI_meterCurrent = &SPI_meterDevices[i];
+            break;
+        }
+    }
+
+    if(SPI_meterCurrent == NULL && SPI_meterDeviceCount < METER_DEVICES)
+    {
+        // first transaction of this device
+        SPI_meterCurrent = &SPI_meterDevices[SPI_meterDeviceCount++];
+        SPI_meterCurrent->SS_PORTx = SS_PORTx;
+        SPI_meterCurrent->SS_PORTxn = SS_PORTxn;
+        SPI_meterCurrent->bytes = 0;
+        SPI_meterCurrent->transactions = 0;
+        SPI_meterCurrent->busyTicks = 0;
+    }
+
+    if(SPI_meterCurrent != NULL)
+        SPI_meterCurrent->transactions++;
+
+    busy = true;
+}
+
+/**
+ * Function that is called by SPI_slaveRelease(); it ends accounting busy time of the selected device.
+ */
+void SPI_meterRelease(void)
+{
+    SPI_meterAccumulate();     // time until now was busy
+
+    busy = false;
+    SPI_meterCurrent = NULL;
+}
+
+/**
+ * Function that accounts time elapsed since the last SS change.
+ ** Call this function from the main loop at least once per Timer1 overflow, so idle time isn't lost.
+ */
+void SPI_meterUpdate(void)
+{
+    SPI_meterAccumulate();
+}
+
+/**
+ * Function that returns bus utilisation over the sliding window.
+ *
+ * @return percentage of time that any SS line was asserted, 0 - 100
+ */
+uint8_t SPI_meterUtilisation(void)
+{
+    uint32_t total = 0;
+    uint32_t busyTotal = 0;
+
+    for(uint8_t i = 0; i < METER_WINDOWS; i++)
+    {
+        total += windowTotal[i];
+        busyTotal += windowBusy[i];
+    }
+
+    if(total == 0)
+        return 0;
+
+    return (busyTotal * 100) / total;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file AVR_SPI_soft_slave.c
+ * @author Lukas Ternjej
+ *
+ * Bit-banged software slave .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_soft_slave.h"
+
+#if SPI_USE_SOFT_SLAVE
+
+volatile uint8_t SPI_softSlaveTx = DUMMY_CHAR;
+
+// received bits behind a marker bit; the marker is shifted out of bit 7 by the 8th bit, so 0x01 means no bits received
+static volatile uint8_t softSlaveRx = 0x01;
+
+/**
+ * Function for initializing software slave: SCK, MOSI and SS as inputs, MISO released until SS is pulled low,
+ * pin change interrupts on SCK and SS. Use it instead of SPI_init() in SLAVE_MODE.
+ ** Interrupts have to be enabled with sei().
+ *! Master has to clock at most the SCK rate in README (Software slave), with a byte gap after every byte!
+ */
+void SPI_softSlaveInit(void)
+{
+    SOFT_SPI_DDRx &= ~((1 << SOFT_SCK_PIN_PORTxn) | (1 << SOFT_MOSI_PIN_PORTxn) | (1 << SOFT_MISO_PIN_PORTxn) | (1 << SOFT_SS_PIN_PORTxn));
+    SOFT_SPI_PORTx &= ~(1 << SOFT_MISO_PIN_PORTxn);
+
+    softSlaveRx = 0x01;
+    SPI_softSlaveTx = DUMMY_CHAR;
+
+    // interrupt on both edges of SCK and SS
+    SOFT_PCMSKx |= (1 << SOFT_SCK_PCINTn) | (1 << SOFT_SS_PCINTn);
+    PCICR |= (1 << SOFT_PCIEx);
+}
+
+#if defined(__AVR__)
+/**
+ * Interrupt service routine for SCK and SS pin changes. Only r24 and SREG are saved on bit edges; registers that
+ * C code may use are saved only when a byte is complete. Cycles from pin change, with 4 cycles of interrupt response
+ * and rjmp in vector table (add 1 - 3 cycles for the instruction that is being executed):
+ * - rising SCK edge: 32 cycles, MOSI is sampled at cycle 19
+ * - falling SCK edge: 43 cycles, MISO changes at cycle 29 - 32
+ * - rising SCK edge that completes a byte: 92 cycles + SPI_softSlaveByte(), including its call and return
+ * - SS edges: 32 cycles (high), 41 cycles (low)
+ */
+ISR(SOFT_PCINT_vect, ISR_NAKED)
+{
+    asm volatile(
+        "push r24                 \n\t"
+        "in   r24, __SREG__       \n\t"
+        "push r24                 \n\t"
+        "sbic %[pin], %[ss]       \n\t"     // SS high, slave isn't selected
+        "rjmp 3f                  \n\t"
+        "sbis %[pin], %[sck]      \n\t"     // SCK low, falling SCK edge or falling SS edge
+        "rjmp 2f                  \n\t"
+
+        // rising edge: shift in MOSI, marker bit in carry means the byte is complete
+        "lds  r24, %[rx]          \n\t"
+        "lsl  r24                 \n\t"
+        "sbic %[pin], %[mosi]     \n\t"
+        "ori  r24, 0x01           \n\t"
+        "brcs 4f                  \n\t"
+        "sts  %[rx], r24          \n\t"
+
+        "1:                       \n\t"
+        "pop  r24                 \n\t"
+        "out  __SREG__, r24       \n\t"
+        "pop  r24                 \n\t"
+        "reti                     \n\t"
+
+        // falling edge: drive MISO with the next bit; between bytes bit 7 of the loaded byte isn't shifted
+        "2:                       \n\t"
+        "sbi  %[ddr], %[miso]     \n\t"
+        "lds  r24, %[rx]          \n\t"
+        "cpi  r24, 0x01           \n\t"
+        "lds  r24, %[tx]          \n\t"
+        "breq 5f                  \n\t"
+        "lsl  r24                 \n\t"
+        "sts  %[tx], r24          \n\t"
+        "5:                       \n\t"
+        "sbrc r24, 7              \n\t"
+        "sbi  %[port], %[miso]    \n\t"
+        "sbrs r24, 7              \n\t"
+        "cbi  %[port], %[miso]    \n\t"
+        "rjmp 1b                  \n\t"
+
+        // SS high: release MISO and drop a partly received byte
+        "3:                       \n\t"
+        "cbi  %[ddr], %[miso]     \n\t"
+        "cbi  %[port], %[miso]    \n\t"
+        "ldi  r24, 0x01           \n\t"
+        "sts  %[rx], r24          \n\t"
+        "rjmp 1b                  \n\t"
+
+        // byte complete: save call-clobbered registers and pass the byte (r24) to the receive state machine
+        "4:                       \n\t"
+        "push r0                  \n\t"
+        "push r1                  \n\t"
+        "push r18                 \n\t"
+        "push r19                 \n\t"
+        "push r20                 \n\t"
+        "push r21                 \n\t"
+        "push r22                 \n\t"
+        "push r23                 \n\t"
+        "push r25                 \n\t"
+        "push r26                 \n\t"
+        "push r27                 \n\t"
+        "push r30                 \n\t"
+        "push r31                 \n\t"
+        "clr  r1                  \n\t"
+        "ldi  r25, 0x01           \n\t"
+        "sts  %[rx], r25          \n\t"
+        "%~call SPI_softSlaveByte \n\t"
+        "pop  r31                 \n\t"
+        "pop  r30                 \n\t"
+        "pop  r27                 \n\t"
+        "pop  r26                 \n\t"
+        "pop  r25                 \n\t"
+        "pop  r23                 \n\t"
+        "pop  r22                 \n\t"
+        "pop  r21                 \n\t"
+        "pop  r20                 \n\t"
+        "pop  r19                 \n\t"
+        "pop  r18                 \n\t"
+        "pop  r1                  \n\t"
+        "pop  r0                  \n\t"
+        "rjmp 1b                  \n\t"
+        :
+        : [pin] "I"(_SFR_IO_ADDR(SOFT_SPI_PINx)), [ddr] "I"(_SFR_IO_ADDR(SOFT_SPI_DDRx)),
+          [port] "I"(_SFR_IO_ADDR(SOFT_SPI_PORTx)), [sck] "I"(SOFT_SCK_PIN_PORTxn), [mosi] "I"(SOFT_MOSI_PIN_PORTxn),
+          [miso] "I"(SOFT_MISO_PIN_PORTxn), [ss] "I"(SOFT_SS_PIN_PORTxn), [rx] "i"(&softSlaveRx), [tx] "i"(&SPI_softSlaveTx));
+}
+#else
+/**
+ * Interrupt service routine for SCK and SS pin changes, C version of the assembly routine for builds without
+ * AVR assembler (host simulator). Branches follow the assembly routine, so its cycle counts apply.
+ */
+ISR(SOFT_PCINT_vect)
+{
+    if(SOFT_SPI_PINx & (1 << SOFT_SS_PIN_PORTxn))
+    {
+        // SS high: release MISO and drop a partly received byte
+        SOFT_SPI_DDRx &= ~(1 << SOFT_MISO_PIN_PORTxn);
+        SOFT_SPI_PORTx &= ~(1 << SOFT_MISO_PIN_PORTxn);
+        softSlaveRx = 0x01;
+        return;
+    }
+
+    if(SOFT_SPI_PINx & (1 << SOFT_SCK_PIN_PORTxn))
+    {
+        // rising edge: shift in MOSI, marker bit shifted out of bit 7 means the byte is complete
+        bool complete = softSlaveRx & 0x80;
+        uint8_t rx = (softSlaveRx << 1) | ((SOFT_SPI_PINx >> SOFT_MOSI_PIN_PORTxn) & 0x01);
+
+        if(complete)
+        {
+            softSlaveRx = 0x01;
+            SPI_softSlaveByte(rx);
+        }
+
+        else
+            softSlaveRx = rx;
+
+        return;
+    }
+
+    // falling edge: drive MISO with the next bit; between bytes bit 7 of the loaded byte isn't shifted
+    SOFT_SPI_DDRx |= (1 << SOFT_MISO_PIN_PORTxn);
+
+    uint8_t tx = SPI_softSlaveTx;
+
+    if(softSlaveRx != 0x01)
+    {
+        tx <<= 1;
+        SPI_softSlaveTx = tx;
+    }
+
+    if(tx & 0x80)
+        SOFT_SPI_PORTx |= (1 << SOFT_MISO_PIN_PORTxn);
+
+    else
+        SOFT_SPI_PORTx &= ~(1 << SOFT_MISO_PIN_PORTxn);
+}
+#endif
+#endif
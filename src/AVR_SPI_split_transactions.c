@@ -0,0 +1,86 @@
+/**
+ * @file AVR_SPI_split_transactions.c
+ * @author Lukas Ternjej
+ *
+ * Split SPI transactions .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_split_transactions.h"
+
+/**
+ * Function that transmits a command to slave and marks transaction as pending. Bus is released right after the command.
+ *
+ * @param transaction split transaction that is going to be issued
+ * @param command string command that is going to be transmitted via SPI
+ * @param now current application tick
+ * @return true if command is issued, false if transaction is still pending
+ */
+bool SPI_splitIssue(SPI_split_t *transaction, char *command, uint16_t now)
+{
+    if(transaction->state == SPLIT_PENDING)
+        return false;
+
+    SPI_deviceTransmitString(&transaction->device, command);
+
+    transaction->issuedAt = now;
+    transaction->state = SPLIT_PENDING;
+
+    return true;
+}
+
+/**
+ * Function that collects responses of all pending transactions whose slave is ready.
+ * Slave is ready when its ready condition returns true or when waitTicks have elapsed since the command was issued.
+ ** Call this function from the main loop, between other bus work.
+ *
+ * @param transactions array of split transactions
+ * @param count number of array elements
+ * @param now current application tick
+ * @return number of responses collected in this call
+ */
+uint8_t SPI_splitService(SPI_split_t transactions[], uint8_t count, uint16_t now)
+{
+    uint8_t collected = 0;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        SPI_split_t *transaction = &transactions[i];
+
+        if(transaction->state != SPLIT_PENDING)
+            continue;
+
+        // unsigned subtraction keeps elapsed time correct when tick counter overflows
+        bool elapsed = (uint16_t)(now - transaction->issuedAt) >= transaction->waitTicks;
+        bool ready = (transaction->isReady != NULL) && transaction->isReady();
+
+        if(elapsed || ready)
+        {
+            SPI_deviceReceiveBytes(&transaction->device, transaction->response, transaction->responseBytes);
+
+            transaction->state = SPLIT_COMPLETE;
+            collected++;
+        }
+    }
+
+    return collected;
+}
+
+/**
+ * Function that checks if response of a transaction is collected. Completed transaction is set back to idle.
+ *
+ * @param transaction split transaction
+ * @return true if response is available in response buffer; else, return false
+ */
+bool SPI_splitComplete(SPI_split_t *transaction)
+{
+    if(transaction->state == SPLIT_COMPLETE)
+    {
+        transaction->state = SPLIT_IDLE;
+        return true;
+    }
+
+    else
+        return false;
+}
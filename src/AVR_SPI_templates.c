@@ -0,0 +1,118 @@
+/**
+ * @file AVR_SPI_templates.c
+ * @author Lukas Ternjej
+ *
+ * Transaction templates .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_templates.h"
+
+/**
+ * Function that starts a template. Template runs in following SPI_templateService() calls.
+ *
+ * @param instance template state
+ * @param program template program in flash (PROGMEM)
+ */
+void SPI_templateStart(SPI_template_t *instance, const uint8_t *program)
+{
+    instance->program = program;
+    instance->waitTicks = 0;
+}
+
+/**
+ * Function that runs template instructions until a delay or the end of template.
+ * Bytes between two delays are transmitted back to back. Delays don't block, function returns and resumes later.
+ ** Call this function from the main loop, between other bus work.
+ *
+ * @param instance template state
+ * @param now current application tick
+ * @return true if template is finished or stopped on an unknown opcode (program isn't NULL then); else, return false
+ */
+bool SPI_templateService(SPI_template_t *instance, uint16_t now)
+{
+    SPI_device_t *device = instance->device;
+    const uint8_t *pc = instance->program;
+
+    if(pc == NULL)
+        return true;
+
+    if(instance->waitTicks != 0)
+    {
+        // unsigned subtraction keeps elapsed time correct when tick counter overflows,
+        // delay started somewhere inside tick waitStart, so wait for one more tick to get at least waitTicks full ticks
+        if((uint16_t)(now - instance->waitStart) <= instance->waitTicks)
+            return false;
+
+        instance->waitTicks = 0;
+    }
+
+    while(true)
+    {
+        uint8_t instruction = pgm_read_byte(pc++);
+        uint8_t count = instruction & TPL_COUNT_MASK;
+
+        switch(instruction & TPL_OP_MASK)
+        {
+        case TPL_SELECT:
+            SPI_deviceSelect(device);
+            break;
+
+        case TPL_RELEASE:
+            SPI_deviceRelease(device);
+            break;
+
+        case TPL_OP_CMD:
+        case TPL_OP_DATA:
+        case TPL_OP_RAW:
+            if(instance->DC_PORTx != NULL && (instruction & TPL_OP_MASK) == TPL_OP_CMD)
+                *instance->DC_PORTx &= ~(1 << instance->DC_PORTxn);     // DC low, command bytes
+
+            else if(instance->DC_PORTx != NULL && (instruction & TPL_OP_MASK) == TPL_OP_DATA)
+                *instance->DC_PORTx |= (1 << instance->DC_PORTxn);     // DC high, data bytes
+
+            while(count--)
+                SPI_masterPutUint8_t(pgm_read_byte(pc++));
+            break;
+
+        case TPL_DELAY:
+            instance->waitTicks = pgm_read_byte(pc++);
+            instance->waitStart = now;
+
+            if(instance->waitTicks != 0)
+            {
+                instance->program = pc;
+                return false;
+            }
+            break;
+
+        case TPL_END:
+            instance->program = NULL;
+            return true;
+
+        default:     // unknown opcode, stop on it and leave program pointing at it
+            instance->program = pc - 1;
+            return true;
+        }
+    }
+}
+
+/**
+ * Function that runs a whole template, delays are busy waited with one tick being one millisecond.
+ *
+ * @param instance template state
+ * @param program template program in flash (PROGMEM)
+ */
+void SPI_templateRun(SPI_template_t *instance, const uint8_t *program)
+{
+    uint16_t now = 0;
+
+    SPI_templateStart(instance, program);
+
+    while(!SPI_templateService(instance, now))
+    {
+        _delay_ms(1);
+        now++;
+    }
+}
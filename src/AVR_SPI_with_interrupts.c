@@ -9,6 +9,36 @@
 
 #include "AVR_SPI_with_interrupts.h"
 
+#if SPI_USE_FEC
+    #include "AVR_SPI_fec.h"
+#endif
+
+#if SPI_USE_CIPHER
+    #include "AVR_SPI_cipher.h"
+#endif
+
+#if SPI_USE_METER
+    #include "AVR_SPI_meter.h"
+#endif
+
+#if SPI_USE_HUB
+    #include "AVR_SPI_hub.h"
+#endif
+
+#if SPI_USE_STREAM
+    #include "AVR_SPI_stream.h"
+#endif
+
+#if SPI_USE_SOFT_SLAVE
+    #include "AVR_SPI_soft_slave.h"
+
+    #define SLAVE_DATA_REGISTER SPI_softSlaveTx     // byte that software slave shifts out next
+#else
+    #define SLAVE_DATA_REGISTER SPDR
+#endif
+
+static uint8_t byteGap = 0;     // inter-byte gap of the device selected with SPI_deviceSelect()
+
 /**
  * Function for initializing SPI communication on Atmel AVR 8-bit microcontrollers that have a dedicated SPI module.
  ** This function doesn't handle multiple slave devices; manual control of multiple SS lines is mandatory.
@@ -54,11 +84,19 @@ void SPI_init(uint8_t deviceMode, uint8_t dataOrder, uint8_t SPIMode, uint8_t cl
  */
 uint8_t SPI_masterReadUint8_t()
 {
-    SPDR = 0xFF;     // writing to SPDR generates SCK for transmission, write dummy data in the SPDR register
+    SPDR = DUMMY_CHAR;     // writing to SPDR generates SCK for transmission, write dummy data in the SPDR register
 
     while(!(SPSR & (1 << SPIF)))
         ;
 
+    if(byteGap != 0)
+        _delay_loop_1(byteGap);     // give slow slave ISR routine time to handle the byte, SCK stays at full rate
+
+#if SPI_USE_METER
+    if(SPI_meterCurrent != NULL)
+        SPI_meterCurrent->bytes++;
+#endif
+
     return SPDR;
 }
 
@@ -81,26 +119,586 @@ volatile uint8_t dataIndex = 0;
 
 volatile bool dataReceived = false;
 volatile size_t receivedBytes = 0;
+static size_t previousBytes = 0;     // length of message that is in SPI_data[]
 
-// read SPI data in ISR routine
-ISR(SPI_STC_vect)
+// slave response queue, bytes are preloaded into SPDR one by one in ISR routine
+static volatile uint8_t responseQueue[RESPONSE_QUEUE_LENGTH];
+static volatile uint8_t responseHead = 0;        // index of next byte that is going to be loaded in SPDR
+static volatile uint8_t responseTail = 0;        // index of first free element in response queue
+static volatile uint8_t responseQueued = 0;      // number of bytes in response queue
+static volatile bool responseLoaded = false;     // true while a response byte waits in SPDR
+
+// slave attention line
+static volatile uint8_t *attentionPORTx = NULL;
+static uint8_t attentionPORTxn = 0;
+
+// byte that slave shifts out when there is no queued response
+static volatile uint8_t idleResponse = DUMMY_CHAR;
+
+#if !SPI_USE_FEC && !SPI_USE_STREAM
+static volatile bool firstEscape = false;     // first byte of message is escaped, see SPI_masterPutFirst()
+#endif
+
+#if SPI_USE_FEC
+static volatile uint8_t fecHighNibble = 0;
+static volatile bool fecHighNibbleReceived = false;
+#endif
+
+#if SPI_USE_CIPHER
+    #define CIPHER_RX_START 0     // next byte starts a message
+    #define CIPHER_RX_NONCE 1     // session start message, nonce bytes
+    #define CIPHER_RX_SYNC  2     // block counter bytes
+    #define CIPHER_RX_DATA  3     // encrypted bytes
+    #define CIPHER_RX_DROP  4     // keystream isn't at the block of the message, rest of message is dropped
+
+static SPI_cipher_t *volatile rxCipher = NULL;
+static volatile bool escapeReceived = false;
+static volatile uint8_t cipherState = CIPHER_RX_START;
+static volatile uint8_t cipherBytes = 0;         // received nonce or block counter bytes
+static volatile uint32_t cipherValue = 0;        // nonce or block counter, most significant byte first
+#endif
+
+#if SPI_USE_STREAM
+static volatile bool streamInFrame = false;     // [STREAM_SYNC_CHAR] has been received, bytes are part of a frame
+static volatile bool streamEscape = false;
+static volatile uint8_t streamCrc = 0;          // CRC-8 of received payload and CRC byte, 0 for a valid frame
+static volatile uint8_t streamLength = 0;       // number of received payload and CRC bytes, stored or not
+#endif
+
+#if SPI_USE_DISCOVERY
+static volatile uint8_t deviceID = 0;     // 0 until SPI_slaveSetID() is called
+#endif
+
+#if SPI_USE_DEDUP
+static volatile uint16_t frameHash = 0;                  // hash of current message, updated with every stored byte
+static volatile uint16_t dedupHash[DEDUP_CHANNELS];      // hash of the last message on every channel
+static volatile uint8_t dedupLength[DEDUP_CHANNELS];     // length of the last message on every channel, 0 if none
+static volatile uint8_t dedupFirst[DEDUP_CHANNELS];      // first byte of the last message on every channel
+static volatile uint8_t dedupLast[DEDUP_CHANNELS];       // last byte of the last message on every channel
+static volatile uint16_t duplicates = 0;
+static volatile uint8_t dedupMode = DEDUP_DROP;
+static volatile bool frameDuplicate = false;             // true if received message is a repeated message
+static bool dataDuplicate = false;                       // true if message in SPI_data[] is a repeated message
+#endif
+
+#if SPI_USE_FRAME_POOL
+static SPI_frame_t framePool[FRAME_POOL_LENGTH];
+static SPI_frame_t *volatile readyFrames[FRAME_POOL_LENGTH];     // received frames, in order of reception
+static volatile uint8_t readyHead = 0;
+static volatile uint8_t readyCount = 0;
+static SPI_frame_t *volatile rxFrame = NULL;      // frame that ISR routine receives into, NULL if pool is empty
+static uint8_t *volatile rxBuffer = NULL;         // data of rxFrame, or SPI_buffer[] as scratch if pool is empty
+
+    #define RX_BUFFER rxBuffer     // ISR routine writes directly into pool frame
+#else
+    #define RX_BUFFER SPI_buffer
+#endif
+
+#if SPI_USE_STATS
+static SPI_stats_t stats = {0, 0, 0, 0};
+static volatile bool messageOverflow = false;     // true if current message is longer than SPI_buffer[]
+#endif
+
+/**
+ * Function that puts response data in response queue. Interrupts have to be disabled, or it has to be called from ISR routine.
+ *
+ * @param data array of bytes that are going to be sent to master
+ * @param size number of array elements
+ * @return true if data is queued, false if there is not enough space in response queue
+ */
+static bool SPI_loadResponse(const uint8_t data[], size_t size)
+{
+    if(size > (size_t)(RESPONSE_QUEUE_LENGTH - responseQueued))
+        return false;
+
+    for(size_t i = 0; i < size; i++)
+    {
+        if(!responseLoaded)
+        {
+            SLAVE_DATA_REGISTER = data[i];     // first byte is shifted out on the next transfer
+            responseLoaded = true;
+        }
+
+        else
+        {
+            responseQueue[responseTail] = data[i];
+            responseTail = (responseTail + 1) % RESPONSE_QUEUE_LENGTH;
+            responseQueued++;
+        }
+    }
+
+    if(size > 0 && attentionPORTx != NULL)
+        *attentionPORTx &= ~(1 << attentionPORTxn);     // assert attention line, master should read the response
+
+    return true;
+}
+
+#if SPI_USE_FRAME_POOL
+/**
+ * Function that takes a free frame from pool for ISR routine to receive into. Called from ISR routine.
+ */
+static void SPI_frameAlloc(void)
+{
+    rxFrame = NULL;
+    rxBuffer = (uint8_t *)SPI_buffer;
+
+    for(uint8_t i = 0; i < FRAME_POOL_LENGTH; i++)
+    {
+        if(framePool[i].refCount == 0)
+        {
+            framePool[i].refCount = 1;     // held by ISR routine until it is read with SPI_readFrame()
+            rxFrame = &framePool[i];
+            rxBuffer = rxFrame->data;
+            break;
+        }
+    }
+}
+
+#endif
+
+#if SPI_USE_STATS
+/**
+ * Function that queues statistics block as response, it is called from ISR routine when [STATS_QUERY_CHAR] is received.
+ */
+static void SPI_loadStats(void)
+{
+    // little endian, so block doesn't depend on structure layout
+    uint8_t block[STATS_LENGTH] = {
+        stats.framesReceived & 0xFF, stats.framesReceived >> 8,
+        stats.overruns & 0xFF, stats.overruns >> 8,
+        stats.maxIsrTicks & 0xFF, stats.maxIsrTicks >> 8,
+        stats.highWaterMark,
+    };
+
+    SPI_loadResponse(block, STATS_LENGTH);
+}
+#endif
+
+#if !SPI_USE_MEMORY     // memory personality has its own ISR routine, see AVR_SPI_memory.c
+/**
+ * Function that is the slave receive state machine: stores a received byte, loads the byte that is shifted out next
+ * and ends messages. Every path returns to SPI_slaveReceiveByte(), which measures ISR routine time.
+ *
+ * @param data received byte
+ */
+static inline void SPI_slaveHandleByte(uint8_t data)
 {
-    SPI_buffer[dataIndex] = SPDR;
+#if SPI_USE_HUB
+    if(SPI_hubTarget != NULL)
+    {
+        // cut-through: byte goes downstream right away, downstream response goes upstream with the next byte
+        SLAVE_DATA_REGISTER = SPI_hubExchange(data);
+        return;
+    }
+
+    if(SPI_hubHeader)
+    {
+        SPI_hubHeader = false;
+
+        if(SPI_hubSelect(data))
+        {
+            SLAVE_DATA_REGISTER = idleResponse;
+            return;
+        }
+    }
+#endif
+
+    if(responseLoaded)
+    {
+        // response byte in SPDR has been shifted out, load the next one
+        if(responseQueued > 0)
+        {
+            SLAVE_DATA_REGISTER = responseQueue[responseHead];
+            responseHead = (responseHead + 1) % RESPONSE_QUEUE_LENGTH;
+            responseQueued--;
+        }
+
+        else
+        {
+            SLAVE_DATA_REGISTER = idleResponse;
+            responseLoaded = false;
+
+            if(attentionPORTx != NULL)
+                *attentionPORTx |= (1 << attentionPORTxn);     // release attention line, whole response is read
+        }
+    }
+
+    else
+        SLAVE_DATA_REGISTER = idleResponse;     // don't echo received byte back to master
+
+    // master generates SCK with [DUMMY_CHAR] when reading, don't store it as start of a new message
+#if SPI_USE_FEC
+    if(data == DUMMY_CHAR && dataIndex == 0 && !fecHighNibbleReceived)     // in low nibble slot it is a damaged code byte
+#else
+    if(data == DUMMY_CHAR && dataIndex == 0)
+#endif
+        return;
+
+    bool messageEnd = (data == DATA_END_CHAR);
+
+#if !SPI_USE_FEC && !SPI_USE_STREAM     // FEC code bytes and stream frames aren't escaped
+#if SPI_USE_CIPHER
+    bool plain = (rxCipher == NULL);     // encrypted messages have their own escaping
+#else
+    bool plain = true;
+#endif
+
+    // master escapes the first byte of a message if it equals [DUMMY_CHAR] or [ESCAPE_CHAR]
+    if(firstEscape)
+    {
+        firstEscape = false;
+
+        if(!messageEnd)
+            data ^= ESCAPE_XOR;
+    }
+
+    else if(plain && data == ESCAPE_CHAR && dataIndex == 0)
+    {
+        firstEscape = true;
+        return;
+    }
+#endif
+
+#if SPI_USE_FEC
+    if(!messageEnd)
+    {
+        // each data byte is received as two code bytes, high nibble first
+        uint8_t nibble = pgm_read_byte(&FEC_decodeTable[data & 0x7F]);
+
+        if(nibble & FEC_CORRECTED)
+            SPI_fecCorrected++;
+
+        if(!fecHighNibbleReceived)
+        {
+            fecHighNibble = (nibble & 0x0F) << 4;
+            fecHighNibbleReceived = true;
+            return;
+        }
+
+        data = fecHighNibble | (nibble & 0x0F);     // decoded byte may equal [DATA_END_CHAR], so messageEnd is decided on raw byte
+    }
+
+    fecHighNibbleReceived = false;
+#endif
+
+#if SPI_USE_CIPHER
+    if(rxCipher != NULL)
+    {
+        if(!messageEnd)
+        {
+            if(cipherState == CIPHER_RX_START)
+            {
+                // session start message is [CIPHER_NONCE_CHAR] and nonce, every other message starts with block counter
+                cipherState = (data == CIPHER_NONCE_CHAR) ? CIPHER_RX_NONCE : CIPHER_RX_SYNC;
+                cipherValue = 0;
+                cipherBytes = 0;
+
+                if(cipherState == CIPHER_RX_NONCE)
+                    return;
+            }
+
+            if(data == ESCAPE_CHAR && !escapeReceived)
+            {
+                escapeReceived = true;     // next byte is escaped
+                return;
+            }
+
+            if(escapeReceived)
+            {
+                data ^= ESCAPE_XOR;
+                escapeReceived = false;
+            }
+
+            if(cipherState == CIPHER_RX_NONCE || cipherState == CIPHER_RX_SYNC)
+            {
+                // nonce and block counter are sent in clear, most significant byte first
+                cipherValue = (cipherValue << 8) | data;
+                cipherBytes++;
+
+                if(cipherState == CIPHER_RX_SYNC && cipherBytes == CIPHER_SYNC_LENGTH)
+                {
+                    uint16_t block = cipherValue >> 8;
+
+                    if((uint8_t)cipherValue == CIPHER_SYNC_CHECK(block) && SPI_cipherSeek(rxCipher, block))
+                        cipherState = CIPHER_RX_DATA;
+
+                    else
+                        cipherState = CIPHER_RX_DROP;
+                }
+
+                return;
+            }
+
+            if(cipherState == CIPHER_RX_DATA && rxCipher->count == 0)
+            {
+                rxCipher->underruns++;     // keystream is never computed in ISR routine, message is dropped
+                cipherState = CIPHER_RX_DROP;
+            }
+
+            if(cipherState == CIPHER_RX_DROP)
+                return;
+
+            data ^= SPI_cipherNext(rxCipher);     // keystream is precomputed, so decryption is a single XOR
+        }
+
+        else
+        {
+            uint8_t state = cipherState;
+
+            cipherState = CIPHER_RX_START;
+            escapeReceived = false;
+
+            if(state == CIPHER_RX_NONCE && cipherBytes == CIPHER_NONCE_LENGTH)
+                SPI_cipherRestart(rxCipher, cipherValue);     // keystream is refilled by SPI_cipherRefill() in main loop
+
+            // message without data bytes passes, session start and damaged messages are dropped
+            if(state != CIPHER_RX_START && state != CIPHER_RX_DATA)
+            {
+                dataIndex = 0;
+#if SPI_USE_STATS
+                messageOverflow = false;
+#endif
+                return;
+            }
+        }
+    }
+#endif
+
+#if SPI_USE_STREAM
+    if(data == STREAM_SYNC_CHAR)
+    {
+        // sync marker starts a frame, frame that hasn't ended is dropped
+        if(streamInFrame && streamLength != 0)
+            SPI_streamResyncs++;
+
+        streamInFrame = true;
+        streamEscape = false;
+        streamCrc = 0;
+        streamLength = 0;
+        dataIndex = 0;
+        return;
+    }
+
+    if(!streamInFrame)
+        return;     // bytes between frames are ignored until the next sync marker
+
+    if(messageEnd)
+    {
+        streamInFrame = false;
+
+        // frame has to hold at least a payload byte and CRC, and every byte has to be stored
+        if(streamEscape || streamCrc != 0 || streamLength < 2 || streamLength != dataIndex)
+        {
+            SPI_streamErrors++;
+            dataIndex = 0;
+#if SPI_USE_STATS
+            messageOverflow = false;
+#endif
+            return;
+        }
+
+        dataIndex--;     // CRC byte isn't part of the message, [DATA_END_CHAR] overwrites it
+    }
+
+    else
+    {
+        if(data == ESCAPE_CHAR && !streamEscape)
+        {
+            streamEscape = true;     // next byte is escaped
+            return;
+        }
+
+        if(streamEscape)
+        {
+            data ^= ESCAPE_XOR;
+            streamEscape = false;
+        }
+
+        streamCrc = pgm_read_byte(&STREAM_crcTable[streamCrc ^ data]);
+
+        if(streamLength < 0xFF)
+            streamLength++;
+    }
+#endif
 
-    if(SPI_buffer[dataIndex] != DATA_END_CHAR)
+    if(!messageEnd)
     {
-        // increment dataIndex and count the number of received bytes in a message
-        dataIndex++;
-        receivedBytes++;
+        // keep space for [DATA_END_CHAR], bytes that don't fit in SPI_buffer[] are dropped
+        if(dataIndex < DATA_LENGTH - 1)
+        {
+#if SPI_USE_DEDUP
+            // hash = hash * 33 ^ data, compiles to shifts and adds
+            if(dataIndex == 0)
+                frameHash = 5381 ^ data;
+
+            else
+                frameHash = ((frameHash << 5) + frameHash) ^ data;
+#endif
+
+#if SPI_USE_FRAME_POOL
+            if(dataIndex == 0 && rxFrame == NULL)
+                SPI_frameAlloc();     // try again, consumers may have released frames since the last message
+#endif
+
+            RX_BUFFER[dataIndex] = data;
+            dataIndex++;     // increment dataIndex, it is the number of received bytes in a message
+        }
+
+#if SPI_USE_STATS
+        else
+            messageOverflow = true;
+#endif
     }
 
     else
     {
+#if SPI_USE_FRAME_POOL
+        // message without data bytes gets a frame here, message whose bytes went to scratch buffer is dropped
+        if(rxFrame == NULL && dataIndex == 0)
+            SPI_frameAlloc();
+#endif
+
+        RX_BUFFER[dataIndex] = DATA_END_CHAR;
+
+#if SPI_USE_DISCOVERY
+        if(dataIndex == 1 && RX_BUFFER[0] == ID_QUERY_CHAR && deviceID != 0)
+        {
+            // discovery query is answered by the library, message isn't passed to SPI_readAll()
+            uint8_t id = deviceID;
+            SPI_loadResponse(&id, 1);
+            dataIndex = 0;
+            return;
+        }
+#endif
+
+#if SPI_USE_STATS
+        if(dataIndex == 1 && RX_BUFFER[0] == STATS_QUERY_CHAR)
+        {
+            // statistics query is answered by the library, message isn't passed to SPI_readAll()
+            SPI_loadStats();
+            dataIndex = 0;
+            return;
+        }
+#endif
+
+#if SPI_USE_DEDUP
+        frameDuplicate = false;
+
+#if SPI_USE_FRAME_POOL
+        if(dataIndex != 0 && rxFrame != NULL)     // message that is dropped for empty pool isn't remembered
+#else
+        if(dataIndex != 0)
+#endif
+        {
+            uint8_t channel = RX_BUFFER[0] & (DEDUP_CHANNELS - 1);
+
+            // first and last byte are compared too, changed message rarely keeps them and the hash
+            if(dedupLength[channel] == dataIndex && dedupHash[channel] == frameHash && dedupFirst[channel] == RX_BUFFER[0]
+               && dedupLast[channel] == RX_BUFFER[dataIndex - 1])
+            {
+                duplicates++;
+
+                if(dedupMode == DEDUP_DROP)
+                {
+                    // message is dropped before it reaches SPI_buffer[] reader, unread message isn't overwritten
+                    dataIndex = 0;
+#if SPI_USE_STATS
+                    messageOverflow = false;
+#endif
+                    return;
+                }
+
+                frameDuplicate = true;
+            }
+
+            dedupHash[channel] = frameHash;
+            dedupLength[channel] = dataIndex;
+            dedupFirst[channel] = RX_BUFFER[0];
+            dedupLast[channel] = RX_BUFFER[dataIndex - 1];
+        }
+#endif
+
+#if SPI_USE_STATS && SPI_USE_FRAME_POOL
+        if(rxFrame == NULL)
+            messageOverflow = true;     // pool was empty, message is dropped
+#endif
+
+#if SPI_USE_STATS
+        if(dataReceived || messageOverflow)
+            stats.overruns++;     // previous message wasn't read with SPI_readAll(), or message was too long
+
+        if(dataIndex > stats.highWaterMark)
+            stats.highWaterMark = dataIndex;
+
+        stats.framesReceived++;
+        messageOverflow = false;
+#endif
+
+#if SPI_USE_FRAME_POOL
+        if(rxFrame != NULL)
+        {
+            // pool has as many frames as ready queue has slots, so queue can't be full
+            rxFrame->length = dataIndex;
+#if SPI_USE_DEDUP
+            rxFrame->duplicate = frameDuplicate;
+#else
+            rxFrame->duplicate = false;
+#endif
+            readyFrames[(readyHead + readyCount) % FRAME_POOL_LENGTH] = rxFrame;
+            readyCount++;
+        }
+
+        SPI_frameAlloc();
+#else
+        receivedBytes = dataIndex;
         dataReceived = true;
+#endif
         dataIndex = 0;
     }
 }
 
+/**
+ * Function that passes a received byte through the receive state machine and measures ISR routine time.
+ * It has a single caller, SPI_STC_vect or SPI_softSlaveByte(), so it is inlined there.
+ *
+ * @param data received byte
+ */
+static void SPI_slaveReceiveByte(uint8_t data)
+{
+#if SPI_USE_STATS
+    uint16_t isrStart = TCNT1;
+#endif
+
+    SPI_slaveHandleByte(data);
+
+#if SPI_USE_STATS
+    uint16_t isrTicks = TCNT1 - isrStart;     // includes messages that return early (queries, dropped repeats)
+
+    if(isrTicks > stats.maxIsrTicks)
+        stats.maxIsrTicks = isrTicks;
+#endif
+}
+
+#if SPI_USE_SOFT_SLAVE
+/**
+ * Function that passes a byte received by software slave through the receive state machine.
+ * Called from pin change ISR routine of software slave, see AVR_SPI_soft_slave.c.
+ *
+ * @param data received byte
+ */
+void SPI_softSlaveByte(uint8_t data)
+{
+    SPI_slaveReceiveByte(data);
+}
+#else
+// read SPI data in ISR routine
+ISR(SPI_STC_vect)
+{
+    SPI_slaveReceiveByte(SPDR);
+}
+#endif
+#endif
+
 /**
  * Function that sets all array elements to '\0'.
  *
@@ -133,23 +731,47 @@ int SPI_strcmp(uint8_t *str1, char *str2)
  */
 bool SPI_readAll()
 {
+#if SPI_USE_FRAME_POOL
+    SPI_frame_t *frame = SPI_readFrame();
+
+    if(frame != NULL)
+    {
+        flushBuffer(SPI_data, previousBytes);
+        previousBytes = frame->length;
+
+        for(size_t i = 0; i < frame->length; i++)
+            SPI_data[i] = frame->data[i];
+
+#if SPI_USE_DEDUP
+        dataDuplicate = frame->duplicate;
+#endif
+
+        SPI_frameRelease(frame);
+
+        return true;
+    }
+
+    else
+        return false;
+#else
     if(dataReceived == true)
     {
         // flush SPI_data[] from previous data before reading next message
-        flushBuffer(SPI_data, receivedBytes);
+        flushBuffer(SPI_data, previousBytes);
+        previousBytes = receivedBytes;
 
-        int i = 0;
-        // read new data into SPI_data
-        while(SPI_buffer[i] != DATA_END_CHAR)
-        {
+        // read new data into SPI_data, count of bytes is used since decoded data may contain [DATA_END_CHAR]
+        for(size_t i = 0; i < receivedBytes; i++)
             SPI_data[i] = SPI_buffer[i];
-            i++;
-        }
 
         // clear volatile array and set all array elements to '\0'
         for(size_t i = 0; i < receivedBytes; i++)
             SPI_buffer[i] = '\0';
 
+#if SPI_USE_DEDUP
+        dataDuplicate = frameDuplicate;
+#endif
+
         dataReceived = false;
         receivedBytes = 0;
 
@@ -158,6 +780,7 @@ bool SPI_readAll()
 
     else
         return false;
+#endif
 }
 
 /**
@@ -172,6 +795,32 @@ void SPI_masterPutUint8_t(uint8_t data)
 
     while(!(SPSR & (1 << SPIF)))
         ;            // wait till transmission complete
+
+    if(byteGap != 0)
+        _delay_loop_1(byteGap);     // give slow slave ISR routine time to handle the byte, SCK stays at full rate
+
+#if SPI_USE_METER
+    if(SPI_meterCurrent != NULL)
+        SPI_meterCurrent->bytes++;
+#endif
+}
+
+/**
+ * Function that writes the first byte of a message in SPDR register. Slave ignores [DUMMY_CHAR] at the start of
+ * a message, because master reads with it, so a first byte that equals [DUMMY_CHAR] or [ESCAPE_CHAR] is sent as
+ * [ESCAPE_CHAR], byte ^ [ESCAPE_XOR]; slave restores it before storing it.
+ *
+ * @param data first byte of a message
+ */
+void SPI_masterPutFirst(uint8_t data)
+{
+    if(data == DUMMY_CHAR || data == ESCAPE_CHAR)
+    {
+        SPI_masterPutUint8_t(ESCAPE_CHAR);
+        data ^= ESCAPE_XOR;
+    }
+
+    SPI_masterPutUint8_t(data);
 }
 
 /**
@@ -190,15 +839,14 @@ void SPI_putUint8_t(uint8_t data)
 }
 
 /**
- * Function for transmitting an uint8_t via SPI, with SS line control.
+ * Function that selects a slave device, by pulling its SS pin low (default) or high (inverted).
  *
  * @param SS_PORTx Slave select PORTx register
  * @param SS_PORTxn Slave select PORTxn register
  * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
  * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
- * @param data uint8_t that is going to be transmitted via SPI
  */
-void SPI_transmitUint8_t(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t data)
+void SPI_slaveSelect(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode)
 {
     uint8_t pullHigh = (*SS_PORTx) | (1 << SS_PORTxn);
     uint8_t pullLow = (*SS_PORTx) & ~(1 << SS_PORTxn);
@@ -206,70 +854,259 @@ void SPI_transmitUint8_t(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t
     // in inverted mode pull SS pin high to start transmision
     *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullLow + (SSmode == INVERTED_SS_CONTROL) * pullHigh;
 
-    SPI_masterPutUint8_t(data);              // write data to SPDR register
-    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
-
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullHigh + (SSmode == INVERTED_SS_CONTROL) * pullLow;
-    // in default mode pull SS pin high to end transmision
-    // in inverted mode pull SS pin low to end transmision
+#if SPI_USE_METER
+    SPI_meterSelect(SS_PORTx, SS_PORTxn);
+#endif
 }
 
 /**
- * Function for transmitting a string of chars via SPI, with SS line control.
+ * Function that releases a slave device, by pulling its SS pin high (default) or low (inverted).
  *
  * @param SS_PORTx Slave select PORTx register
  * @param SS_PORTxn Slave select PORTxn register
  * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
  * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
- * @param data char pointer that pints to an array element (string), for transmissio via SPI
  */
-void SPI_transmitString(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, char *data)
+void SPI_slaveRelease(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode)
 {
+#if SPI_USE_METER
+    SPI_meterRelease();
+#endif
+
     uint8_t pullHigh = (*SS_PORTx) | (1 << SS_PORTxn);
     uint8_t pullLow = (*SS_PORTx) & ~(1 << SS_PORTxn);
-    // in default mode pull SS pin low to start transmision
-    // in inverted mode pull SS pin high to start transmision
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullLow + (SSmode == INVERTED_SS_CONTROL) * pullHigh;
-
-    while(*data)
-    {
-        SPI_masterPutUint8_t(*data);     // write data to SPDR register
-        data++;
-    }
-
-    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
-
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullHigh + (SSmode == INVERTED_SS_CONTROL) * pullLow;
     // in default mode pull SS pin high to end transmision
     // in inverted mode pull SS pin low to end transmision
+    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullHigh + (SSmode == INVERTED_SS_CONTROL) * pullLow;
 }
 
 /**
- * FFunction that reads an uint8_t from SPDR, with SS line control.
+ * Function that selects a slave device and applies its inter-byte gap to every following
+ * SPI_masterPutUint8_t() and SPI_masterReadUint8_t() call, until SPI_deviceRelease().
  *
- * @param SS_PORTx select PORTx register
- * @param SS_PORTxn select PORTxn register
- * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
- * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
- * @return A uint8_t that is read from SPDR register
+ * @param device slave device
  */
-uint8_t SPI_receiveUint8_t(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode)
+void SPI_deviceSelect(SPI_device_t *device)
 {
-    uint8_t pullHigh = (*SS_PORTx) | (1 << SS_PORTxn);
-    uint8_t pullLow = (*SS_PORTx) & ~(1 << SS_PORTxn);
-    // in default mode pull SS pin low to start transmision
-    // in inverted mode pull SS pin high to start transmision
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullLow + (SSmode == INVERTED_SS_CONTROL) * pullHigh;
+    byteGap = device->byteGap;
+    SPI_slaveSelect(device->SS_PORTx, device->SS_PORTxn, device->SSmode);
+}
+
+/**
+ * Function that releases a slave device selected with SPI_deviceSelect().
+ *
+ * @param device slave device
+ */
+void SPI_deviceRelease(SPI_device_t *device)
+{
+    SPI_slaveRelease(device->SS_PORTx, device->SS_PORTxn, device->SSmode);
+    byteGap = 0;
+}
+
+/**
+ * Function for transmitting a string of chars via SPI, with SS line control and inter-byte gap of the device.
+ *
+ * @param device slave device
+ * @param data char pointer that points to an array element (string), for transmission via SPI
+ */
+void SPI_deviceTransmitString(SPI_device_t *device, char *data)
+{
+    SPI_deviceSelect(device);     // start transmission
+
+    if(*data)
+        SPI_masterPutFirst(*data++);     // first byte is escaped if slave would take it for a read
+
+    while(*data)
+    {
+        SPI_masterPutUint8_t(*data);     // write data to SPDR register
+        data++;
+    }
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
+
+    SPI_deviceRelease(device);     // end transmission
+}
+
+/**
+ * Function that reads multiple bytes from slave, with SS line control and inter-byte gap of the device.
+ *
+ * @param device slave device
+ * @param buffer array where received bytes are going to be stored
+ * @param numBytes number of bytes that are going to be read
+ */
+void SPI_deviceReceiveBytes(SPI_device_t *device, uint8_t buffer[], size_t numBytes)
+{
+    SPI_deviceSelect(device);     // start transmission
+
+    for(size_t i = 0; i < numBytes; i++)
+        buffer[i] = SPI_masterReadUint8_t();
+
+    SPI_deviceRelease(device);     // end transmission
+}
+
+/**
+ * Function for full-duplex transfer of raw bytes, with SS line control and inter-byte gap of the device.
+ * [DATA_END_CHAR] isn't added, this is meant for off-the-shelf SPI devices (sensors, memories, displays).
+ *
+ * @param device slave device
+ * @param txData bytes that are going to be transmitted, NULL to transmit [DUMMY_CHAR]
+ * @param rxData array where received bytes are going to be stored, NULL if received bytes aren't needed
+ * @param numBytes number of bytes that are going to be transferred
+ */
+void SPI_transferBytes(SPI_device_t *device, const uint8_t txData[], uint8_t rxData[], size_t numBytes)
+{
+    SPI_deviceSelect(device);     // start transmission
+
+    for(size_t i = 0; i < numBytes; i++)
+    {
+        SPI_masterPutUint8_t(txData != NULL ? txData[i] : DUMMY_CHAR);
+
+        if(rxData != NULL)
+            rxData[i] = SPDR;     // byte that slave shifted out while txData[i] was shifted in
+    }
+
+    SPI_deviceRelease(device);     // end transmission
+}
+
+/**
+ * Function for pipelined request/response, with SS line control and inter-byte gap of the device. Request is transmitted
+ * terminated with [DATA_END_CHAR] and, in the same transaction, the response to the previous request is received:
+ * slave queues it with SPI_queueResponse() after SPI_readAll(), so it is preloaded into SPDR before this transaction.
+ * Transaction is as long as the longer of request and response, missing request bytes are sent as [DUMMY_CHAR].
+ ** Every request/response takes one transaction instead of two (SPI_transmitString() and SPI_receiveBytes()).
+ *! Slave needs time between two transactions to queue its response; response must not start with [DUMMY_CHAR] or [READY_CHAR].
+ *
+ * @param device slave device
+ * @param request string that is going to be transmitted, NULL to only read the response to the last request
+ * @param response array where response to the previous request is stored, NULL if it isn't needed
+ * @param responseLength number of response bytes, as queued by slave
+ * @return true if slave had a response queued; else, return false (idle byte was received, slave isn't done yet)
+ */
+bool SPI_pipelineExchange(SPI_device_t *device, const char *request, uint8_t response[], size_t responseLength)
+{
+    bool escape = (request != NULL) && ((uint8_t)request[0] == DUMMY_CHAR || request[0] == ESCAPE_CHAR);     // see SPI_masterPutFirst()
+    size_t requestLength = (request != NULL) ? strlen(request) + 1 + escape : 0;                               // including [DATA_END_CHAR]
+    size_t numBytes = (requestLength > responseLength) ? requestLength : responseLength;
+    uint8_t first = DUMMY_CHAR;
+
+    SPI_deviceSelect(device);     // start transmission
+
+    for(size_t i = 0; i < numBytes; i++)
+    {
+        // response to the previous request is shifted out while this request is shifted in
+        if(escape && i == 0)
+            SPI_masterPutUint8_t(ESCAPE_CHAR);
+
+        else if(escape && i == 1)
+            SPI_masterPutUint8_t(request[0] ^ ESCAPE_XOR);
+
+        else if(i + 1 < requestLength)
+            SPI_masterPutUint8_t(request[i - escape]);
+
+        else if(i + 1 == requestLength)
+            SPI_masterPutUint8_t(DATA_END_CHAR);
+
+        else
+            SPI_masterPutUint8_t(DUMMY_CHAR);     // slave ignores [DUMMY_CHAR] between messages
+
+        if(i == 0)
+            first = SPDR;
+
+        if(response != NULL && i < responseLength)
+            response[i] = SPDR;
+    }
+
+    SPI_deviceRelease(device);     // end transmission
+
+    return first != DUMMY_CHAR && first != READY_CHAR;
+}
+
+/**
+ * Function for transmitting an uint8_t via SPI, with SS line control.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param data uint8_t that is going to be transmitted via SPI
+ */
+void SPI_transmitUint8_t(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t data)
+{
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    SPI_masterPutFirst(data);                // write data to SPDR register, escaped if slave would take it for a read
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+}
+
+/**
+ * Function for transmitting a string of chars via SPI, with SS line control.
+ *
+ * @param SS_PORTx Slave select PORTx register
+ * @param SS_PORTxn Slave select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param data char pointer that pints to an array element (string), for transmissio via SPI
+ */
+void SPI_transmitString(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, char *data)
+{
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    if(*data)
+        SPI_masterPutFirst(*data++);     // first byte is escaped if slave would take it for a read
+
+    while(*data)
+    {
+        SPI_masterPutUint8_t(*data);     // write data to SPDR register
+        data++;
+    }
+
+    SPI_masterPutUint8_t(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+}
+
+/**
+ * FFunction that reads an uint8_t from SPDR, with SS line control.
+ *
+ * @param SS_PORTx select PORTx register
+ * @param SS_PORTxn select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @return A uint8_t that is read from SPDR register
+ */
+uint8_t SPI_receiveUint8_t(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode)
+{
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
 
     uint8_t data = SPI_masterReadUint8_t();     // read data from SPDR register
 
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullHigh + (SSmode == INVERTED_SS_CONTROL) * pullLow;
-    // in default mode pull SS pin high to end transmision
-    // in inverted mode pull SS pin low to end transmision
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
 
     return data;
 }
 
+/**
+ * Function that reads multiple uint8_t values from slave in a single transmission, with SS line control.
+ *
+ * @param SS_PORTx select PORTx register
+ * @param SS_PORTxn select PORTxn register
+ * @param SSmode choose if data is transmitted when pulling SS low (default) or when pulling SS high.
+ * This is usefull when inverting schmitt triggers are used for SS line controll on master side.
+ * @param buffer array where received data is stored
+ * @param numBytes number of bytes that are going to be read from slave
+ */
+void SPI_receiveBytes(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmode, uint8_t buffer[], size_t numBytes)
+{
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
+
+    for(size_t i = 0; i < numBytes; i++)
+        buffer[i] = SPI_masterReadUint8_t();     // SS stays asserted, so slave can shift out its whole response
+
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+}
+
 /**
  * Takes an array that stores individual uint8_t values and returns combined uint64_t
  * value from all array elements.
@@ -304,18 +1141,508 @@ void SPI_transmitHex(volatile uint8_t *SS_PORTx, uint8_t SS_PORTxn, uint8_t SSmo
 {
     uint8_t mask = 0xFF;
 
-    uint8_t pullHigh = (*SS_PORTx) | (1 << SS_PORTxn);
-    uint8_t pullLow = (*SS_PORTx) & ~(1 << SS_PORTxn);
-    // in default mode pull SS pin low to start transmision
-    // in inverted mode pull SS pin high to start transmision
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullLow + (SSmode == INVERTED_SS_CONTROL) * pullHigh;
+    SPI_slaveSelect(SS_PORTx, SS_PORTxn, SSmode);     // start transmission
 
     for(int i = numBytes - 1; i >= 0; i--)
-        SPI_masterPutUint8_t((hexNumber >> (i * 8)) & mask);     // Send each byte of the hexadecimal number
+    {
+        if(i == numBytes - 1)
+            SPI_masterPutFirst((hexNumber >> (i * 8)) & mask);     // first byte is escaped if slave would take it for a read
+
+        else
+            SPI_masterPutUint8_t((hexNumber >> (i * 8)) & mask);     // Send each byte of the hexadecimal number
+    }
 
     SPI_masterPutUint8_t(DATA_END_CHAR);                         // terminate with [DATA_END_CHAR]
 
-    *SS_PORTx = (SSmode == DEFAULT_SS_CONTROL) * pullHigh + (SSmode == INVERTED_SS_CONTROL) * pullLow;
-    // in default mode pull SS pin high to end transmision
-    // in inverted mode pull SS pin low to end transmision
-}
\ No newline at end of file
+    SPI_slaveRelease(SS_PORTx, SS_PORTxn, SSmode);     // end transmission
+}
+
+/**
+ * Function that sets up an attention line on slave side. Slave pulls attention pin low
+ * while it has queued response data, and releases it when master reads the whole response.
+ *
+ * @param DDRx attention pin DDRx register
+ * @param PORTx attention pin PORTx register
+ * @param PORTxn attention pin PORTxn register
+ */
+void SPI_attentionInit(volatile uint8_t *DDRx, volatile uint8_t *PORTx, uint8_t PORTxn)
+{
+    *PORTx |= (1 << PORTxn);     // attention line is high when idle
+    *DDRx |= (1 << PORTxn);      // set attention pin as output
+
+    attentionPORTx = PORTx;
+    attentionPORTxn = PORTxn;
+}
+
+/**
+ * Function that queues response data on slave side. Queued bytes are shifted out to master
+ * one by one, on the following SPI transfers, and attention line is asserted until the queue is empty.
+ *! Call this function while master is not clocking data, or the first byte might be lost (SPDR write collision).
+ *
+ * @param data array of bytes that are going to be sent to master
+ * @param size number of array elements
+ * @return true if data is queued, false if there is not enough space in response queue
+ */
+bool SPI_queueResponse(uint8_t data[], size_t size)
+{
+    uint8_t sreg = SREG;
+    cli();     // response queue is shared with ISR routine
+
+    bool queued = SPI_loadResponse(data, size);
+
+    SREG = sreg;
+
+    return queued;
+}
+
+// slaves attached to external interrupts on master side
+static SPI_device_t *attentionDevice[2] = {NULL, NULL};
+static uint8_t *attentionBuffer[2] = {NULL, NULL};
+static size_t attentionBytes[2] = {0, 0};
+static volatile uint8_t attentionPending = 0;     // bit n is set when INTn has been triggered
+static volatile uint8_t attentionRead = 0;        // bit n is set when response of INTn slave is in the buffer
+
+/**
+ * Function that maps slave attention line to an external interrupt on master side.
+ * Falling edge on the interrupt pin schedules a read of numBytes from the slave.
+ ** Library handles interrupt only if SPI_USE_ATTENTION_INT0 or SPI_USE_ATTENTION_INT1 is enabled in AVR_SPI_feature_defines.h.
+ *
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1
+ * @param device slave device that drives the attention line
+ * @param buffer array where slave response is stored
+ * @param numBytes number of bytes that are going to be read from slave
+ */
+void SPI_attentionAttach(uint8_t interrupt, SPI_device_t *device, uint8_t buffer[], size_t numBytes)
+{
+    attentionDevice[interrupt] = device;
+    attentionBuffer[interrupt] = buffer;
+    attentionBytes[interrupt] = numBytes;
+
+    if(interrupt == ATTENTION_INT0)
+    {
+        EXT_INT_CONTROLx = (EXT_INT_CONTROLx & ~(1 << ISC00)) | (1 << ISC01);     // trigger on falling edge
+        EXT_INT_MASKx |= (1 << INT0);
+    }
+
+    else
+    {
+        EXT_INT_CONTROLx = (EXT_INT_CONTROLx & ~(1 << ISC10)) | (1 << ISC11);     // trigger on falling edge
+        EXT_INT_MASKx |= (1 << INT1);
+    }
+}
+
+#if SPI_USE_ATTENTION_INT0
+ISR(INT0_vect)
+{
+    attentionPending |= (1 << ATTENTION_INT0);
+}
+#endif
+
+#if SPI_USE_ATTENTION_INT1
+ISR(INT1_vect)
+{
+    attentionPending |= (1 << ATTENTION_INT1);
+}
+#endif
+
+/**
+ * Function that reads data from all slaves that asserted their attention line, with inter-byte gap of the device.
+ * Call this function from the main loop, so the read never interrupts an SPI transmission that is already in progress.
+ *
+ * @return number of slaves that were read
+ */
+uint8_t SPI_attentionService(void)
+{
+    uint8_t served = 0;
+
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        if(!(attentionPending & (1 << i)) || attentionDevice[i] == NULL)
+            continue;
+
+        uint8_t sreg = SREG;
+        cli();
+        attentionPending &= ~(1 << i);
+        SREG = sreg;
+
+        SPI_deviceReceiveBytes(attentionDevice[i], attentionBuffer[i], attentionBytes[i]);
+
+        attentionRead |= (1 << i);
+        served++;
+    }
+
+    return served;
+}
+
+/**
+ * Function that checks if a response from slave, attached to the interrupt, has been read.
+ *
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1
+ * @return true if new response is available in the buffer; else, return false
+ */
+bool SPI_attentionReceived(uint8_t interrupt)
+{
+    if(attentionRead & (1 << interrupt))
+    {
+        attentionRead &= ~(1 << interrupt);
+        return true;
+    }
+
+    else
+        return false;
+}
+
+/**
+ * Function that checks and clears pending flag of an external interrupt, for drivers that read the slave themselves.
+ * Attach the interrupt with SPI_attentionAttach() and NULL device, so SPI_attentionService() leaves it alone.
+ *
+ * @param interrupt ATTENTION_INT0 or ATTENTION_INT1
+ * @return true if interrupt has been triggered since the last call; else, return false
+ */
+bool SPI_attentionTake(uint8_t interrupt)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    bool pending = attentionPending & (1 << interrupt);
+    attentionPending &= ~(1 << interrupt);
+
+    SREG = sreg;
+
+    return pending;
+}
+
+// slave ready pin
+static volatile uint8_t *readyPORTx = NULL;
+static uint8_t readyPORTxn = 0;
+
+/**
+ * Function that sets up a ready pin on slave side. Ready pin is held low until SPI_slaveReady() is called.
+ *
+ * @param DDRx ready pin DDRx register
+ * @param PORTx ready pin PORTx register
+ * @param PORTxn ready pin PORTxn register
+ */
+void SPI_readyPinInit(volatile uint8_t *DDRx, volatile uint8_t *PORTx, uint8_t PORTxn)
+{
+    *PORTx &= ~(1 << PORTxn);     // slave is not ready yet
+    *DDRx |= (1 << PORTxn);       // set ready pin as output
+
+    readyPORTx = PORTx;
+    readyPORTxn = PORTxn;
+}
+
+/**
+ * Function that signals master that slave has finished initialization. From now on, slave shifts out
+ * [READY_CHAR] whenever it has no queued response, and ready pin (if used) is pulled high.
+ */
+void SPI_slaveReady(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    idleResponse = READY_CHAR;
+
+    if(!responseLoaded)
+        SLAVE_DATA_REGISTER = READY_CHAR;     // preload sentinel for the next master poll
+
+    SREG = sreg;
+
+    if(readyPORTx != NULL)
+        *readyPORTx |= (1 << readyPORTxn);
+}
+
+/**
+ * Function that polls slave with [DUMMY_CHAR] until it responds with [READY_CHAR], with SS line control.
+ * Delay between polls starts at 1ms and doubles up to [READY_BACKOFF_MAX_MS].
+ *
+ * @param device slave device that is polled
+ * @param timeoutMs maximum time to wait for slave, in milliseconds
+ * @return true if slave is ready, false if timeout has expired
+ */
+bool SPI_waitReady(SPI_device_t *device, uint16_t timeoutMs)
+{
+    uint16_t waited = 0;
+    uint8_t backoff = 1;
+
+    while(1)
+    {
+        if(SPI_receiveUint8_t(device->SS_PORTx, device->SS_PORTxn, device->SSmode) == READY_CHAR)
+            return true;
+
+        if(waited >= timeoutMs)
+            return false;
+
+        uint8_t sleep = backoff;
+
+        if(sleep > timeoutMs - waited)
+            sleep = timeoutMs - waited;     // last poll is at timeout, waited can't pass it and overflow
+
+        for(uint8_t i = 0; i < sleep; i++)
+            _delay_ms(1);     // _delay_ms() needs a compile time constant
+
+        waited += sleep;
+
+        if(backoff < READY_BACKOFF_MAX_MS)
+            backoff <<= 1;
+    }
+}
+
+/**
+ * Function that waits until slave ready pin goes high.
+ *
+ * @param PINx ready pin PINx register
+ * @param PINxn ready pin PINxn register
+ * @param timeoutMs maximum time to wait for slave, in milliseconds
+ * @return true if slave is ready, false if timeout has expired
+ */
+bool SPI_waitReadyPin(volatile uint8_t *PINx, uint8_t PINxn, uint16_t timeoutMs)
+{
+    for(uint16_t waited = 0; waited < timeoutMs; waited++)
+    {
+        if(*PINx & (1 << PINxn))
+            return true;
+
+        _delay_ms(1);
+    }
+
+    return (*PINx & (1 << PINxn)) != 0;
+}
+
+#if SPI_USE_CIPHER
+/**
+ * Function that sets cipher state that slave uses to decrypt received messages in ISR routine.
+ * Slave has to be built with SPI_USE_CIPHER enabled.
+ *
+ * @param cipher cipher state, NULL to receive plain messages
+ */
+void SPI_cipherAttach(SPI_cipher_t *cipher)
+{
+    rxCipher = cipher;
+}
+#endif
+
+#if SPI_USE_STATS
+/**
+ * Function that returns a copy of slave statistics.
+ *
+ * @param slaveStats structure where statistics are copied
+ */
+void SPI_getStats(SPI_stats_t *slaveStats)
+{
+    uint8_t sreg = SREG;
+    cli();
+    *slaveStats = stats;
+    SREG = sreg;
+}
+
+/**
+ * Function that enables measuring ISR routine time on slave side, by starting Timer1 with no prescaler.
+ *! Timer1 can't be used by the application for anything but a free running counter.
+ */
+void SPI_statsInit(void)
+{
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);     // normal mode, F_CPU clock, so ISR time is measured in CPU cycles
+}
+#endif
+
+/**
+ * Function that queries statistics block of a slave, with SS line control.
+ * Slave has to be built with SPI_USE_STATS enabled.
+ *
+ * @param device slave device that is queried
+ * @param slaveStats structure where statistics are stored
+ * @return true if statistics block is received, false if slave didn't respond
+ */
+bool SPI_queryStats(SPI_device_t *device, SPI_stats_t *slaveStats)
+{
+    uint8_t block[STATS_LENGTH];
+
+    char query[] = {STATS_QUERY_CHAR, '\0'};
+
+    SPI_deviceTransmitString(device, query);
+    _delay_us(STATS_RESPONSE_DELAY_US);     // give slave ISR routine time to queue the response
+    SPI_deviceReceiveBytes(device, block, STATS_LENGTH);
+
+    bool responded = false;
+
+    for(uint8_t i = 0; i < STATS_LENGTH; i++)
+    {
+        if(block[i] != DUMMY_CHAR && block[i] != READY_CHAR)
+            responded = true;
+    }
+
+    slaveStats->framesReceived = block[0] | (block[1] << 8);
+    slaveStats->overruns = block[2] | (block[3] << 8);
+    slaveStats->maxIsrTicks = block[4] | (block[5] << 8);
+    slaveStats->highWaterMark = block[6];
+
+    return responded;
+}
+
+#if SPI_USE_DISCOVERY
+/**
+ * Function that sets device ID that slave reports when master queries it with [ID_QUERY_CHAR].
+ * Slave has to be built with SPI_USE_DISCOVERY enabled.
+ *! ID must not be 0x00, [DUMMY_CHAR] or [READY_CHAR].
+ *
+ * @param id device ID
+ */
+void SPI_slaveSetID(uint8_t id)
+{
+    deviceID = id;
+}
+#endif
+
+/**
+ * Function that probes every configured SS line with [ID_QUERY_CHAR] and builds a table of populated slaves.
+ * Each probe takes a few tens of microseconds, so absent slaves cost almost nothing.
+ *
+ * @param devices array of configured slave devices, id of every element is updated
+ * @param count number of array elements
+ * @param active array where pointers to populated slave devices are stored, at least count elements
+ * @return number of populated slave devices
+ */
+uint8_t SPI_discover(SPI_device_t devices[], uint8_t count, SPI_device_t *active[])
+{
+    uint8_t populated = 0;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        SPI_device_t *device = &devices[i];
+
+        char query[] = {ID_QUERY_CHAR, '\0'};
+        uint8_t id;
+
+        SPI_deviceTransmitString(device, query);
+        _delay_us(ID_RESPONSE_DELAY_US);     // give slave ISR routine time to queue its ID
+        SPI_deviceReceiveBytes(device, &id, 1);
+
+        // MISO of an absent slave floats to [DUMMY_CHAR] with pull-up, or reads 0x00 with pull-down
+        // [READY_CHAR] means that slave is running, but doesn't support discovery
+        if(id == DUMMY_CHAR || id == 0x00)
+            device->id = 0;
+
+        else
+        {
+            device->id = id;
+            active[populated++] = device;
+        }
+    }
+
+    return populated;
+}
+
+#if SPI_USE_DEDUP
+/**
+ * Function that selects what happens with a message that is identical to the previous message on its channel.
+ * Channel is the first message byte, modulo [DEDUP_CHANNELS]. Default mode is DEDUP_DROP.
+ *
+ * @param mode DEDUP_DROP or DEDUP_FLAG
+ */
+void SPI_dedupSetMode(uint8_t mode)
+{
+    dedupMode = mode;
+}
+
+/**
+ * Function that forgets the last message of every channel, so the next message on each channel is delivered.
+ */
+void SPI_dedupReset(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    for(uint8_t i = 0; i < DEDUP_CHANNELS; i++)
+        dedupLength[i] = 0;
+
+    SREG = sreg;
+}
+
+/**
+ * Function that returns number of repeated messages detected since startup.
+ *
+ * @return number of repeated messages
+ */
+uint16_t SPI_dedupCount(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    uint16_t count = duplicates;
+
+    SREG = sreg;
+
+    return count;
+}
+
+/**
+ * Function that checks if message that was read with the last SPI_readAll() call is a repeated message.
+ * Only DEDUP_FLAG mode passes repeated messages to SPI_readAll().
+ *
+ * @return true if message is identical to the previous message on its channel; else, return false
+ */
+bool SPI_readDuplicate(void)
+{
+    return dataDuplicate;
+}
+#endif
+
+#if SPI_USE_FRAME_POOL
+/**
+ * Function that takes the oldest received message from frame pool. Caller holds one reference
+ * and has to call SPI_frameRelease() when it's done. Slave has to be built with SPI_USE_FRAME_POOL enabled.
+ *
+ * @return received frame, NULL if there is no new message
+ */
+SPI_frame_t *SPI_readFrame(void)
+{
+    SPI_frame_t *frame = NULL;
+
+    uint8_t sreg = SREG;
+    cli();
+
+    if(readyCount > 0)
+    {
+        frame = readyFrames[readyHead];
+        readyHead = (readyHead + 1) % FRAME_POOL_LENGTH;
+        readyCount--;
+    }
+
+    SREG = sreg;
+
+    return frame;
+}
+
+/**
+ * Function that adds a reference to a frame, for handing it to another consumer without copying.
+ *
+ * @param frame received frame
+ */
+void SPI_frameRetain(SPI_frame_t *frame)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    frame->refCount++;
+
+    SREG = sreg;
+}
+
+/**
+ * Function that drops a reference to a frame. Frame is returned to the pool when the last reference is dropped.
+ *
+ * @param frame received frame
+ */
+void SPI_frameRelease(SPI_frame_t *frame)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    if(frame->refCount > 0)
+        frame->refCount--;
+
+    SREG = sreg;
+}
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file AVR_SPI_ws2812.c
+ * @author Lukas Ternjej
+ *
+ * WS2812 LED strip output .c file
+ *
+ * @date 2026-10-18
+ */
+
+#include "AVR_SPI_ws2812.h"
+
+#if SPI_USE_WS2812
+// every pattern starts with 1 and ends with 0, so MOSI stays low between SPI bytes
+const uint8_t WS2812_encodeTable[4] PROGMEM = {
+    0x88,     // 00
+    0x8E,     // 01
+    0xE8,     // 10
+    0xEE,     // 11
+};
+
+/**
+ * Function that encodes a colour byte into SPI bytes, most significant bits first.
+ *
+ * @param colour colour byte
+ * @param encoded array of [WS2812_BYTES_PER_COLOUR] bytes
+ */
+static void SPI_ws2812Encode(uint8_t colour, uint8_t encoded[])
+{
+    for(uint8_t i = 0; i < WS2812_BYTES_PER_COLOUR; i++)
+    {
+        encoded[i] = pgm_read_byte(&WS2812_encodeTable[colour >> 6]);
+        colour <<= 2;
+    }
+}
+
+/**
+ * Function that sends colours to a WS2812 strip and latches them. SPI clock, bit order and SPI mode are set for
+ * the strip and restored afterwards, so the strip can share the bus with other slaves.
+ ** Other slaves' traffic must not reach the strip: gate its data input with a buffer (for example 74HC1G125)
+ ** whose enable pin is the SS line of device, with a pull-down on the strip side, or pass NULL if the strip is alone on MOSI.
+ *! Interrupt routines that take more than ~5us can make the strip latch in the middle of the data!
+ *
+ * @param device gate of the strip data input, NULL if there is none
+ * @param data colour bytes in strip order (G, R, B for WS2812)
+ * @param size number of colour bytes, 3 per LED
+ */
+void SPI_ws2812Show(SPI_device_t *device, const uint8_t data[], uint16_t size)
+{
+    uint8_t encoded[2][WS2812_BYTES_PER_COLOUR];     // colour byte that is shifted out and the next one
+    uint8_t current = 0;
+    uint8_t spcr = SPCR;
+    uint8_t spsr = SPSR;
+
+    if(size == 0)
+        return;
+
+    // MSB first, SPI mode 0 and 4MHz SCK
+    SPCR = (spcr & ~(LSB_FIRST | SPI_MODE_3 | FOSC_MASK)) | MSB_FIRST | SPI_MODE_0 | (WS2812_CLOCK & FOSC_MASK);
+    SPSR = (spsr & ~(1 << SPI2X)) | (WS2812_CLOCK >> 2);
+
+    if(device != NULL)
+        SPI_deviceSelect(device);     // enable strip data input
+
+    SPI_ws2812Encode(data[0], encoded[0]);
+
+    for(uint16_t i = 0; i < size; i++)
+    {
+        uint8_t *out = encoded[current];
+        uint8_t *next = encoded[current ^ 1];
+        uint8_t colour = (i + 1 < size) ? data[i + 1] : 0;
+
+        for(uint8_t n = 0; n < WS2812_BYTES_PER_COLOUR; n++)
+        {
+            // SPDR is written as soon as the previous byte is out, bits of the next colour byte are encoded
+            // while this one is shifted; time between bytes only stretches low time of the last WS2812 bit
+            SPDR = out[n];
+            next[n] = pgm_read_byte(&WS2812_encodeTable[colour >> 6]);
+            colour <<= 2;
+
+            while(!(SPSR & (1 << SPIF)));
+        }
+
+        current ^= 1;
+    }
+
+    _delay_us(WS2812_RESET_US);     // strip latches colours after data input has been low for reset time
+
+    if(device != NULL)
+        SPI_deviceRelease(device);
+
+    SPCR = spcr;
+    SPSR = spsr;
+}
+#endif
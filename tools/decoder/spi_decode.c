@@ -0,0 +1,736 @@
+/**
+ * @file spi_decode.c
+ * @author Lukas Ternjej
+ *
+ * Host decoder of logic analyzer captures of the SPI bus. Capture is a raw sample file, one byte per sample with
+ * one channel per bit (sigrok "binary" output), and is memory mapped. SIMD kernel turns every 64 samples into
+ * level masks of SCK, MOSI, MISO and SS; sampling edges are found with mask arithmetic and bits of a byte are
+ * gathered with PEXT, so samples between edges are never looked at one by one. Bytes are split into messages
+ * as ISR(SPI_STC_vect) does (DATA_END_CHAR ends a message, DUMMY_CHAR before a message is a read), or on SS edges.
+ *
+ * @date 2026-10-18
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+
+#include "AVR_SPI_char_defines.h"
+
+#define DEC_CHUNK_BLOCKS 512     // 64 sample blocks per kernel call, masks of a chunk stay in L1 cache
+#define DEC_NO_CHANNEL   0xFF
+
+/**
+ * Structure that holds level masks of 64 samples, bit n is the channel level in sample n.
+ */
+typedef struct
+{
+    uint64_t sck;
+    uint64_t mosi;
+    uint64_t miso;
+    uint64_t ss;
+} dec_masks_t;
+
+/**
+ * Structure that holds minimum, maximum and sum of a measured value.
+ */
+typedef struct
+{
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+} dec_stat_t;
+
+/**
+ * Structure that holds decoder configuration and state.
+ */
+typedef struct
+{
+    // configuration
+    uint8_t sckBit, mosiBit, misoBit, ssBit;     // channel numbers, DEC_NO_CHANNEL if not captured
+    bool sampleOnRising;                          // SPI modes 0 and 3
+    bool lsbFirst;
+    bool splitOnSs;                               // transactions are messages, for off-the-shelf devices
+    bool verbose;
+    double rate;                                  // samples per second
+
+    // bit level
+    uint8_t bits;                                 // bits of the current byte received so far
+    uint8_t mosiByte, misoByte;
+    uint64_t byteStart;                           // sample of the first bit edge of the current byte
+    uint64_t lastByteEnd;                         // sample of the last bit edge of the previous byte in transaction
+    bool byteInTransaction;
+    uint64_t ssFall, ssRise;
+
+    // message level, as in ISR(SPI_STC_vect)
+    uint8_t message[DATA_LENGTH];
+    uint8_t response[DATA_LENGTH];                // MISO bytes clocked while the message was received
+    uint8_t index;
+    bool overflow;
+    bool escape;                                  // first byte of the message is escaped, see SPI_masterPutFirst()
+    uint64_t messageStart;
+    uint64_t lastMessageEnd;
+
+    // results
+    uint64_t bytes;
+    uint64_t transactions;
+    uint64_t messages;
+    uint64_t dummies;                             // DUMMY_CHAR before a message, master reads
+    uint64_t partialBytes;                        // SS released in the middle of a byte
+    uint64_t overflows;                           // messages longer than DATA_LENGTH - 1, cut as on slave
+    uint64_t bitSamples;                          // samples from the first to the last bit edge of every byte
+    uint64_t selectedSamples;
+    dec_stat_t byteGap;                           // last bit edge to the first bit edge of the next byte
+    dec_stat_t transactionGap;                    // SS rising edge to the next falling edge
+    dec_stat_t messageGap;                        // message end to the first byte of the next message
+    dec_stat_t messageLength;
+} dec_t;
+
+/**
+ * Function that adds a value to statistics.
+ */
+static void dec_statAdd(dec_stat_t *stat, uint64_t value)
+{
+    if(stat->count == 0 || value < stat->min)
+        stat->min = value;
+
+    if(value > stat->max)
+        stat->max = value;
+
+    stat->sum += value;
+    stat->count++;
+}
+
+/**
+ * Function that prints statistics of a time value, in microseconds.
+ */
+static void dec_statPrint(const dec_t *dec, const char *name, const dec_stat_t *stat)
+{
+    double us = 1e6 / dec->rate;
+
+    if(stat->count == 0)
+    {
+        printf("%-22s -\n", name);
+        return;
+    }
+
+    printf("%-22s %-12.3f %-12.3f %-12.3f %lu\n", name, stat->min * us, stat->sum / stat->count * us, stat->max * us,
+           (unsigned long)stat->count);
+}
+
+/**
+ * Function that extracts level masks with scalar code, for the tail of a capture and CPUs without SIMD.
+ *
+ * @param samples first sample of the first block
+ * @param blocks number of 64 sample blocks
+ * @param shift channel number of SCK, MOSI, MISO and SS
+ * @param masks array where masks are stored
+ */
+static void dec_masksScalar(const uint8_t *samples, size_t blocks, const uint8_t shift[4], dec_masks_t masks[])
+{
+    for(size_t b = 0; b < blocks; b++)
+    {
+        uint64_t m[4] = {0, 0, 0, 0};
+
+        for(int i = 0; i < 64; i++)
+        {
+            uint8_t sample = samples[b * 64 + i];
+
+            for(int c = 0; c < 4; c++)
+                m[c] |= (uint64_t)((sample >> shift[c]) & 1) << i;
+        }
+
+        masks[b] = (dec_masks_t){m[0], m[1], m[2], m[3]};
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * Function that extracts level masks with SSE2: channel bit is shifted into bit 7 of every byte and collected
+ * with PMOVMSKB, 16 samples per instruction.
+ */
+__attribute__((target("sse2"))) static void dec_masksSse2(const uint8_t *samples, size_t blocks, const uint8_t shift[4],
+                                                         dec_masks_t masks[])
+{
+    for(size_t b = 0; b < blocks; b++)
+    {
+        __m128i v[4];
+        uint64_t m[4];
+
+        for(int q = 0; q < 4; q++)
+            v[q] = _mm_loadu_si128((const __m128i *)(samples + b * 64 + q * 16));
+
+        for(int c = 0; c < 4; c++)
+        {
+            // 16-bit shift moves bit n of every byte to bit 7, PMOVMSKB only takes bit 7
+            __m128i count = _mm_cvtsi32_si128(7 - shift[c]);
+
+            m[c] = 0;
+
+            for(int q = 0; q < 4; q++)
+                m[c] |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_sll_epi16(v[q], count)) << (q * 16);
+        }
+
+        masks[b] = (dec_masks_t){m[0], m[1], m[2], m[3]};
+    }
+}
+
+/**
+ * Function that extracts level masks with AVX2, 32 samples per instruction.
+ */
+__attribute__((target("avx2"))) static void dec_masksAvx2(const uint8_t *samples, size_t blocks, const uint8_t shift[4],
+                                                         dec_masks_t masks[])
+{
+    for(size_t b = 0; b < blocks; b++)
+    {
+        __m256i low = _mm256_loadu_si256((const __m256i *)(samples + b * 64));
+        __m256i high = _mm256_loadu_si256((const __m256i *)(samples + b * 64 + 32));
+        uint64_t m[4];
+
+        for(int c = 0; c < 4; c++)
+        {
+            __m128i count = _mm_cvtsi32_si128(7 - shift[c]);
+            uint32_t l = _mm256_movemask_epi8(_mm256_sll_epi16(low, count));
+            uint32_t h = _mm256_movemask_epi8(_mm256_sll_epi16(high, count));
+
+            m[c] = l | ((uint64_t)h << 32);
+        }
+
+        masks[b] = (dec_masks_t){m[0], m[1], m[2], m[3]};
+    }
+}
+#endif
+
+/**
+ * Function that gathers the bits of value at set bits of mask into the low bits of the result.
+ */
+static inline uint64_t dec_pext(uint64_t value, uint64_t mask)
+{
+#ifdef __BMI2__
+    return _pext_u64(value, mask);
+#else
+    uint64_t result = 0;
+
+    for(int n = 0; mask != 0; n++)
+    {
+        result |= ((value >> __builtin_ctzll(mask)) & 1) << n;
+        mask &= mask - 1;
+    }
+
+    return result;
+#endif
+}
+
+/**
+ * Function that returns the lowest count set bits of mask.
+ */
+static inline uint64_t dec_lowestBits(uint64_t mask, int count)
+{
+#ifdef __BMI2__
+    return _pdep_u64((1ULL << count) - 1, mask);
+#else
+    uint64_t result = 0;
+
+    for(int n = 0; n < count; n++)
+    {
+        result |= mask & -mask;
+        mask &= mask - 1;
+    }
+
+    return result;
+#endif
+}
+
+/**
+ * Function that reverses bit order of a byte.
+ */
+static inline uint8_t dec_reverse(uint8_t data)
+{
+    data = (data >> 4) | (data << 4);
+    data = ((data & 0xCC) >> 2) | ((data & 0x33) << 2);
+
+    return ((data & 0xAA) >> 1) | ((data & 0x55) << 1);
+}
+
+/**
+ * Function that prints a message or transaction: time, MOSI bytes and MISO bytes.
+ */
+static void dec_printFrame(const dec_t *dec, const char *kind, uint64_t start, size_t length)
+{
+    printf("%14.3f us  %-6s %3zu  mosi", start * 1e6 / dec->rate, kind, length);
+
+    for(size_t i = 0; i < length && i < DATA_LENGTH; i++)
+        printf(" %02X", dec->message[i]);
+
+    printf("  miso");
+
+    for(size_t i = 0; i < length && i < DATA_LENGTH; i++)
+        printf(" %02X", dec->response[i]);
+
+    printf("\n");
+}
+
+/**
+ * Function that ends a message or transaction.
+ */
+static void dec_frameEnd(dec_t *dec, const char *kind, uint64_t end)
+{
+    if(dec->verbose)
+        dec_printFrame(dec, kind, dec->messageStart, dec->index);
+
+    if(dec->messages > 0)
+        dec_statAdd(&dec->messageGap, dec->messageStart - dec->lastMessageEnd);
+
+    dec_statAdd(&dec->messageLength, dec->index);
+
+    if(dec->overflow)
+        dec->overflows++;
+
+    dec->messages++;
+    dec->lastMessageEnd = end;
+    dec->index = 0;
+    dec->overflow = false;
+}
+
+/**
+ * Function that handles a received byte the way ISR(SPI_STC_vect) does.
+ *
+ * @param dec decoder state
+ * @param end sample of the last bit edge of the byte
+ */
+static void dec_byte(dec_t *dec, uint64_t end)
+{
+    uint8_t mosi = dec->mosiByte;
+    uint8_t miso = dec->misoByte;
+
+    if(!dec->lsbFirst)
+    {
+        // bits were gathered in arrival order, the first bit is MSB
+        mosi = dec_reverse(mosi);
+        miso = dec_reverse(miso);
+    }
+
+    dec->bytes++;
+    dec->bitSamples += end - dec->byteStart;
+
+    if(dec->byteInTransaction)
+        dec_statAdd(&dec->byteGap, dec->byteStart - dec->lastByteEnd);
+
+    dec->byteInTransaction = true;
+    dec->lastByteEnd = end;
+
+    if(dec->splitOnSs)
+    {
+        if(dec->index == 0)
+            dec->messageStart = dec->byteStart;
+
+        if(dec->index < DATA_LENGTH)
+        {
+            dec->message[dec->index] = mosi;
+            dec->response[dec->index] = miso;
+            dec->index++;
+        }
+
+        else
+            dec->overflow = true;
+
+        return;
+    }
+
+    // master generates SCK with [DUMMY_CHAR] when reading, it isn't the start of a new message
+    if(mosi == DUMMY_CHAR && dec->index == 0)
+    {
+        dec->dummies++;
+        return;
+    }
+
+    if(dec->index == 0 && !dec->escape)
+        dec->messageStart = dec->byteStart;
+
+    // master escapes the first byte of a message if it equals [DUMMY_CHAR] or [ESCAPE_CHAR]
+    if(dec->escape)
+    {
+        dec->escape = false;
+
+        if(mosi != DATA_END_CHAR)
+            mosi ^= ESCAPE_XOR;
+    }
+
+    else if(mosi == ESCAPE_CHAR && dec->index == 0)
+    {
+        dec->escape = true;
+        return;
+    }
+
+    if(mosi == DATA_END_CHAR)
+    {
+        dec_frameEnd(dec, "msg", end);
+        return;
+    }
+
+    // slave keeps space for [DATA_END_CHAR], bytes that don't fit are dropped
+    if(dec->index < DATA_LENGTH - 1)
+    {
+        dec->message[dec->index] = mosi;
+        dec->response[dec->index] = miso;
+        dec->index++;
+    }
+
+    else
+        dec->overflow = true;
+}
+
+/**
+ * Function that shifts in the bits sampled at edges of a block.
+ *
+ * @param dec decoder state
+ * @param base sample number of bit 0 of the masks
+ * @param edges sampling edges while SS is low
+ * @param mosi MOSI levels
+ * @param miso MISO levels
+ */
+static inline void dec_bits(dec_t *dec, uint64_t base, uint64_t edges, uint64_t mosi, uint64_t miso)
+{
+    while(edges != 0)
+    {
+        int need = 8 - dec->bits;
+        int available = __builtin_popcountll(edges);
+
+        if(dec->bits == 0)
+            dec->byteStart = base + __builtin_ctzll(edges);
+
+        if(available < need)
+        {
+            dec->mosiByte |= dec_pext(mosi, edges) << dec->bits;
+            dec->misoByte |= dec_pext(miso, edges) << dec->bits;
+            dec->bits += available;
+            return;
+        }
+
+        // edges that complete the byte
+        uint64_t take = dec_lowestBits(edges, need);
+
+        dec->mosiByte |= dec_pext(mosi, take) << dec->bits;
+        dec->misoByte |= dec_pext(miso, take) << dec->bits;
+        dec_byte(dec, base + 63 - __builtin_clzll(take));
+
+        dec->bits = 0;
+        dec->mosiByte = 0;
+        dec->misoByte = 0;
+        edges &= ~take;
+    }
+}
+
+/**
+ * Function that handles an SS edge. SPI hardware of the slave resets its bit counter while SS is high.
+ */
+static void dec_ss(dec_t *dec, uint64_t sample, bool selected)
+{
+    if(selected)
+    {
+        if(dec->transactions > 0)
+            dec_statAdd(&dec->transactionGap, sample - dec->ssRise);
+
+        dec->ssFall = sample;
+        dec->transactions++;
+        dec->byteInTransaction = false;
+        return;
+    }
+
+    if(dec->transactions == 0)
+        return;     // capture started while SS was low
+
+    if(dec->bits != 0)
+        dec->partialBytes++;
+
+    dec->bits = 0;
+    dec->mosiByte = 0;
+    dec->misoByte = 0;
+    dec->ssRise = sample;
+    dec->selectedSamples += sample - dec->ssFall;
+
+    if(dec->splitOnSs && dec->index > 0)
+        dec_frameEnd(dec, "txn", sample);
+}
+
+/**
+ * Function that decodes a chunk of level masks.
+ *
+ * @param dec decoder state
+ * @param base sample number of the first block
+ * @param masks level masks
+ * @param blocks number of blocks
+ * @param previous levels of the last sample before the chunk, in the same layout as masks
+ */
+static void dec_chunk(dec_t *dec, uint64_t base, const dec_masks_t masks[], size_t blocks, dec_masks_t *previous)
+{
+    bool hasSs = dec->ssBit != DEC_NO_CHANNEL;
+    bool hasMiso = dec->misoBit != DEC_NO_CHANNEL;
+
+    for(size_t b = 0; b < blocks; b++, base += 64)
+    {
+        const dec_masks_t *m = &masks[b];
+        uint64_t miso = hasMiso ? m->miso : ~0ULL;     // MISO that isn't captured reads as pulled up
+
+        // bit n of the shifted mask is the level of sample n - 1
+        uint64_t sckBefore = (m->sck << 1) | (previous->sck >> 63);
+        uint64_t ssBefore = (m->ss << 1) | (previous->ss >> 63);
+        uint64_t edges = dec->sampleOnRising ? (m->sck & ~sckBefore) : (~m->sck & sckBefore);
+        uint64_t ssEdges = hasSs ? (m->ss ^ ssBefore) : 0;
+        uint64_t selected = hasSs ? ~m->ss : ~0ULL;
+
+        *previous = *m;
+
+        if(ssEdges == 0)
+        {
+            if(selected != 0 && edges != 0)
+                dec_bits(dec, base, edges, m->mosi, miso);
+
+            continue;
+        }
+
+        // SS edges split the block, edges before every SS edge are decoded first
+        edges &= selected;
+
+        while(ssEdges != 0)
+        {
+            int position = __builtin_ctzll(ssEdges);
+            uint64_t before = (position == 0) ? 0 : (~0ULL >> (64 - position));
+
+            dec_bits(dec, base, edges & before, m->mosi, miso);
+            edges &= ~before;
+            dec_ss(dec, base + position, !((m->ss >> position) & 1));
+            ssEdges &= ssEdges - 1;
+        }
+
+        dec_bits(dec, base, edges, m->mosi, miso);
+    }
+}
+
+/**
+ * Function that parses a comma separated list of 4 channel numbers, "-" for a channel that isn't captured.
+ */
+static bool dec_parseChannels(const char *list, uint8_t channels[4])
+{
+    char copy[64];
+    char *save = NULL;
+    int count = 0;
+
+    snprintf(copy, sizeof(copy), "%s", list);
+
+    for(char *token = strtok_r(copy, ",", &save); token != NULL && count < 4; token = strtok_r(NULL, ",", &save))
+    {
+        if(strcmp(token, "-") == 0)
+            channels[count++] = DEC_NO_CHANNEL;
+
+        else
+        {
+            int channel = atoi(token);
+
+            if(channel < 0 || channel > 7)
+                return false;
+
+            channels[count++] = channel;
+        }
+    }
+
+    return count == 4 && channels[0] != DEC_NO_CHANNEL && channels[1] != DEC_NO_CHANNEL;
+}
+
+int main(int argc, char *argv[])
+{
+    dec_t *dec = calloc(1, sizeof(dec_t));
+    uint8_t channels[4] = {0, 1, 2, 3};     // SCK, MOSI, MISO, SS
+    int mode = 0;
+    int option;
+    const char *simd = "auto";
+
+    dec->rate = 24e6;
+
+    while((option = getopt(argc, argv, "c:r:m:lsvk:")) != -1)
+    {
+        switch(option)
+        {
+        case 'c':
+            if(!dec_parseChannels(optarg, channels))
+            {
+                fprintf(stderr, "channels are sck,mosi,miso,ss, 0 - 7; miso and ss can be -\n");
+                return 1;
+            }
+            break;
+        case 'r':
+            dec->rate = atof(optarg);
+            break;
+        case 'm':
+            mode = atoi(optarg) & 3;
+            break;
+        case 'l':
+            dec->lsbFirst = true;
+            break;
+        case 's':
+            dec->splitOnSs = true;
+            break;
+        case 'v':
+            dec->verbose = true;
+            break;
+        case 'k':
+            simd = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c sck,mosi,miso,ss] [-r samplerate] [-m spi_mode] [-l] [-s] [-v] [-k auto|avx2|sse2|scalar] capture.bin\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if(optind >= argc || dec->rate <= 0)
+    {
+        fprintf(stderr, "usage: %s [-c sck,mosi,miso,ss] [-r samplerate] [-m spi_mode] [-l] [-s] [-v] [-k auto|avx2|sse2|scalar] capture.bin\n",
+                argv[0]);
+        return 1;
+    }
+
+    dec->sckBit = channels[0];
+    dec->mosiBit = channels[1];
+    dec->misoBit = channels[2];
+    dec->ssBit = channels[3];
+    dec->sampleOnRising = (mode == 0 || mode == 3);     // CPOL xor CPHA selects the falling edge
+
+    // kernel extracts all 4 masks, masks of channels that aren't captured are ignored by dec_chunk()
+    uint8_t shift[4];
+
+    for(int c = 0; c < 4; c++)
+        shift[c] = (channels[c] != DEC_NO_CHANNEL) ? channels[c] : 0;
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat info;
+
+    if(fd < 0 || fstat(fd, &info) != 0)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    size_t length = info.st_size;
+    const uint8_t *samples = NULL;
+
+    if(length > 0)
+    {
+        samples = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if(samples == MAP_FAILED)
+        {
+            perror("mmap");
+            return 1;
+        }
+
+        madvise((void *)samples, length, MADV_SEQUENTIAL);
+    }
+
+    void (*kernel)(const uint8_t *, size_t, const uint8_t[4], dec_masks_t[]) = dec_masksScalar;
+    const char *kernelName = "scalar";
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    if((strcmp(simd, "auto") == 0 && __builtin_cpu_supports("avx2")) || strcmp(simd, "avx2") == 0)
+    {
+        kernel = dec_masksAvx2;
+        kernelName = "avx2";
+    }
+
+    else if(strcmp(simd, "scalar") != 0)
+    {
+        kernel = dec_masksSse2;
+        kernelName = "sse2";
+    }
+#endif
+
+    static dec_masks_t masks[DEC_CHUNK_BLOCKS];
+    size_t blocks = length / 64;
+    dec_masks_t previous;
+    struct timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // levels before the first sample are the levels of the first sample, so it isn't an edge
+    if(length > 0)
+    {
+        previous.sck = (uint64_t)((samples[0] >> shift[0]) & 1) << 63;
+        previous.ss = (uint64_t)((samples[0] >> shift[3]) & 1) << 63;
+    }
+
+    for(size_t b = 0; b < blocks; b += DEC_CHUNK_BLOCKS)
+    {
+        size_t count = (blocks - b < DEC_CHUNK_BLOCKS) ? blocks - b : DEC_CHUNK_BLOCKS;
+
+        kernel(samples + b * 64, count, shift, masks);
+        dec_chunk(dec, b * 64, masks, count, &previous);
+    }
+
+    // tail of the capture is padded with its last sample
+    if(length % 64 != 0)
+    {
+        uint8_t tail[64];
+        size_t rest = length % 64;
+
+        memcpy(tail, samples + blocks * 64, rest);
+        memset(tail + rest, samples[length - 1], 64 - rest);
+        dec_masksScalar(tail, 1, shift, masks);
+        dec_chunk(dec, blocks * 64, masks, 1, &previous);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    double captured = length / dec->rate;
+
+    if(dec->ssBit == DEC_NO_CHANNEL)
+        dec->selectedSamples = length;     // slave is always selected
+
+    printf("\n%zu samples (%.1f MB), %.3f s at %.0f Hz, decoded in %.3f s with %s kernel: %.2f GB/s\n", length, length / 1e6,
+           captured, dec->rate, seconds, kernelName, seconds > 0 ? length / seconds / 1e9 : 0);
+    printf("transactions %lu, bytes %lu, %s %lu, dummy reads %lu, partial bytes %lu, overflows %lu\n",
+           (unsigned long)dec->transactions, (unsigned long)dec->bytes, dec->splitOnSs ? "frames" : "messages",
+           (unsigned long)dec->messages, (unsigned long)dec->dummies, (unsigned long)dec->partialBytes,
+           (unsigned long)dec->overflows);
+
+    if(dec->bytes > 0)
+    {
+        printf("SCK %.3f MHz (bit time), %.1f bytes/s, %.1f %s/s, SS low %.2f%% of capture\n",
+               7.0 * dec->bytes / dec->bitSamples * dec->rate / 1e6, dec->bytes / captured, dec->messages / captured,
+               dec->splitOnSs ? "frames" : "messages", 100.0 * dec->selectedSamples / length);
+    }
+
+    printf("\n%-22s %-12s %-12s %-12s %s\n", "us", "min", "mean", "max", "count");
+    dec_statPrint(dec, "byte gap", &dec->byteGap);
+    dec_statPrint(dec, "transaction gap", &dec->transactionGap);
+    dec_statPrint(dec, "message gap", &dec->messageGap);
+
+    if(dec->messageLength.count > 0)
+        printf("%-22s %-12lu %-12.1f %-12lu\n", "message length, bytes", (unsigned long)dec->messageLength.min,
+               dec->messageLength.sum / dec->messageLength.count, (unsigned long)dec->messageLength.max);
+
+    if(samples != NULL)
+        munmap((void *)samples, length);
+
+    close(fd);
+    free(dec);
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file fake_spidev.cpp
+ * @author Lukas Ternjej
+ *
+ * Fake spidev device backed by the simulated slave .cpp file
+ *
+ * @date 2026-10-18
+ */
+
+#include "fake_spidev.hpp"
+
+#include <cerrno>
+#include <sys/ioctl.h>
+
+extern "C"
+{
+    // slave library and simulator register shim
+    extern volatile uint8_t SPCR;
+    extern volatile uint8_t sim_SPDR;
+    void SPI_STC_vect(void);
+}
+
+#define FAKE_DORD 5     // SPCR data order bit
+
+/**
+ * Constructor of the fake device. Slave has to be initialized with SPI_init() in SLAVE_MODE.
+ *
+ * @param slaveIsrUs slave time per SPI_STC_vect, including interrupt entry and exit
+ */
+FakeSpidev::FakeSpidev(double slaveIsrUs) : slaveIsrUs(slaveIsrUs)
+{
+}
+
+/**
+ * Function that reverses bit order of a byte.
+ */
+static uint8_t fake_reverse(uint8_t data)
+{
+    data = (data >> 4) | (data << 4);
+    data = ((data & 0xCC) >> 2) | ((data & 0x33) << 2);
+
+    return ((data & 0xAA) >> 1) | ((data & 0x55) << 1);
+}
+
+/**
+ * Function that clocks a byte through the slave.
+ *
+ * @param mosi byte that master shifts out
+ * @param speedHz SCK rate of the transfer
+ * @return byte that slave shifted out
+ */
+uint8_t FakeSpidev::exchange(uint8_t mosi, uint32_t speedHz)
+{
+    // bit order mismatch between master and slave reverses every byte on the wire
+    bool reversed = (lsbFirst != 0) != ((SPCR >> FAKE_DORD) & 1);
+    uint8_t miso = sim_SPDR;
+
+    nowUs += 8e6 / speedHz;
+    bytes++;
+
+    if(isrFreeUs > nowUs)
+    {
+        bytesLost++;     // slave is still handling the previous byte, this one is overwritten
+        return reversed ? fake_reverse(miso) : miso;
+    }
+
+    sim_SPDR = reversed ? fake_reverse(mosi) : mosi;
+    SPI_STC_vect();
+    isrFreeUs = nowUs + slaveIsrUs;
+
+    return reversed ? fake_reverse(miso) : miso;
+}
+
+/**
+ * Function that runs an SPI_IOC_MESSAGE: transfers are clocked back to back with chip select asserted.
+ */
+int FakeSpidev::message(const spi_ioc_transfer transfers[], size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        const spi_ioc_transfer &t = transfers[i];
+        const uint8_t *tx = reinterpret_cast<const uint8_t *>(static_cast<uintptr_t>(t.tx_buf));
+        uint8_t *rx = reinterpret_cast<uint8_t *>(static_cast<uintptr_t>(t.rx_buf));
+        uint32_t speed = (t.speed_hz != 0) ? t.speed_hz : speedHz;
+
+        if((t.bits_per_word != 0 && t.bits_per_word != 8) || speed == 0)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+        for(uint32_t n = 0; n < t.len; n++)
+        {
+            uint8_t miso = exchange(tx != nullptr ? tx[n] : 0, speed);
+
+            if(rx != nullptr)
+                rx[n] = miso;
+
+            if(n + 1 < t.len)
+                nowUs += t.word_delay_usecs;
+        }
+
+        nowUs += t.delay_usecs;
+    }
+
+    messages++;
+
+    if(slaveLoop)
+        slaveLoop();
+
+    return static_cast<int>(count);
+}
+
+int FakeSpidev::ioctl(unsigned long request, void *argument)
+{
+    ioctls++;
+
+    if(_IOC_TYPE(request) != SPI_IOC_MAGIC)
+    {
+        errno = ENOTTY;
+        return -1;
+    }
+
+    if(request == SPI_IOC_WR_MODE || request == SPI_IOC_WR_BITS_PER_WORD)
+    {
+        // clock phase isn't modelled, slave only supports 8-bit words
+        uint8_t value = *static_cast<uint8_t *>(argument);
+
+        if((request == SPI_IOC_WR_MODE && value > SPI_MODE_3) || (request == SPI_IOC_WR_BITS_PER_WORD && value != 8))
+        {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    else if(request == SPI_IOC_WR_LSB_FIRST)
+        lsbFirst = *static_cast<uint8_t *>(argument);
+
+    else if(request == SPI_IOC_WR_MAX_SPEED_HZ)
+        speedHz = *static_cast<uint32_t *>(argument);
+
+    else if(_IOC_NR(request) == 0 && _IOC_DIR(request) == _IOC_WRITE)
+    {
+        size_t size = _IOC_SIZE(request);
+
+        if(size == 0 || size % sizeof(spi_ioc_transfer) != 0)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+        return message(static_cast<const spi_ioc_transfer *>(argument), size / sizeof(spi_ioc_transfer));
+    }
+
+    else
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return 0;
+}
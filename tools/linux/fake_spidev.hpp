@@ -0,0 +1,53 @@
+/**
+ * @file fake_spidev.hpp
+ * @author Lukas Ternjej
+ *
+ * Header file for a fake spidev device backed by the simulated slave. The real slave library is linked in with the
+ * simulator register shim (tools/simulator/shim); every byte of an SPI_IOC_MESSAGE is written to the slave SPDR and
+ * handled by its SPI_STC_vect, and the byte that was in SPDR goes back on MISO. Transfers run on a virtual clock:
+ * a byte that arrives while the slave ISR routine is still handling the previous one is lost, as on AVR.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef FAKE_SPIDEV_HPP_
+#define FAKE_SPIDEV_HPP_
+
+#include <functional>
+
+#include "spi_master.hpp"
+
+/**
+ * Spidev device with a single simulated slave on its chip select.
+ */
+class FakeSpidev : public SpiDevice
+{
+public:
+    /**
+     * Constructor of the fake device. Slave has to be initialized with SPI_init() in SLAVE_MODE.
+     *
+     * @param slaveIsrUs slave time per SPI_STC_vect, including interrupt entry and exit
+     */
+    explicit FakeSpidev(double slaveIsrUs = 60 / 16.0);
+
+    int ioctl(unsigned long request, void *argument) override;
+
+    std::function<void()> slaveLoop;     // slave main loop, run after every SPI_IOC_MESSAGE
+
+    uint32_t ioctls = 0;                 // all ioctl calls
+    uint32_t messages = 0;               // SPI_IOC_MESSAGE calls, every one is a chip select assertion
+    uint64_t bytes = 0;
+    uint32_t bytesLost = 0;              // bytes that arrived while slave ISR routine was busy
+    double nowUs = 0;                    // virtual clock
+
+private:
+    double slaveIsrUs;
+    double isrFreeUs = 0;                // virtual time when slave finishes its ISR routine
+    uint8_t lsbFirst = 0;
+    uint32_t speedHz = 500000;
+
+    int message(const spi_ioc_transfer transfers[], size_t count);
+    uint8_t exchange(uint8_t mosi, uint32_t speedHz);
+};
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file master_test.cpp
+ * @author Lukas Ternjej
+ *
+ * Host test of the Linux userspace master (spi_master.cpp) against a fake spidev device backed by the real slave library.
+ * Master sends random strings, hex numbers and single bytes, and reads queued responses; every message is checked in
+ * slave SPI_data[] after SPI_readAll(). System calls per frame are compared with a master that issues one ioctl per byte,
+ * and byte loss at an SCK rate that is too fast for the slave ISR routine is shown with and without byte gap.
+ *
+ * @date 2026-10-18
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <string>
+
+#include "fake_spidev.hpp"
+#include "spi_master.hpp"
+
+// slave library, built for the simulator register shim; AVR_SPI_with_interrupts.h can't be included next to
+// linux/spi/spidev.h, both define SPI_MODE_0 - SPI_MODE_3
+extern "C"
+{
+    void SPI_init(uint8_t deviceMode, uint8_t dataOrder, uint8_t SPIMode, uint8_t clockRate);
+    bool SPI_readAll(void);
+    bool SPI_queueResponse(uint8_t data[], size_t size);
+    uint64_t hexArrayToUint64_t(uint8_t array[], size_t size);
+}
+
+#define SLAVE_MODE 0     // values of AVR_SPI_with_interrupts.h
+#define MSB_FIRST  0x00
+#define FOSC_DIV4  0x00
+
+/**
+ * Structure that holds slave side of the test.
+ */
+struct TestSlave
+{
+    std::string expected;          // message that master has sent
+    size_t expectedLength = 0;
+    bool pending = false;          // message hasn't been read by slave yet
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    uint8_t response[4] = {'I', 'D', '4', '2'};
+};
+
+static TestSlave slave;
+
+/**
+ * Function that is the slave main loop: reads a message, checks it and answers "ID?" with a queued response.
+ */
+static void test_slaveLoop()
+{
+    if(!SPI_readAll())
+        return;
+
+    slave.received++;
+
+    if(!slave.pending || memcmp(SPI_data, slave.expected.data(), slave.expectedLength) != 0 || SPI_data[slave.expectedLength] != 0)
+        slave.errors++;
+
+    slave.pending = false;
+
+    if(slave.expected == "ID?")
+        SPI_queueResponse(slave.response, sizeof(slave.response));
+}
+
+/**
+ * Function that sets the message that slave expects next.
+ */
+static void test_expect(const std::string &message)
+{
+    slave.expected = message;
+    slave.expectedLength = message.size();
+    slave.pending = true;
+}
+
+/**
+ * Function that sends random strings, returns number of messages that slave didn't receive intact.
+ */
+static uint32_t test_strings(SpiMaster &master, uint32_t count)
+{
+    uint32_t errors = slave.errors;
+    uint32_t received = slave.received;
+
+    for(uint32_t n = 0; n < count; n++)
+    {
+        std::string message;
+        size_t length = 1 + rand() % (DATA_LENGTH - 2);
+
+        for(size_t i = 0; i < length; i++)
+            message += static_cast<char>(' ' + rand() % 95);
+
+        test_expect(message);
+        master.transmitString(message);
+    }
+
+    return (slave.errors - errors) + (count - (slave.received - received));
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t count = 2000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            count = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n messages]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SPI_init(SLAVE_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+
+    FakeSpidev device;
+    device.slaveLoop = test_slaveLoop;
+
+    SpiMaster master(device, 1000000);     // 1MHz, a byte is longer than slave ISR routine
+    uint32_t failures = 0;
+
+    srand(1);
+
+    // strings, hex numbers and single bytes with DATA_END_CHAR framing
+    uint32_t ioctls = device.ioctls;
+    uint64_t bytes = device.bytes;
+    uint32_t stringErrors = test_strings(master, count);
+    uint32_t stringIoctls = device.ioctls - ioctls;
+    double ioctlsPerFrame = (double)stringIoctls / count;
+    double bytesPerFrame = (double)(device.bytes - bytes) / count;
+
+    failures += stringErrors;
+
+    test_expect(std::string("\x12\x34\x56\x78", 4));
+    master.transmitHex(4, 0x12345678);
+
+    if(hexArrayToUint64_t(SPI_data, 4) != 0x12345678)
+        failures++;
+
+    test_expect("A");
+    master.transmitUint8_t('A');
+
+    // first bytes that slave would take for a read or an escape are escaped
+    uint32_t received = slave.received;
+
+    test_expect(std::string("\xFF\x12", 2));
+    master.transmitHex(2, 0xFF12);
+
+    if(hexArrayToUint64_t(SPI_data, 2) != 0xFF12)
+        failures++;
+
+    test_expect("\xFF");
+    master.transmitUint8_t(DUMMY_CHAR);
+
+    test_expect("\x1B" "A");
+    master.transmitString("\x1B" "A");
+
+    if(slave.received - received != 3)
+        failures++;
+
+    // query with queued response, read byte by byte and as a block
+    uint8_t response[4];
+
+    test_expect("ID?");
+    master.transmitString("ID?");
+    response[0] = master.receiveUint8_t();
+    master.receiveBytes(&response[1], 3);
+
+    if(memcmp(response, slave.response, 4) != 0)
+        failures++;
+
+    failures += slave.errors;
+
+    printf("%u random strings: %u errors, %.2f ioctl and %.1f bytes per frame\n", count, stringErrors, ioctlsPerFrame,
+           bytesPerFrame);
+    printf("hex, byte and query/response: %s\n", failures == stringErrors ? "ok" : "failed");
+
+    // the same frames from a master that issues one ioctl per byte
+    uint32_t perByteIoctls = 0;
+    srand(1);
+
+    for(uint32_t n = 0; n < count; n++)
+    {
+        size_t length = 1 + rand() % (DATA_LENGTH - 2);
+
+        for(size_t i = 0; i < length; i++)
+            rand();
+
+        perByteIoctls += length + 1;
+    }
+
+    printf("one ioctl per byte: %.2f ioctls per frame, %.1fx more system calls\n\n", (double)perByteIoctls / count,
+           (double)perByteIoctls / stringIoctls);
+
+    // SCK at F_CPU/4 of the slave: 2us bytes, slave ISR routine takes 3.75us
+    printf("SCK      byte_gap_us  frames  bytes_lost  received  frame_us\n");
+
+    for(uint16_t gap : {0, 2})
+    {
+        FakeSpidev fast;
+        fast.slaveLoop = test_slaveLoop;
+
+        SpiMaster fastMaster(fast, 4000000, SPI_MODE_0, false, gap);
+        uint32_t frames = count / 4;
+
+        // empty message ends a message that lost its DATA_END_CHAR in the previous run
+        slave.pending = false;
+        fastMaster.transmitString("");
+        slave.errors = 0;
+
+        uint32_t received = slave.received;
+        uint32_t errors = test_strings(fastMaster, frames);
+
+        printf("4MHz     %-12u %-7u %-11u %-9u %.1f\n", gap, frames, fast.bytesLost, slave.received - received,
+               fast.nowUs / frames);
+
+        if(gap != 0)
+            failures += errors;
+    }
+
+    if(failures != 0)
+        printf("\n%u failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file spi_master.cpp
+ * @author Lukas Ternjej
+ *
+ * Linux userspace master of the library protocol .cpp file
+ *
+ * @date 2026-10-18
+ */
+
+#include "spi_master.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <system_error>
+#include <unistd.h>
+
+/**
+ * Constructor that opens the device file.
+ *! Throws std::system_error if the file can't be opened.
+ *
+ * @param path device file, for example "/dev/spidev0.0"
+ */
+Spidev::Spidev(const std::string &path)
+{
+    fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+}
+
+Spidev::~Spidev()
+{
+    close(fd);
+}
+
+int Spidev::ioctl(unsigned long request, void *argument)
+{
+    return ::ioctl(fd, request, argument);
+}
+
+/**
+ * Constructor that configures SPI mode, bit order, 8-bit words and SCK rate of the device.
+ *! Throws std::system_error if the device rejects the configuration.
+ *
+ * @param device spidev device
+ * @param speedHz SCK rate
+ * @param mode SPI_MODE_0 - SPI_MODE_3
+ * @param lsbFirst true for LSB_FIRST data order
+ * @param byteGapUs gap after every byte, for slaves whose ISR routine is longer than a byte at speedHz; 0 for none
+ */
+SpiMaster::SpiMaster(SpiDevice &device, uint32_t speedHz, uint8_t mode, bool lsbFirst, uint16_t byteGapUs)
+    : device(device), speedHz(speedHz), byteGapUs(byteGapUs)
+{
+    uint8_t bits = 8;
+    uint8_t lsb = lsbFirst;
+
+    configure(SPI_IOC_WR_MODE, &mode);
+    configure(SPI_IOC_WR_LSB_FIRST, &lsb);
+    configure(SPI_IOC_WR_BITS_PER_WORD, &bits);
+    configure(SPI_IOC_WR_MAX_SPEED_HZ, &speedHz);
+
+    txBuffer.reserve(DATA_LENGTH);
+}
+
+/**
+ * Function that writes a configuration value, throws std::system_error if it fails.
+ */
+void SpiMaster::configure(unsigned long request, void *argument)
+{
+    if(device.ioctl(request, argument) < 0)
+        throw std::system_error(errno, std::generic_category(), "spidev configuration");
+}
+
+/**
+ * Function that appends the first byte of a message to txBuffer, escaped as in SPI_masterPutFirst(): slave ignores
+ * [DUMMY_CHAR] at the start of a message, so [DUMMY_CHAR] and [ESCAPE_CHAR] are sent as [ESCAPE_CHAR], byte ^ [ESCAPE_XOR].
+ */
+void SpiMaster::pushFirst(uint8_t data)
+{
+    if(data == DUMMY_CHAR || data == ESCAPE_CHAR)
+    {
+        txBuffer.push_back(ESCAPE_CHAR);
+        data ^= ESCAPE_XOR;
+    }
+
+    txBuffer.push_back(data);
+}
+
+/**
+ * Function that clocks txBuffer out in a single SPI_IOC_MESSAGE, so chip select stays asserted for the whole frame.
+ * Without byte gap the frame is a single transfer; with byte gap every byte is a transfer with delay_usecs, which works
+ * on every kernel and controller (word_delay_usecs needs Linux 5.3 and controller support).
+ *
+ * @param rxData array where received bytes are stored, nullptr if they aren't needed
+ * @param numBytes number of bytes in txBuffer
+ */
+void SpiMaster::transfer(uint8_t rxData[], size_t numBytes)
+{
+    size_t count = (byteGapUs != 0) ? numBytes : 1;
+
+    if(numBytes == 0)
+        return;
+
+    if(count > maxTransfers)
+        throw std::length_error("frame has more bytes than transfers fit in one SPI_IOC_MESSAGE");
+
+    transfers.assign(count, spi_ioc_transfer{});
+
+    for(size_t i = 0; i < count; i++)
+    {
+        spi_ioc_transfer &t = transfers[i];
+        size_t offset = (count == 1) ? 0 : i;
+
+        t.tx_buf = reinterpret_cast<uintptr_t>(txBuffer.data() + offset);
+        t.rx_buf = (rxData != nullptr) ? reinterpret_cast<uintptr_t>(rxData + offset) : 0;
+        t.len = (count == 1) ? numBytes : 1;
+        t.speed_hz = speedHz;
+        t.bits_per_word = 8;
+        t.delay_usecs = byteGapUs;
+    }
+
+    if(device.ioctl(SPI_IOC_MESSAGE(count), transfers.data()) < 0)
+        throw std::system_error(errno, std::generic_category(), "SPI_IOC_MESSAGE");
+
+    messageCount++;
+}
+
+/**
+ * Function for transmitting a string of chars, terminated with [DATA_END_CHAR], in one transaction.
+ *
+ * @param data string without [DATA_END_CHAR]
+ */
+void SpiMaster::transmitString(const std::string &data)
+{
+    txBuffer.clear();
+
+    if(!data.empty())
+    {
+        pushFirst(data[0]);
+        txBuffer.insert(txBuffer.end(), data.begin() + 1, data.end());
+    }
+
+    txBuffer.push_back(DATA_END_CHAR);     // terminate with [DATA_END_CHAR]
+
+    transfer(nullptr, txBuffer.size());
+}
+
+/**
+ * Function for transmitting an uint8_t, terminated with [DATA_END_CHAR], in one transaction.
+ *
+ * @param data byte that is going to be transmitted
+ */
+void SpiMaster::transmitUint8_t(uint8_t data)
+{
+    txBuffer.clear();
+    pushFirst(data);
+    txBuffer.push_back(DATA_END_CHAR);
+
+    transfer(nullptr, txBuffer.size());
+}
+
+/**
+ * Function for transmitting a hex number, most significant byte first and terminated with [DATA_END_CHAR],
+ * in one transaction.
+ *! numBytes has to be less or equal to 8!
+ *
+ * @param numBytes number of hex bytes that are going to be sent
+ * @param hexNumber hex number that is going to be transmitted
+ */
+void SpiMaster::transmitHex(uint8_t numBytes, uint64_t hexNumber)
+{
+    txBuffer.clear();
+
+    for(int i = numBytes - 1; i >= 0; i--)
+    {
+        if(i == numBytes - 1)
+            pushFirst((hexNumber >> (i * 8)) & 0xFF);
+
+        else
+            txBuffer.push_back((hexNumber >> (i * 8)) & 0xFF);     // same byte order as SPI_transmitHex()
+    }
+
+    txBuffer.push_back(DATA_END_CHAR);
+
+    transfer(nullptr, txBuffer.size());
+}
+
+/**
+ * Function that reads an uint8_t from slave, master clocks [DUMMY_CHAR].
+ *
+ * @return byte that slave shifted out
+ */
+uint8_t SpiMaster::receiveUint8_t()
+{
+    uint8_t data;
+
+    receiveBytes(&data, 1);
+
+    return data;
+}
+
+/**
+ * Function that reads multiple bytes from slave in one transaction.
+ *
+ * @param buffer array where received bytes are stored
+ * @param numBytes number of bytes that are going to be read
+ */
+void SpiMaster::receiveBytes(uint8_t buffer[], size_t numBytes)
+{
+    txBuffer.assign(numBytes, DUMMY_CHAR);     // slave ignores [DUMMY_CHAR] at the start of a message
+
+    transfer(buffer, numBytes);
+}
+
+/**
+ * Function for full-duplex transfer of raw bytes in one transaction, [DATA_END_CHAR] isn't added.
+ *
+ * @param txData bytes that are going to be transmitted, nullptr to transmit [DUMMY_CHAR]
+ * @param rxData array where received bytes are stored, nullptr if received bytes aren't needed
+ * @param numBytes number of bytes that are going to be transferred
+ */
+void SpiMaster::transferBytes(const uint8_t txData[], uint8_t rxData[], size_t numBytes)
+{
+    if(txData != nullptr)
+        txBuffer.assign(txData, txData + numBytes);
+
+    else
+        txBuffer.assign(numBytes, DUMMY_CHAR);
+
+    transfer(rxData, numBytes);
+}
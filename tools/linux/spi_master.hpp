@@ -0,0 +1,156 @@
+/**
+ * @file spi_master.hpp
+ * @author Lukas Ternjej
+ *
+ * Header file for Linux userspace master of the library protocol, for gateways that talk to AVR slaves through spidev.
+ * Functions have the semantics of SPI_transmitString(), SPI_transmitHex(), SPI_receiveUint8_t() and SPI_receiveBytes(),
+ * including [DATA_END_CHAR] framing, but every frame is built in a buffer and sent with a single SPI_IOC_MESSAGE
+ * ioctl, so chip select stays asserted for the whole frame and there is one system call per frame instead of per byte.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SPI_MASTER_HPP_
+#define SPI_MASTER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <linux/spi/spidev.h>
+
+extern "C"
+{
+#include "AVR_SPI_char_defines.h"
+}
+
+/**
+ * Interface of a spidev device, so that master can run against a real /dev/spidevB.C or a fake one.
+ */
+class SpiDevice
+{
+public:
+    virtual ~SpiDevice() = default;
+
+    /**
+     * Function with the semantics of ioctl() on a spidev file descriptor.
+     *
+     * @param request SPI_IOC_* request
+     * @param argument request argument
+     * @return negative value on error, with errno set
+     */
+    virtual int ioctl(unsigned long request, void *argument) = 0;
+};
+
+/**
+ * Spidev device file, /dev/spidevB.C.
+ */
+class Spidev : public SpiDevice
+{
+public:
+    /**
+     * Constructor that opens the device file.
+     *! Throws std::system_error if the file can't be opened.
+     *
+     * @param path device file, for example "/dev/spidev0.0"
+     */
+    explicit Spidev(const std::string &path);
+    ~Spidev() override;
+
+    Spidev(const Spidev &) = delete;
+    Spidev &operator=(const Spidev &) = delete;
+
+    int ioctl(unsigned long request, void *argument) override;
+
+private:
+    int fd;
+};
+
+/**
+ * Master of a single slave on a spidev device.
+ */
+class SpiMaster
+{
+public:
+    static constexpr size_t maxTransfers = 511;     // SPI_IOC_MESSAGE(n) size field has 14 bits
+
+    /**
+     * Constructor that configures SPI mode, bit order, 8-bit words and SCK rate of the device.
+     *! Throws std::system_error if the device rejects the configuration.
+     *
+     * @param device spidev device
+     * @param speedHz SCK rate
+     * @param mode SPI_MODE_0 - SPI_MODE_3
+     * @param lsbFirst true for LSB_FIRST data order
+     * @param byteGapUs gap after every byte, for slaves whose ISR routine is longer than a byte at speedHz; 0 for none
+     */
+    SpiMaster(SpiDevice &device, uint32_t speedHz, uint8_t mode = SPI_MODE_0, bool lsbFirst = false, uint16_t byteGapUs = 0);
+
+    /**
+     * Function for transmitting a string of chars, terminated with [DATA_END_CHAR], in one transaction.
+     *
+     * @param data string without [DATA_END_CHAR]
+     */
+    void transmitString(const std::string &data);
+
+    /**
+     * Function for transmitting an uint8_t, terminated with [DATA_END_CHAR], in one transaction.
+     *
+     * @param data byte that is going to be transmitted
+     */
+    void transmitUint8_t(uint8_t data);
+
+    /**
+     * Function for transmitting a hex number, most significant byte first and terminated with [DATA_END_CHAR],
+     * in one transaction.
+     *! numBytes has to be less or equal to 8!
+     *
+     * @param numBytes number of hex bytes that are going to be sent
+     * @param hexNumber hex number that is going to be transmitted
+     */
+    void transmitHex(uint8_t numBytes, uint64_t hexNumber);
+
+    /**
+     * Function that reads an uint8_t from slave, master clocks [DUMMY_CHAR].
+     *
+     * @return byte that slave shifted out
+     */
+    uint8_t receiveUint8_t();
+
+    /**
+     * Function that reads multiple bytes from slave in one transaction.
+     *
+     * @param buffer array where received bytes are stored
+     * @param numBytes number of bytes that are going to be read
+     */
+    void receiveBytes(uint8_t buffer[], size_t numBytes);
+
+    /**
+     * Function for full-duplex transfer of raw bytes in one transaction, [DATA_END_CHAR] isn't added.
+     *
+     * @param txData bytes that are going to be transmitted, nullptr to transmit [DUMMY_CHAR]
+     * @param rxData array where received bytes are stored, nullptr if received bytes aren't needed
+     * @param numBytes number of bytes that are going to be transferred
+     */
+    void transferBytes(const uint8_t txData[], uint8_t rxData[], size_t numBytes);
+
+    /**
+     * Function that returns the number of SPI_IOC_MESSAGE ioctls made so far.
+     */
+    uint32_t messages() const { return messageCount; }
+
+private:
+    SpiDevice &device;
+    uint32_t speedHz;
+    uint16_t byteGapUs;
+    uint32_t messageCount = 0;
+    std::vector<uint8_t> txBuffer;
+    std::vector<spi_ioc_transfer> transfers;
+
+    void configure(unsigned long request, void *argument);
+    void pushFirst(uint8_t data);
+    void transfer(uint8_t rxData[], size_t numBytes);
+};
+
+#endif
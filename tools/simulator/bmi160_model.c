@@ -0,0 +1,226 @@
+/**
+ * @file bmi160_model.c
+ * @author Lukas Ternjej
+ *
+ * Host model of a BMI160 IMU.
+ *
+ * @date 2026-10-18
+ */
+
+#include <string.h>
+
+#include "bmi160_model.h"
+
+// registers used by the model, see AVR_SPI_bmi160.h
+#define REG_CHIP_ID       0x00
+#define REG_DATA_GYR      0x0C     // gyroscope x, y, z, then accelerometer x, y, z, little endian
+#define REG_FIFO_LENGTH   0x22
+#define REG_FIFO_DATA     0x24
+#define REG_ACC_CONF      0x40
+#define REG_FIFO_CONFIG_0 0x46
+#define REG_FIFO_CONFIG_1 0x47
+#define REG_INT_EN_1      0x51
+#define REG_INT_OUT_CTRL  0x53
+#define REG_INT_MAP_1     0x56
+#define REG_CMD           0x7E
+
+#define FRAME_LENGTH 12
+
+/**
+ * Function that sets sensor to power-on state.
+ *
+ * @param model sensor state
+ * @param fCpu master clock, Hz
+ */
+void bmi160_modelInit(bmi160_model_t *model, double fCpu)
+{
+    memset(model, 0, sizeof(*model));
+
+    model->fCpu = fCpu;
+    model->regs[REG_CHIP_ID] = 0xD1;
+    model->regs[REG_ACC_CONF] = 0x28;     // 100Hz
+    model->addressPhase = true;
+}
+
+/**
+ * Function that starts a new SPI transaction, called on SS falling edge.
+ *
+ * @param model sensor state
+ */
+void bmi160_modelSelect(bmi160_model_t *model)
+{
+    model->addressPhase = true;
+}
+
+/**
+ * Function that returns expected gyroscope x value of a sample, for checking received samples.
+ *
+ * @param index sample index
+ * @return gyroscope x value
+ */
+int16_t bmi160_modelGyroX(uint32_t index)
+{
+    return (int16_t)(index * 7 + 3);
+}
+
+/**
+ * Function that executes a write to the command register.
+ *
+ * @param model sensor state
+ * @param command command byte
+ */
+static void bmi160_modelCommand(bmi160_model_t *model, uint8_t command)
+{
+    switch(command)
+    {
+    case 0xB6:     // soft reset
+    {
+        double fCpu = model->fCpu;
+        bmi160_modelInit(model, fCpu);
+        break;
+    }
+
+    case 0x11:
+        model->accelOn = true;
+        break;
+
+    case 0x15:
+        model->gyroOn = true;
+        break;
+
+    case 0xB0:     // FIFO flush
+        model->fifoHead = 0;
+        model->fifoCount = 0;
+        break;
+    }
+}
+
+/**
+ * Function that clocks one byte through the sensor.
+ *
+ * @param model sensor state
+ * @param mosi byte from master
+ * @return byte to master
+ */
+uint8_t bmi160_modelExchange(bmi160_model_t *model, uint8_t mosi)
+{
+    if(model->addressPhase)
+    {
+        model->addressPhase = false;
+        model->reading = mosi & 0x80;
+        model->address = mosi & 0x7F;
+        return 0xFF;
+    }
+
+    uint8_t reg = model->address;
+    uint8_t miso = 0xFF;
+
+    if(model->reading)
+    {
+        if(reg == REG_FIFO_DATA)
+        {
+            // FIFO streams from a single address, empty FIFO reads as 0x80
+            if(model->fifoCount > 0)
+            {
+                miso = model->fifo[model->fifoHead];
+                model->fifoHead = (model->fifoHead + 1) % BMI160_MODEL_FIFO;
+                model->fifoCount--;
+            }
+
+            else
+                miso = 0x80;
+
+            return miso;
+        }
+
+        if(reg == REG_FIFO_LENGTH)
+            miso = model->fifoCount & 0xFF;
+
+        else if(reg == REG_FIFO_LENGTH + 1)
+            miso = (model->fifoCount >> 8) & 0x07;
+
+        else
+            miso = model->regs[reg];
+    }
+
+    else if(reg == REG_CMD)
+        bmi160_modelCommand(model, mosi);
+
+    else
+        model->regs[reg] = mosi;
+
+    model->address = (reg + 1) & 0x7F;
+
+    return miso;
+}
+
+/**
+ * Function that pushes one frame in FIFO, dropping the oldest frame if FIFO is full.
+ *
+ * @param model sensor state
+ * @param frame headerless frame
+ */
+static void bmi160_modelPush(bmi160_model_t *model, const uint8_t frame[FRAME_LENGTH])
+{
+    if(model->fifoCount + FRAME_LENGTH > BMI160_MODEL_FIFO)
+    {
+        model->fifoHead = (model->fifoHead + FRAME_LENGTH) % BMI160_MODEL_FIFO;
+        model->fifoCount -= FRAME_LENGTH;
+        model->fifoOverflows++;
+    }
+
+    for(int i = 0; i < FRAME_LENGTH; i++)
+        model->fifo[(model->fifoHead + model->fifoCount + i) % BMI160_MODEL_FIFO] = frame[i];
+
+    model->fifoCount += FRAME_LENGTH;
+}
+
+/**
+ * Function that generates samples up to the virtual time and updates INT1 pin.
+ *
+ * @param model sensor state
+ * @param now virtual time, in master cycles
+ * @return true if INT1 pin has a falling edge
+ */
+bool bmi160_modelAdvance(bmi160_model_t *model, uint64_t now)
+{
+    if(!model->accelOn || !model->gyroOn)
+    {
+        model->nextSample = now;
+        return false;
+    }
+
+    uint8_t odr = model->regs[REG_ACC_CONF] & 0x0F;
+    double rate = 100.0 * (double)(1 << (odr >= 8 ? odr - 8 : 0));
+    uint64_t period = (uint64_t)(model->fCpu / rate);
+
+    while(model->nextSample <= now)
+    {
+        uint32_t n = model->sampleIndex++;
+        int16_t values[6] = {bmi160_modelGyroX(n), (int16_t)(-n), (int16_t)(n >> 1), 0, 0, 16384};     // 1g on z axis
+        uint8_t frame[FRAME_LENGTH];
+
+        for(int i = 0; i < 6; i++)
+        {
+            frame[2 * i] = values[i] & 0xFF;
+            frame[2 * i + 1] = (values[i] >> 8) & 0xFF;
+        }
+
+        memcpy(&model->regs[REG_DATA_GYR], frame, FRAME_LENGTH);
+
+        if(model->regs[REG_FIFO_CONFIG_1] & 0xC0)
+            bmi160_modelPush(model, frame);
+
+        model->nextSample += period;
+    }
+
+    // watermark interrupt, mapped to INT1 and output enabled
+    uint16_t watermark = model->regs[REG_FIFO_CONFIG_0] * 4;
+    bool enabled = (model->regs[REG_INT_EN_1] & 0x40) && (model->regs[REG_INT_MAP_1] & 0x40) && (model->regs[REG_INT_OUT_CTRL] & 0x08);
+    bool active = enabled && watermark > 0 && model->fifoCount >= watermark;
+    bool fallingEdge = active && !model->intLow;
+
+    model->intLow = active;
+
+    return fallingEdge;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file bmi160_model.h
+ * @author Lukas Ternjej
+ *
+ * Header file for host model of a BMI160 IMU: register file, SPI protocol, headerless FIFO
+ * with watermark on INT1, and samples generated at the configured data rate on the virtual clock.
+ * Only the parts that AVR_SPI_bmi160.c uses are modelled.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef BMI160_MODEL_H_
+#define BMI160_MODEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BMI160_MODEL_FIFO 1024     // FIFO size in bytes
+
+/**
+ * Structure that holds sensor state.
+ */
+typedef struct
+{
+    uint8_t regs[128];
+    uint8_t fifo[BMI160_MODEL_FIFO];
+    uint16_t fifoHead;
+    uint16_t fifoCount;
+    uint8_t address;           // register of the next data byte
+    bool addressPhase;         // next byte is register address
+    bool reading;
+    bool accelOn;
+    bool gyroOn;
+    double fCpu;               // master clock, Hz; virtual clock is in master cycles
+    uint64_t nextSample;       // virtual time of next sample
+    uint32_t sampleIndex;      // number of generated samples, encoded in sample data
+    uint32_t fifoOverflows;    // frames dropped because FIFO was full
+    bool intLow;               // INT1 pin level, active low
+} bmi160_model_t;
+
+/**
+ * Function that sets sensor to power-on state.
+ *
+ * @param model sensor state
+ * @param fCpu master clock, Hz
+ */
+void bmi160_modelInit(bmi160_model_t *model, double fCpu);
+
+/**
+ * Function that starts a new SPI transaction, called on SS falling edge.
+ *
+ * @param model sensor state
+ */
+void bmi160_modelSelect(bmi160_model_t *model);
+
+/**
+ * Function that clocks one byte through the sensor.
+ *
+ * @param model sensor state
+ * @param mosi byte from master
+ * @return byte to master
+ */
+uint8_t bmi160_modelExchange(bmi160_model_t *model, uint8_t mosi);
+
+/**
+ * Function that generates samples up to the virtual time and updates INT1 pin.
+ *
+ * @param model sensor state
+ * @param now virtual time, in master cycles
+ * @return true if INT1 pin has a falling edge
+ */
+bool bmi160_modelAdvance(bmi160_model_t *model, uint64_t now);
+
+/**
+ * Function that returns expected gyroscope x value of a sample, for checking received samples.
+ *
+ * @param index sample index
+ * @return gyroscope x value
+ */
+int16_t bmi160_modelGyroX(uint32_t index);
+
+#endif
@@ -0,0 +1,300 @@
+/**
+ * @file cache_test.c
+ * @author Lukas Ternjej
+ *
+ * Host benchmark of AVR_SPI_cache.c on a 25LC512 class EEPROM model. Master firmware runs the real
+ * library on the virtual clock and repeats a storage access pattern: configuration record reads,
+ * directory entry lookups, a sequential stream read and a counter update. The same pattern runs
+ * without cache, with cache and with cache and read-ahead; every read is checked against a shadow
+ * copy of the memory. Bus meter (SPI_USE_METER) provides SS edges to the model and byte counts.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_cache.h"
+#include "AVR_SPI_meter.h"
+#include "flash25_model.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU         16000000.0
+#define SIM_BYTE_OVERHEAD 12     // master cycles per byte spent outside of shifting (SPDR write, SPIF poll)
+
+// 25LC512 commands
+#define EEPROM_WRITE 0x02
+#define EEPROM_READ  0x03
+#define EEPROM_RDSR  0x05
+#define EEPROM_WREN  0x06
+
+// access pattern
+#define CONFIG_ADDRESS  0x0000     // configuration record, read every step
+#define CONFIG_LENGTH   16
+#define COUNTER_ADDRESS 0x0010     // counter next to configuration record, written every COUNTER_PERIOD steps
+#define COUNTER_PERIOD  16
+#define DIR_ADDRESS     0x0100     // directory, one entry looked up every step
+#define DIR_ENTRIES     8
+#define DIR_ENTRY       4
+#define STREAM_ADDRESS  0x1000     // stream, read sequentially in STREAM_CHUNK pieces
+#define STREAM_LENGTH   0x8000
+#define STREAM_CHUNK    16
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    flash25_model_t model;
+    uint8_t shadow[64UL * 1024];     // expected memory content
+    uint64_t now;                    // virtual clock, in master cycles
+    int divider;                     // F_CPU / SCK
+} sim_cache_t;
+
+static sim_cache_t sim;
+
+/**
+ * Function that passes SS state from bus meter to the memory model.
+ */
+static void sim_cacheSync(void)
+{
+    uint32_t transactions = SPI_meterDeviceCount > 0 ? SPI_meterDevices[0].transactions : 0;
+
+    flash25_modelSync(&sim.model, SPI_meterCurrent != NULL, transactions, sim.now);
+}
+
+static uint8_t sim_cacheExchange(void *context, uint8_t mosi)
+{
+    sim_cacheSync();
+    sim.now += 8 * sim.divider + SIM_BYTE_OVERHEAD;
+
+    return flash25_modelExchange(&sim.model, mosi, sim.now);
+}
+
+static void sim_cacheDelay(void *context, double us)
+{
+    sim_cacheSync();
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+}
+
+static uint64_t sim_cacheCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that starts an EEPROM command with a 16-bit address.
+ *
+ * @param device EEPROM on SPI bus
+ * @param command EEPROM_READ or EEPROM_WRITE
+ * @param address memory address
+ */
+static void sim_eepromCommand(SPI_device_t *device, uint8_t command, uint32_t address)
+{
+    SPI_deviceSelect(device);     // start transmission
+
+    SPI_masterPutUint8_t(command);
+    SPI_masterPutUint8_t(address >> 8);
+    SPI_masterPutUint8_t(address);
+}
+
+/**
+ * Function that polls status register until the last write is finished.
+ *
+ * @param device EEPROM on SPI bus
+ */
+static void sim_eepromWait(SPI_device_t *device)
+{
+    while(true)
+    {
+        SPI_deviceSelect(device);
+        SPI_masterPutUint8_t(EEPROM_RDSR);
+        uint8_t status = SPI_masterReadUint8_t();
+        SPI_deviceRelease(device);
+
+        if(!(status & 0x01))
+            return;
+
+        _delay_us(100);
+    }
+}
+
+static bool sim_eepromReadBlocks(void *storage, uint32_t address, uint8_t *blocks[], uint8_t count)
+{
+    SPI_device_t *device = storage;
+
+    sim_eepromWait(device);
+    sim_eepromCommand(device, EEPROM_READ, address);
+
+    for(uint8_t b = 0; b < count; b++)
+    {
+        for(uint16_t i = 0; i < CACHE_BLOCK_LENGTH; i++)
+            blocks[b][i] = SPI_masterReadUint8_t();
+    }
+
+    SPI_deviceRelease(device);     // end transmission
+
+    return true;
+}
+
+/**
+ * Function that writes bytes within a single EEPROM page.
+ */
+static bool sim_eepromWrite(SPI_device_t *device, uint32_t address, const uint8_t data[], uint16_t numBytes)
+{
+    sim_eepromWait(device);
+
+    SPI_deviceSelect(device);
+    SPI_masterPutUint8_t(EEPROM_WREN);
+    SPI_deviceRelease(device);
+
+    sim_eepromCommand(device, EEPROM_WRITE, address);
+
+    for(uint16_t i = 0; i < numBytes; i++)
+        SPI_masterPutUint8_t(data[i]);
+
+    SPI_deviceRelease(device);     // end transmission, EEPROM starts writing
+
+    return true;
+}
+
+static bool sim_eepromWriteBlock(void *storage, uint32_t address, const uint8_t block[])
+{
+    return sim_eepromWrite(storage, address, block, CACHE_BLOCK_LENGTH);
+}
+
+/**
+ * Function that reads bytes without cache, one transaction per call.
+ */
+static bool sim_directRead(SPI_device_t *device, uint32_t address, uint8_t buffer[], uint16_t numBytes)
+{
+    sim_eepromWait(device);
+    sim_eepromCommand(device, EEPROM_READ, address);
+
+    for(uint16_t i = 0; i < numBytes; i++)
+        buffer[i] = SPI_masterReadUint8_t();
+
+    SPI_deviceRelease(device);
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct
+    {
+        const char *name;
+        bool cached;
+        uint8_t readAhead;
+    } modes[] = {{"direct", false, 0}, {"cache", true, 0}, {"cache+ra1", true, 1}, {"cache+ra2", true, 2}};
+    int steps = 4096;
+    int option;
+
+    while((option = getopt(argc, argv, "s:")) != -1)
+    {
+        switch(option)
+        {
+        case 's':
+            steps = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-s steps]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_cacheExchange, sim_cacheDelay, sim_cacheCycles};
+
+    printf("%u lines x %u bytes, %d steps\n", CACHE_LINES, CACHE_BLOCK_LENGTH, steps);
+    printf("mode       hit%%    ahead_hit%%  bus_bytes  trans    page_writes  saved%%  time_ms  errors\n");
+
+    uint32_t directBytes = 0;
+    int status = 0;
+
+    for(size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        SPI_device_t device = {&PORTB, PB1, DEFAULT_SS_CONTROL, 0, 0};
+        SPI_cache_t cache;
+        uint8_t buffer[64];
+        uint32_t errors = 0;
+        uint32_t counter = 0;
+
+        flash25_modelInit(&sim.model, true, SIM_F_CPU);
+
+        for(uint32_t i = 0; i < sim.model.size; i++)
+            sim.model.memory[i] = sim.shadow[i] = (uint8_t)(i * 31 + (i >> 8) + 7);
+
+        sim.now = 0;
+        sim.divider = 4;
+
+        SPI_init(MASTER_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+        SPI_meterInit(METER_DIV64);
+        SPI_cacheInit(&cache, &device, sim_eepromReadBlocks, sim_eepromWriteBlock, modes[m].readAhead);
+
+        for(int step = 0; step < steps; step++)
+        {
+            const struct
+            {
+                uint32_t address;
+                uint16_t length;
+            } reads[] = {{CONFIG_ADDRESS, CONFIG_LENGTH},
+                         {DIR_ADDRESS + (step % DIR_ENTRIES) * DIR_ENTRY, DIR_ENTRY},
+                         {STREAM_ADDRESS + ((uint32_t)step * STREAM_CHUNK) % STREAM_LENGTH, STREAM_CHUNK}};
+
+            for(size_t r = 0; r < sizeof(reads) / sizeof(reads[0]); r++)
+            {
+                if(modes[m].cached)
+                    SPI_cacheRead(&cache, reads[r].address, buffer, reads[r].length);
+
+                else
+                    sim_directRead(&device, reads[r].address, buffer, reads[r].length);
+
+                if(memcmp(buffer, &sim.shadow[reads[r].address], reads[r].length) != 0)
+                    errors++;
+            }
+
+            if(step % COUNTER_PERIOD == 0)
+            {
+                counter++;
+                memcpy(&sim.shadow[COUNTER_ADDRESS], &counter, sizeof(counter));
+
+                if(modes[m].cached)
+                    SPI_cacheWrite(&cache, COUNTER_ADDRESS, (uint8_t *)&counter, sizeof(counter));
+
+                else
+                    sim_eepromWrite(&device, COUNTER_ADDRESS, (uint8_t *)&counter, sizeof(counter));
+            }
+        }
+
+        if(modes[m].cached)
+            SPI_cacheFlush(&cache);
+
+        sim_eepromWait(&device);
+        sim_cacheSync();
+
+        if(memcmp(sim.model.memory, sim.shadow, sim.model.size) != 0)
+            errors++;
+
+        uint32_t bytes = SPI_meterDevices[0].bytes;
+        uint32_t transactions = SPI_meterDevices[0].transactions;
+        uint32_t accesses = cache.hits + cache.misses;
+
+        if(!modes[m].cached)
+            directBytes = bytes;
+
+        if(errors > 0)
+            status = 1;
+
+        printf("%-10s %-7.1f %-11.1f %-10u %-8u %-12u %-7.1f %-8.1f %u\n", modes[m].name,
+               modes[m].cached ? 100.0 * cache.hits / accesses : 0.0,
+               cache.aheadBlocks > 0 ? 100.0 * cache.aheadHits / cache.aheadBlocks : 0.0, bytes, transactions,
+               sim.model.pagePrograms, 100.0 * (1.0 - (double)bytes / directBytes), sim.now * 1000.0 / SIM_F_CPU,
+               errors);
+
+        flash25_modelFree(&sim.model);
+    }
+
+    return status;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file fec_test.c
+ * @author Lukas Ternjej
+ *
+ * Host test of Hamming(7,4) forward error correction (AVR_SPI_fec.c). Master and slave run the real library in
+ * one process: every byte that master clocks out goes through a link that flips each of its bits at the given bit
+ * error rate, and is then handled by slave SPI_STC_vect. Every message is checked in slave SPI_data[] after
+ * SPI_readAll(). Built with SPI_USE_FEC, master sends messages with SPI_transmitStringFEC(); built without it,
+ * master sends the same messages with SPI_transmitString(), for comparison. FEC build first flips every bit of
+ * every code byte of a set of messages once, each of those messages has to be received intact.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_fec.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU       16000000.0
+#define SIM_BYTE_CYCLES (8 * 8 + 12)     // FOSC_DIV8 plus master overhead (SPDR write, SPIF poll), longer than slave ISR routine
+#define SIM_SS_CYCLES   24               // SS port read-modify-write on select and release
+#define SIM_MAX_LENGTH  32               // longest message, in data bytes
+
+extern volatile uint8_t sim_SPDR;
+extern volatile size_t receivedBytes;
+void SPI_STC_vect(void);
+
+/**
+ * Structure that holds test state of one bit error rate.
+ */
+typedef struct
+{
+    double errorRate;           // probability that a bit is flipped on the link
+    uint64_t now;               // virtual clock, in master cycles
+    uint64_t bytes;             // bytes clocked by master
+    uint32_t bitErrors;         // bits flipped on the link
+    int32_t flipByte;           // byte of the message whose flipBit is flipped, -1 for random errors
+    uint8_t flipBit;
+    uint32_t messageBytes;      // bytes clocked in current message
+    uint32_t intact;            // messages received as sent
+    uint32_t corrupt;           // messages received with wrong data
+} sim_fec_t;
+
+static sim_fec_t sim;
+
+/**
+ * Function that passes a byte over the link to the slave ISR routine, with bit errors at sim.errorRate,
+ * or with one chosen bit flipped.
+ */
+static uint8_t sim_fecExchange(void *context, uint8_t mosi)
+{
+    sim.now += SIM_BYTE_CYCLES;
+    sim.bytes++;
+
+    if(sim.flipByte >= 0)
+    {
+        if(sim.messageBytes == (uint32_t)sim.flipByte)
+        {
+            mosi ^= 1 << sim.flipBit;
+            sim.bitErrors++;
+        }
+    }
+
+    else
+    {
+        for(uint8_t bit = 0; bit < 8; bit++)
+        {
+            if(rand() < sim.errorRate * ((double)RAND_MAX + 1))
+            {
+                mosi ^= 1 << bit;
+                sim.bitErrors++;
+            }
+        }
+    }
+
+    sim.messageBytes++;
+    sim_SPDR = mosi;
+    SPI_STC_vect();
+
+    return DUMMY_CHAR;
+}
+
+static void sim_fecDelay(void *context, double us)
+{
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+}
+
+static uint64_t sim_fecCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that sends a message and runs slave main loop once: reads the message and compares it with the sent one.
+ * A message that isn't read before the next one is a lost message.
+ *
+ * @param text message, printable characters
+ * @return true if slave received the message intact
+ */
+static bool sim_fecMessage(char *text)
+{
+    size_t size = strlen(text);
+
+    sim.messageBytes = 0;
+
+#if SPI_USE_FEC
+    SPI_transmitStringFEC(&PORTB, PB1, DEFAULT_SS_CONTROL, text);
+#else
+    SPI_transmitString(&PORTB, PB1, DEFAULT_SS_CONTROL, text);
+#endif
+
+    sim.now += SIM_SS_CYCLES;
+
+    size_t length = receivedBytes;
+
+    if(!SPI_readAll())
+        return false;
+
+    if(length == size && memcmp(SPI_data, text, size) == 0)
+    {
+        sim.intact++;
+        return true;
+    }
+
+    sim.corrupt++;
+    return false;
+}
+
+/**
+ * Function that fills a message with random printable characters, at least 2 of them.
+ */
+static void sim_fecText(char text[])
+{
+    size_t size = 2 + rand() % (SIM_MAX_LENGTH - 1);
+
+    for(size_t i = 0; i < size; i++)
+        text[i] = ' ' + rand() % 95;
+
+    text[size] = '\0';
+}
+
+#if SPI_USE_FEC
+/**
+ * Function that flips every bit of every code byte of a set of messages once, [DATA_END_CHAR] excluded.
+ *
+ * @return number of messages that weren't received intact
+ */
+static uint32_t sim_fecSingleErrors(void)
+{
+    static const char *texts[] = {"/?O_o", "Hello, world!", "~}|{zyxwvutsrqp", " 0123456789ABCDEF"};
+    uint32_t failures = 0;
+
+    for(size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++)
+    {
+        char text[SIM_MAX_LENGTH + 1];
+
+        strcpy(text, texts[t]);
+
+        for(int32_t k = 0; k < 2 * (int32_t)strlen(text); k++)
+        {
+            for(uint8_t bit = 0; bit < 8; bit++)
+            {
+                sim.flipByte = k;
+                sim.flipBit = bit;
+
+                if(!sim_fecMessage(text))
+                    failures++;
+            }
+        }
+    }
+
+    sim.flipByte = -1;
+
+    return failures;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    static const double errorRates[] = {0, 1e-5, 1e-4, 1e-3, 1e-2};
+    uint32_t messages = 20000;
+    uint32_t failures = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            messages = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n messages]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_fecExchange, sim_fecDelay, sim_fecCycles, NULL};
+
+    SPI_init(SLAVE_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV8);
+    srand(1);
+
+#if SPI_USE_FEC
+    uint32_t singleFailures = sim_fecSingleErrors();
+
+    printf("single bit errors in code bytes: %u messages not intact\n\n", singleFailures);
+
+    if(singleFailures != 0)
+        failures++;
+#endif
+
+    printf("mode   err/bit  messages  intact  corrupt  lost  corrected  bytes/msg  msg_us  intact/s\n");
+
+    for(size_t r = 0; r < sizeof(errorRates) / sizeof(errorRates[0]); r++)
+    {
+        char text[SIM_MAX_LENGTH + 1];
+
+        memset(&sim, 0, sizeof(sim));
+        sim.errorRate = errorRates[r];
+        sim.flipByte = -1;
+        SPI_fecCorrected = 0;
+
+        for(uint32_t n = 0; n < messages; n++)
+        {
+            sim_fecText(text);
+            sim_fecMessage(text);
+        }
+
+        double messageUs = sim.now * 1e6 / SIM_F_CPU / messages;
+
+        printf("%-6s %-8g %-9u %-7u %-8u %-5u %-10u %-10.1f %-7.2f %.0f\n", SPI_USE_FEC ? "fec" : "plain",
+               sim.errorRate, messages, sim.intact, sim.corrupt, messages - sim.intact - sim.corrupt,
+               SPI_fecCorrected, (double)sim.bytes / messages, messageUs, sim.intact * 1e6 / (messageUs * messages));
+
+        // error free link delivers every message
+        if(sim.errorRate == 0 && sim.intact != messages)
+            failures++;
+    }
+
+    if(failures != 0)
+        printf("\n%u failures\n", failures);
+
+    return failures != 0;
+}
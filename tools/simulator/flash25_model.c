@@ -0,0 +1,352 @@
+/**
+ * @file flash25_model.c
+ * @author Lukas Ternjej
+ *
+ * Host model of a 25xx SPI flash or EEPROM.
+ *
+ * @date 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash25_model.h"
+
+// commands
+#define CMD_WRITE     0x02     // page program
+#define CMD_READ      0x03
+#define CMD_WRDI      0x04
+#define CMD_RDSR      0x05
+#define CMD_WREN      0x06
+#define CMD_FAST_READ 0x0B
+#define CMD_SE        0x20     // 4KB sector erase
+#define CMD_SUSPEND   0x75     // erase suspend
+#define CMD_RESUME    0x7A     // erase resume
+#define CMD_CE        0xC7     // chip erase
+#define CMD_BE        0xD8     // 64KB block erase
+#define CMD_RDID      0x9F
+
+// typical timings, in microseconds
+#define FLASH_T_PP  400.0          // whole page
+#define FLASH_T_BP1 30.0           // first byte
+#define FLASH_T_BP2 2.5            // every following byte
+#define FLASH_T_SE  45000.0
+#define FLASH_T_BE  150000.0
+#define FLASH_T_CE  10000000.0
+#define FLASH_T_SUS 20.0           // erase suspend latency
+#define EEPROM_T_WC 5000.0
+
+/**
+ * Function that allocates memory, erased to 0xFF.
+ *
+ * @param model memory state
+ * @param eeprom true for 25LC512 class EEPROM, false for W25Q32 class flash
+ * @param fCpu master clock, Hz
+ */
+void flash25_modelInit(flash25_model_t *model, bool eeprom, double fCpu)
+{
+    memset(model, 0, sizeof(*model));
+
+    model->eeprom = eeprom;
+    model->fCpu = fCpu;
+
+    if(eeprom)
+    {
+        model->size = 64UL * 1024;
+        model->pageSize = 128;
+        model->sectorSize = 0;
+        model->addressBytes = 2;
+    }
+
+    else
+    {
+        model->size = 4UL * 1024 * 1024;
+        model->pageSize = 256;
+        model->sectorSize = 4096;
+        model->addressBytes = 3;
+        model->sectorErases = calloc(model->size / model->sectorSize, sizeof(uint32_t));
+    }
+
+    model->memory = malloc(model->size);
+    memset(model->memory, 0xFF, model->size);
+}
+
+/**
+ * Function that frees memory.
+ *
+ * @param model memory state
+ */
+void flash25_modelFree(flash25_model_t *model)
+{
+    free(model->memory);
+    free(model->sectorErases);
+    model->memory = NULL;
+    model->sectorErases = NULL;
+}
+
+/**
+ * Function that checks if program or erase is in progress.
+ *
+ * @param model memory state
+ * @param now virtual time, in master cycles
+ * @return true if memory is busy
+ */
+static bool flash25_modelBusy(flash25_model_t *model, uint64_t now)
+{
+    return now < model->busyUntil;
+}
+
+/**
+ * Function that erases a range of flash and starts busy time.
+ *
+ * @param model memory state
+ * @param address first byte, aligned down to erase size
+ * @param length erase size in bytes
+ * @param us erase time
+ * @param now virtual time, in master cycles
+ */
+static void flash25_modelErase(flash25_model_t *model, uint32_t address, uint32_t length, double us, uint64_t now)
+{
+    address = (address % model->size) & ~(length - 1);
+    memset(&model->memory[address], 0xFF, length);
+
+    for(uint32_t s = address / model->sectorSize; s < (address + length) / model->sectorSize; s++)
+        model->sectorErases[s]++;
+
+    model->erases++;
+    model->busyUntil = now + (uint64_t)(us * model->fCpu / 1e6);
+    model->erasing = (length != model->size);     // chip erase can't be suspended
+    model->suspendedAddress = address;
+    model->suspendedLength = length;
+}
+
+/**
+ * Function that executes the command of the finished transaction, called on SS rising edge.
+ *
+ * @param model memory state
+ * @param now virtual time, in master cycles
+ */
+static void flash25_modelRelease(flash25_model_t *model, uint64_t now)
+{
+    uint32_t addressEnd = 1 + model->addressBytes;
+
+    model->selected = false;
+
+    if(model->index == 0)
+        return;
+
+    switch(model->command)
+    {
+    case CMD_WREN:
+        model->writeEnabled = true;
+        break;
+
+    case CMD_WRDI:
+        model->writeEnabled = false;
+        break;
+
+    case CMD_WRITE:
+    {
+        if(!model->writeEnabled || model->index <= addressEnd)
+            break;
+
+        uint32_t pageBase = (model->address % model->size) & ~(uint32_t)(model->pageSize - 1);
+        uint16_t programmed = 0;
+
+        if(model->suspended && pageBase - model->suspendedAddress < model->suspendedLength)
+        {
+            model->programFaults++;     // sector of suspended erase can't be programmed
+            model->writeEnabled = false;
+            break;
+        }
+
+        for(uint16_t i = 0; i < model->pageSize; i++)
+        {
+            if(!model->pageUsed[i])
+                continue;
+
+            uint8_t *cell = &model->memory[pageBase + i];
+            programmed++;
+
+            if(model->eeprom)
+                *cell = model->page[i];
+
+            else
+            {
+                if(model->page[i] & ~*cell)
+                    model->programFaults++;
+
+                *cell &= model->page[i];     // NOR flash program only clears bits
+            }
+        }
+
+        model->pagePrograms++;
+        model->writeEnabled = false;
+        model->erasing = false;
+
+        // flash program time grows with number of bytes, up to page program time
+        double us = FLASH_T_BP1 + FLASH_T_BP2 * (programmed - 1);
+
+        if(model->eeprom)
+            us = EEPROM_T_WC;
+
+        else if(us > FLASH_T_PP)
+            us = FLASH_T_PP;
+
+        model->busyUntil = now + (uint64_t)(us * model->fCpu / 1e6);
+        break;
+    }
+
+    case CMD_SE:
+    case CMD_BE:
+        if(model->eeprom || !model->writeEnabled || model->index != addressEnd || model->suspended)
+            break;
+
+        if(model->command == CMD_SE)
+            flash25_modelErase(model, model->address, model->sectorSize, FLASH_T_SE, now);
+
+        else
+            flash25_modelErase(model, model->address, 64UL * 1024, FLASH_T_BE, now);
+
+        model->writeEnabled = false;
+        break;
+
+    case CMD_CE:
+        if(model->eeprom || !model->writeEnabled || model->suspended)
+            break;
+
+        flash25_modelErase(model, 0, model->size, FLASH_T_CE, now);
+        model->writeEnabled = false;
+        break;
+
+    case CMD_SUSPEND:
+        // memory is erased at erase start, so only the remaining busy time is kept
+        if(!model->erasing || !flash25_modelBusy(model, now))
+            break;
+
+        model->suspendedCycles = model->busyUntil - now;
+        model->busyUntil = now + (uint64_t)(FLASH_T_SUS * model->fCpu / 1e6);
+        model->erasing = false;
+        model->suspended = true;
+        model->suspends++;
+        break;
+
+    case CMD_RESUME:
+        if(!model->suspended || flash25_modelBusy(model, now))
+            break;
+
+        model->busyUntil = now + model->suspendedCycles;
+        model->erasing = true;
+        model->suspended = false;
+        break;
+    }
+}
+
+/**
+ * Function that tracks SS from master state, called before every exchange and after every delay.
+ * A changed transaction count means SS was released and asserted again since the last call.
+ *
+ * @param model memory state
+ * @param selected SS is asserted
+ * @param transactions number of SS assertions so far
+ * @param now virtual time, in master cycles
+ */
+void flash25_modelSync(flash25_model_t *model, bool selected, uint32_t transactions, uint64_t now)
+{
+    if(transactions != model->lastTransactions || !selected)
+    {
+        if(model->selected)
+            flash25_modelRelease(model, now);
+
+        model->lastTransactions = transactions;
+    }
+
+    if(selected && !model->selected)
+    {
+        model->selected = true;
+        model->index = 0;
+        model->address = 0;
+        memset(model->pageUsed, 0, sizeof(model->pageUsed));
+    }
+}
+
+/**
+ * Function that clocks one byte through the memory.
+ *
+ * @param model memory state
+ * @param mosi byte from master
+ * @param now virtual time, in master cycles
+ * @return byte to master
+ */
+uint8_t flash25_modelExchange(flash25_model_t *model, uint8_t mosi, uint64_t now)
+{
+    if(!model->selected)
+        return 0xFF;
+
+    uint32_t index = model->index++;
+    uint32_t addressEnd = 1 + model->addressBytes;
+
+    if(index == 0)
+    {
+        model->command = mosi;
+
+        // busy memory only answers RDSR and erase suspend
+        if(flash25_modelBusy(model, now) && mosi != CMD_RDSR && mosi != CMD_SUSPEND)
+        {
+            model->command = 0x00;
+            model->busyRejects++;
+        }
+
+        return 0xFF;
+    }
+
+    switch(model->command)
+    {
+    case CMD_RDSR:
+        return (flash25_modelBusy(model, now) ? 0x01 : 0x00) | (model->writeEnabled ? 0x02 : 0x00);
+
+    case CMD_RDID:
+    {
+        static const uint8_t id[3] = {0xEF, 0x40, 0x16};     // W25Q32
+
+        return (!model->eeprom && index <= 3) ? id[index - 1] : 0xFF;
+    }
+
+    case CMD_READ:
+    case CMD_FAST_READ:
+    case CMD_WRITE:
+    case CMD_SE:
+    case CMD_BE:
+        if(index < addressEnd)
+        {
+            model->address = (model->address << 8) | mosi;
+            return 0xFF;
+        }
+
+        if(model->command == CMD_FAST_READ && index == addressEnd)
+            return 0xFF;     // dummy byte
+
+        if(model->command == CMD_READ || model->command == CMD_FAST_READ)
+        {
+            uint8_t data = model->memory[model->address % model->size];
+
+            model->address++;
+            model->readBytes++;
+
+            return data;
+        }
+
+        if(model->command == CMD_WRITE)
+        {
+            // offset in page wraps, address keeps the page
+            uint16_t offset = (model->address + index - addressEnd) % model->pageSize;
+
+            model->page[offset] = mosi;
+            model->pageUsed[offset] = true;
+        }
+
+        return 0xFF;
+    }
+
+    return 0xFF;
+}
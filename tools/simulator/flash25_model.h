@@ -0,0 +1,95 @@
+/**
+ * @file flash25_model.h
+ * @author Lukas Ternjej
+ *
+ * Header file for host model of a 25xx SPI memory: W25Q32 class NOR flash (4MB, 256 byte pages,
+ * 4KB sectors, program only clears bits) or 25LC512 class EEPROM (64KB, 128 byte pages, 16-bit address).
+ * Commands take effect on SS rising edge and program/erase keep the memory busy for their typical time.
+ * Flash sector and block erase can be suspended to program or read other sectors.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef FLASH25_MODEL_H_
+#define FLASH25_MODEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Structure that holds memory state.
+ */
+typedef struct
+{
+    bool eeprom;                // 25LC512 class EEPROM, else W25Q32 class flash
+    uint8_t *memory;
+    uint32_t size;              // bytes
+    uint16_t pageSize;          // bytes, program wraps within a page
+    uint32_t sectorSize;        // bytes, 0 if memory has no erase
+    uint8_t addressBytes;       // 2 or 3
+    double fCpu;                // master clock, Hz; virtual clock is in master cycles
+
+    // current transaction
+    bool selected;
+    uint32_t lastTransactions;  // transaction count of the last flash25_modelSync() call
+    uint8_t command;
+    uint32_t index;             // bytes received in current transaction
+    uint32_t address;
+    uint8_t page[256];          // program data, applied on SS rising edge
+    bool pageUsed[256];
+    bool writeEnabled;          // WEL bit
+    uint64_t busyUntil;         // virtual time when program or erase ends
+    bool erasing;               // busy time belongs to sector or block erase
+    bool suspended;             // erase is suspended
+    uint64_t suspendedCycles;   // erase time left when it was suspended
+    uint32_t suspendedAddress;  // first byte of suspended erase
+    uint32_t suspendedLength;
+
+    // statistics
+    uint32_t pagePrograms;
+    uint32_t erases;
+    uint32_t *sectorErases;     // erase count of every sector
+    uint32_t programFaults;     // programs that tried to set bits of unerased flash or programs into suspended erase
+    uint32_t busyRejects;       // commands other than RDSR and erase suspend while busy
+    uint32_t suspends;
+    uint32_t readBytes;         // data bytes clocked out by READ and FAST_READ
+} flash25_model_t;
+
+/**
+ * Function that allocates memory, erased to 0xFF.
+ *
+ * @param model memory state
+ * @param eeprom true for 25LC512 class EEPROM, false for W25Q32 class flash
+ * @param fCpu master clock, Hz
+ */
+void flash25_modelInit(flash25_model_t *model, bool eeprom, double fCpu);
+
+/**
+ * Function that frees memory.
+ *
+ * @param model memory state
+ */
+void flash25_modelFree(flash25_model_t *model);
+
+/**
+ * Function that tracks SS from master state, called before every exchange and after every delay.
+ * A changed transaction count means SS was released and asserted again since the last call.
+ *
+ * @param model memory state
+ * @param selected SS is asserted
+ * @param transactions number of SS assertions so far
+ * @param now virtual time, in master cycles
+ */
+void flash25_modelSync(flash25_model_t *model, bool selected, uint32_t transactions, uint64_t now);
+
+/**
+ * Function that clocks one byte through the memory.
+ *
+ * @param model memory state
+ * @param mosi byte from master
+ * @param now virtual time, in master cycles
+ * @return byte to master
+ */
+uint8_t flash25_modelExchange(flash25_model_t *model, uint8_t mosi, uint64_t now);
+
+#endif
@@ -0,0 +1,329 @@
+/**
+ * @file hub_test.c
+ * @author Lukas Ternjej
+ *
+ * Host test of the cut-through SPI hub (AVR_SPI_hub.c). Upstream master clocks messages into the hub SPI_STC_vect
+ * on the virtual clock, hub forwards every byte through USART in master SPI mode to a downstream slave model.
+ * Hub ISR routine reads SPDR, writes SPDR and returns at fixed cycles after it starts (SIM_HUB_*), so a byte is lost
+ * if the ISR routine starts reading it after the next byte has arrived, and a response byte is lost (write collision)
+ * if the hub writes SPDR after master has started the next byte. Master sends a message to a downstream slave and
+ * reads a response from it through the hub; forwarded bytes and response bytes are both checked.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_hub.h"
+#include "sim_node.h"
+
+#define SIM_BYTE_OVERHEAD    12     // master cycles from the end of a byte to the first SCK edge of the next one
+
+// hub ISR routine cycles from the end of an upstream byte, estimated from the generated code
+#define SIM_HUB_READ         22     // interrupt response, vector jump and prologue, then SPDR is read
+#define SIM_HUB_UDR_WRITE    30     // SPI_hubTarget is checked and UDR0 is written
+#define SIM_HUB_UDR_READ     5      // RXC0 poll loop and UDR0 read after the last downstream SCK edge
+#define SIM_HUB_EXIT         18     // SPDR write, epilogue and reti
+#define SIM_SELECT_WRITE     48     // header byte: SPI_hubSelect() selects downstream port, then SPDR is written
+#define SIM_SELECT_CYCLES    66
+#define SIM_PCINT_CYCLES     40     // SS pin change ISR routine, downstream port release
+
+#define SIM_MESSAGE_GAP      3200   // cycles between transactions
+#define SIM_PORTS            2
+#define SIM_MAX_BYTES        (DATA_LENGTH + 2)
+#define RESPONSE_LENGTH      4
+
+extern volatile uint8_t sim_SPDR, sim_SPSR;
+
+void SPI_STC_vect(void);     // ISR routines of the hub, plain functions in the simulator shim
+void PCINT0_vect(void);
+
+/**
+ * Structure that holds downstream slave model: bytes received while selected, response is its port number
+ * and the index of the byte in the transaction.
+ */
+typedef struct
+{
+    uint8_t rx[SIM_MAX_BYTES];
+    uint8_t count;
+} sim_downstream_t;
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    uint64_t now;                          // virtual clock, in hub cycles
+    uint64_t hubFree;                      // cycle when hub ISR routine returns
+    uint16_t ubrr;                         // downstream SCK is F_CPU / (2 * (ubrr + 1))
+    sim_downstream_t down[SIM_PORTS];
+    uint32_t strayBytes;                   // downstream bytes clocked while no port was selected
+    uint32_t lost;                         // upstream bytes overwritten before hub ISR routine read them
+    uint32_t collisions;                   // SPDR writes after master started the next byte
+} sim_hub_t;
+
+static sim_hub_t sim;
+
+static SPI_device_t ports[SIM_PORTS] = {{&PORTC, PC0, DEFAULT_SS_CONTROL, 0, 0}, {&PORTC, PC1, DEFAULT_SS_CONTROL, 0, 0}};
+
+static uint8_t sim_hubResponse(uint8_t port, uint8_t index)
+{
+    return 0x40 + port * 0x20 + index;
+}
+
+/**
+ * Function that clocks a byte on the downstream bus to the selected port.
+ */
+static uint8_t sim_hubUsartExchange(void *context, uint8_t txd)
+{
+    for(uint8_t p = 0; p < SIM_PORTS; p++)
+    {
+        if(PORTC & (1 << ports[p].SS_PORTxn))
+            continue;     // port isn't selected
+
+        sim_downstream_t *down = &sim.down[p];
+        uint8_t response = sim_hubResponse(p, down->count);
+
+        if(down->count < SIM_MAX_BYTES)
+            down->rx[down->count++] = txd;
+
+        return response;
+    }
+
+    sim.strayBytes++;
+
+    return DUMMY_CHAR;
+}
+
+static void sim_hubDelay(void *context, double us)
+{
+}
+
+static uint64_t sim_hubCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that runs upstream SS pin change ISR routine.
+ */
+static void sim_hubPinChange(uint64_t time, uint8_t level)
+{
+    uint64_t start = time > sim.hubFree ? time : sim.hubFree;
+
+    sim.now = start;
+    PINB = level ? (PINB | (1 << SS_PIN_PORTxn)) : (PINB & ~(1 << SS_PIN_PORTxn));
+    PCINT0_vect();
+    sim.hubFree = start + SIM_PCINT_CYCLES;
+}
+
+/**
+ * Function that clocks a transaction: SS low, tx[] shifted out by master, SS high. rx[] is what hub shifted out.
+ *
+ * @param start cycle of falling SS edge
+ * @param divider F_CPU / upstream SCK
+ * @param gap master cycles after every byte, SPI_device_t.byteGap * 3
+ * @return cycle after rising SS edge
+ */
+static uint64_t sim_hubTransaction(uint64_t start, int divider, int gap, const uint8_t tx[], uint8_t rx[], size_t size)
+{
+    uint64_t byteStart[SIM_MAX_BYTES + 1];
+    uint64_t downCycles = 16 * (sim.ubrr + 1);
+
+    sim_hubPinChange(start, 0);
+
+    byteStart[0] = start + SIM_BYTE_OVERHEAD;
+
+    for(size_t k = 0; k < size; k++)
+        byteStart[k + 1] = byteStart[k] + 8 * divider + SIM_BYTE_OVERHEAD + gap;
+
+    uint64_t release = byteStart[size];     // master releases SS after the last byte and its gap
+    uint8_t shift = sim_SPDR;               // byte in hub shift register when master starts a byte
+
+    for(size_t k = 0; k < size; k++)
+    {
+        uint64_t end = byteStart[k] + 8 * divider;
+        uint64_t start = end > sim.hubFree ? end : sim.hubFree;
+        bool last = (k == size - 1);
+
+        rx[k] = shift;
+        shift = tx[k];     // shift register holds the received byte until hub writes SPDR
+
+        if(last && start > release)
+        {
+            // SS pin change has priority over SPI_STC_vect, it forwards the pending byte
+            sim_SPDR = tx[k];
+            sim_SPSR |= (1 << SPIF);
+            break;
+        }
+
+        if(!last && start + SIM_HUB_READ > byteStart[k + 1] + 8 * divider)
+        {
+            sim.lost++;     // next byte overwrote this one
+            continue;
+        }
+
+        bool forwarded = (SPI_hubTarget != NULL);
+        uint64_t write = start + (forwarded ? SIM_HUB_UDR_WRITE + downCycles + SIM_HUB_UDR_READ : SIM_SELECT_WRITE);
+
+        sim.now = start;
+        sim_SPDR = tx[k];
+        SPI_STC_vect();
+        sim.hubFree = forwarded ? write + SIM_HUB_EXIT : start + SIM_SELECT_CYCLES;
+
+        if(last || write < byteStart[k + 1])
+            shift = sim_SPDR;
+
+        else
+            sim.collisions++;     // write collision, master shifts the received byte back
+    }
+
+    sim_hubPinChange(release, 1);
+    sim_SPSR &= ~(1 << SPIF);
+
+    return sim.hubFree > release ? sim.hubFree : release;
+}
+
+/**
+ * Function that runs transactions at one SCK rate and byte gap: a message to a downstream port, then a read of
+ * RESPONSE_LENGTH bytes from it, as SPI_hubTransmitString() and SPI_hubReceiveBytes() send them.
+ *
+ * @param forwardErrors messages that downstream slave didn't receive as sent
+ * @param responseErrors reads that master didn't receive as downstream slave sent them
+ */
+static void sim_hubRun(int divider, int byteGap, uint32_t transactions, uint32_t *forwardErrors, uint32_t *responseErrors)
+{
+    uint64_t t = 0;
+
+    memset(&sim.down, 0, sizeof(sim.down));
+    sim.now = sim.hubFree = 0;
+    sim.strayBytes = sim.lost = sim.collisions = 0;
+    *forwardErrors = *responseErrors = 0;
+
+    for(uint32_t n = 0; n < transactions; n++)
+    {
+        uint8_t port = rand() % SIM_PORTS;
+        uint8_t tx[SIM_MAX_BYTES], rx[SIM_MAX_BYTES];
+        size_t length = 1 + rand() % 16;
+
+        tx[0] = HUB_HEADER_CHAR + port;
+
+        for(size_t i = 1; i <= length; i++)
+            tx[i] = ' ' + rand() % 95;     // printable, first byte isn't escaped
+
+        tx[length + 1] = DATA_END_CHAR;
+
+        memset(&sim.down[port], 0, sizeof(sim.down[port]));
+        t = sim_hubTransaction(t, divider, 3 * byteGap, tx, rx, length + 2) + SIM_MESSAGE_GAP;
+
+        if(sim.down[port].count != length + 1 || memcmp(sim.down[port].rx, &tx[1], length + 1) != 0)
+            (*forwardErrors)++;
+
+        // header, one byte that clocks the first downstream byte into the hub, then the response
+        tx[0] = HUB_HEADER_CHAR + port;
+        memset(&tx[1], DUMMY_CHAR, RESPONSE_LENGTH + 1);
+
+        memset(&sim.down[port], 0, sizeof(sim.down[port]));
+        t = sim_hubTransaction(t, divider, 3 * byteGap, tx, rx, RESPONSE_LENGTH + 2) + SIM_MESSAGE_GAP;
+
+        bool error = false;
+
+        for(uint8_t i = 0; i < RESPONSE_LENGTH; i++)
+            error = error || rx[i + 2] != sim_hubResponse(port, i);
+
+        if(error)
+            (*responseErrors)++;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static const int dividers[] = {4, 8, 16, 32, 64};
+    static const int byteGaps[] = {0, 5, 10, 15, 20};
+    uint32_t transactions = 1000;
+    int option;
+    int status = 0;
+
+    while((option = getopt(argc, argv, "n:u:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            transactions = atoi(optarg);
+            break;
+        case 'u':
+            sim.ubrr = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n transactions] [-u ubrr]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // hub is an upstream slave, its SPI module is clocked by the test; polling SPIF doesn't clock a byte
+    sim_hooks = (sim_hooks_t){NULL, NULL, sim_hubDelay, sim_hubCycles, sim_hubUsartExchange};
+    srand(1);
+
+    PINB = (1 << SS_PIN_PORTxn);
+    SPI_init(SLAVE_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+    SPI_hubInit(ports, SIM_PORTS, MSB_FIRST, SPI_MODE_0, sim.ubrr);
+
+    printf("forward/response errors in %u messages and reads (lost bytes, write collisions), downstream ubrr %u\n",
+           transactions, sim.ubrr);
+    printf("SCK      ");
+
+    for(size_t g = 0; g < sizeof(byteGaps) / sizeof(byteGaps[0]); g++)
+        printf("byteGap_%-2d             ", byteGaps[g]);
+
+    printf("\n");
+
+    int minForward[sizeof(dividers) / sizeof(dividers[0])];
+    int minResponse[sizeof(dividers) / sizeof(dividers[0])];
+
+    for(size_t d = 0; d < sizeof(dividers) / sizeof(dividers[0]); d++)
+    {
+        minForward[d] = minResponse[d] = -1;
+        printf("/%-7d ", dividers[d]);
+
+        for(size_t g = 0; g < sizeof(byteGaps) / sizeof(byteGaps[0]); g++)
+        {
+            uint32_t forwardErrors, responseErrors;
+            char cell[40];
+
+            sim_hubRun(dividers[d], byteGaps[g], transactions, &forwardErrors, &responseErrors);
+
+            snprintf(cell, sizeof(cell), "%u/%u (%u, %u)", forwardErrors, responseErrors, sim.lost, sim.collisions);
+            printf("%-22s ", cell);
+
+            if(forwardErrors == 0 && minForward[d] < 0)
+                minForward[d] = byteGaps[g];
+
+            if(responseErrors == 0 && minResponse[d] < 0)
+                minResponse[d] = byteGaps[g];
+
+            if(sim.strayBytes != 0)
+                status = 1;     // hub clocked downstream without a selected port
+        }
+
+        printf("\n");
+    }
+
+    printf("\nsmallest error free byteGap (forward/response):");
+
+    for(size_t d = 0; d < sizeof(dividers) / sizeof(dividers[0]); d++)
+        printf("  /%d %d/%d", dividers[d], minForward[d], minResponse[d]);
+
+    printf("\n");
+
+    // byte gap recommended in README has to work at every SCK rate
+    for(size_t d = 0; d < sizeof(dividers) / sizeof(dividers[0]); d++)
+    {
+        if(sim.ubrr == 0 && (minForward[d] < 0 || minForward[d] > 15 || minResponse[d] < 0 || minResponse[d] > 15))
+            status = 1;
+    }
+
+    return status;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file imu_test.c
+ * @author Lukas Ternjej
+ *
+ * Host test of AVR_SPI_bmi160.c against the BMI160 model. Master firmware runs the real library
+ * on the virtual clock; sensor INT1 drives INT0 of the master. Every received sample is checked
+ * against the model sequence, and bus cost is compared with reading data registers one at a time.
+ * Bus meter (SPI_USE_METER) provides SS edges to the model and byte and transaction counts.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "AVR_SPI_bmi160.h"
+#include "AVR_SPI_meter.h"
+#include "bmi160_model.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU         16000000.0
+#define SIM_BYTE_OVERHEAD 12     // master cycles per byte spent outside of shifting (SPDR write, SPIF poll)
+#define SIM_CALL_OVERHEAD 40     // master cycles per SS transaction spent in function calls and SS control
+#define SIM_LOOP_US       50     // main loop period, other application work
+
+void INT0_vect(void);
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    bmi160_model_t model;
+    uint64_t now;               // virtual clock, in master cycles
+    uint64_t busyCycles;        // cycles that SCK was running
+    int divider;                // F_CPU / SCK
+    uint32_t transactions;      // last seen meter transaction count of the sensor
+} sim_imu_t;
+
+static sim_imu_t sim;
+
+/**
+ * Function that advances sensor to the virtual time and triggers INT0 on falling edge of sensor INT1.
+ */
+static void sim_imuAdvance(void)
+{
+    if(bmi160_modelAdvance(&sim.model, sim.now) && (EIMSK & (1 << INT0)))
+        INT0_vect();
+}
+
+static uint8_t sim_imuExchange(void *context, uint8_t mosi)
+{
+    uint64_t byteCycles = 8 * sim.divider + SIM_BYTE_OVERHEAD;
+
+    sim.now += byteCycles;
+    sim.busyCycles += byteCycles;
+
+    // meter counts SS assertions, a new count is a falling edge of sensor SS
+    if(SPI_meterCurrent != NULL && SPI_meterCurrent->transactions != sim.transactions)
+    {
+        sim.transactions = SPI_meterCurrent->transactions;
+        bmi160_modelSelect(&sim.model);
+    }
+
+    uint8_t miso = bmi160_modelExchange(&sim.model, mosi);
+    sim_imuAdvance();
+
+    return miso;
+}
+
+static void sim_imuDelay(void *context, double us)
+{
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+    sim_imuAdvance();
+}
+
+static uint64_t sim_imuCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that returns meter accounting of the sensor.
+ *
+ * @param device sensor on SPI bus
+ * @return meter accounting, NULL if sensor hasn't been selected yet
+ */
+static SPI_meterDevice_t *sim_imuMeter(SPI_device_t *device)
+{
+    for(uint8_t i = 0; i < SPI_meterDeviceCount; i++)
+    {
+        if(SPI_meterDevices[i].SS_PORTx == device->SS_PORTx && SPI_meterDevices[i].SS_PORTxn == device->SS_PORTxn)
+            return &SPI_meterDevices[i];
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct
+    {
+        uint8_t odr;
+        int hz;
+    } rates[] = {{BMI160_ODR_400HZ, 400}, {BMI160_ODR_800HZ, 800}, {BMI160_ODR_1600HZ, 1600}};
+    double durationMs = 1000.0;
+    int watermark = 8;
+    int option;
+
+    while((option = getopt(argc, argv, "d:w:")) != -1)
+    {
+        switch(option)
+        {
+        case 'd':
+            durationMs = atof(optarg);
+            break;
+        case 'w':
+            watermark = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-d duration_ms] [-w watermark]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_imuExchange, sim_imuDelay, sim_imuCycles};
+
+    printf("ODR_Hz  mode      samples  seqErr  bytes/smp  trans/smp  bus%%    cpu%%\n");
+
+    int status = 0;
+
+    for(size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        for(int burst = 1; burst >= 0; burst--)
+        {
+            SPI_device_t device = {&PORTB, PB1, DEFAULT_SS_CONTROL, 0, 0};
+            SPI_bmi160_t imu;
+            SPI_imuSample_t sample;
+            uint32_t samples = 0;
+            uint32_t sequenceErrors = 0;
+
+            bmi160_modelInit(&sim.model, SIM_F_CPU);
+            sim.now = 0;
+            sim.divider = 4;
+            sim.transactions = 0;
+            EIMSK = 0;
+
+            SPI_init(MASTER_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+            SPI_meterInit(METER_DIV64);
+
+            if(!SPI_bmi160Init(&imu, &device, ATTENTION_INT0, rates[r].odr, watermark))
+            {
+                printf("%-7d sensor didn't respond\n", rates[r].hz);
+                status = 1;
+                continue;
+            }
+
+            // measure only steady state
+            uint64_t start = sim.now;
+            uint64_t end = start + (uint64_t)(durationMs * SIM_F_CPU / 1000.0);
+            uint64_t busyStart = sim.busyCycles;
+            SPI_meterDevice_t *meter = sim_imuMeter(&device);
+            uint32_t bytesStart = meter->bytes;
+            uint32_t transactionsStart = sim.transactions;
+            uint32_t expected = sim.model.sampleIndex;
+            uint64_t nextPoll = start;
+
+            while(sim.now < end)
+            {
+                if(burst)
+                {
+                    SPI_bmi160Service(&imu);
+
+                    while(SPI_bmi160Read(&imu, &sample))
+                    {
+                        if(sample.gyro[0] != bmi160_modelGyroX(expected))
+                            sequenceErrors++;
+
+                        expected++;
+                        samples++;
+                    }
+                }
+
+                else
+                {
+                    // previous approach: poll every data register in its own transaction, once per sample period
+                    uint8_t *raw = (uint8_t *)&sample;
+
+                    if(sim.now >= nextPoll)
+                    {
+                        for(uint8_t i = 0; i < BMI160_FRAME_LENGTH; i++)
+                        {
+                            uint8_t command[2] = {(0x0C + i) | BMI160_READ, DUMMY_CHAR};
+                            uint8_t response[2];
+
+                            SPI_transferBytes(&device, command, response, 2);
+                            raw[i] = response[1];
+                        }
+
+                        samples++;
+                        nextPoll = sim.now + (uint64_t)(SIM_F_CPU / rates[r].hz);
+                    }
+                }
+
+                _delay_us(SIM_LOOP_US);
+            }
+
+            double duration = (double)(sim.now - start);
+            uint32_t bytes = meter->bytes - bytesStart;
+            uint32_t transactions = sim.transactions - transactionsStart;
+            double busy = (double)(sim.busyCycles - busyStart);
+            double cpu = busy + (double)transactions * SIM_CALL_OVERHEAD;
+
+            if(samples == 0)
+                samples = 1;
+
+            if(burst && (sequenceErrors > 0 || imu.overruns > 0 || sim.model.fifoOverflows > 0))
+                status = 1;
+
+            printf("%-7d %-9s %-8u %-7u %-10.1f %-10.2f %-7.2f %.2f\n", rates[r].hz, burst ? "burst" : "register", samples,
+                   sequenceErrors, (double)bytes / samples, (double)transactions / samples, 100.0 * busy / duration,
+                   100.0 * cpu / duration);
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file kv_test.c
+ * @author Lukas Ternjej
+ *
+ * Host benchmark of AVR_SPI_kv.c on a W25Q32 class flash model. Master firmware runs the real library on
+ * the virtual clock and updates configuration and calibration keys with random values, deletes some of them
+ * and restarts the store from flash; every value is checked against a shadow copy. Boot and lookup cost are
+ * compared with a plain record log that is scanned at boot, and records or summary entries cut off by reset
+ * are injected into flash. Bus meter (SPI_USE_METER) provides SS edges to the model and byte counts.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_kv.h"
+#include "AVR_SPI_meter.h"
+#include "flash25_model.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU         16000000.0
+#define SIM_BYTE_OVERHEAD 12     // master cycles per byte spent outside of shifting (SPDR write, SPIF poll)
+
+#define KV_ADDRESS    0x000000     // store area, 6 sectors
+#define SCAN_ADDRESS  0x100000     // plain record log, scanned at boot
+#define KEYS          24           // configuration and calibration keys
+#define REBOOT_PERIOD 250          // operations between restarts
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    flash25_model_t model;
+    uint64_t now;                                   // virtual clock, in master cycles
+    uint8_t shadow[KEYS][KV_MAX_VALUE_LENGTH];      // expected values
+    uint8_t shadowLength[KEYS];                     // 0 if key is deleted
+} sim_kv_t;
+
+static sim_kv_t sim;
+
+/**
+ * Structure that holds bus cost of an operation.
+ */
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t transactions;
+    uint64_t cycles;
+} sim_kvCost_t;
+
+/**
+ * Function that passes SS state from bus meter to the memory model.
+ */
+static void sim_kvSync(void)
+{
+    uint32_t transactions = SPI_meterDeviceCount > 0 ? SPI_meterDevices[0].transactions : 0;
+
+    flash25_modelSync(&sim.model, SPI_meterCurrent != NULL, transactions, sim.now);
+}
+
+static uint8_t sim_kvExchange(void *context, uint8_t mosi)
+{
+    sim_kvSync();
+    sim.now += 8 * 4 + SIM_BYTE_OVERHEAD;     // FOSC_DIV4
+
+    return flash25_modelExchange(&sim.model, mosi, sim.now);
+}
+
+static void sim_kvDelay(void *context, double us)
+{
+    sim_kvSync();
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+}
+
+static uint64_t sim_kvCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that starts measuring bus cost.
+ */
+static void sim_kvCostStart(sim_kvCost_t *cost)
+{
+    cost->bytes = SPI_meterDeviceCount > 0 ? SPI_meterDevices[0].bytes : 0;
+    cost->transactions = SPI_meterDeviceCount > 0 ? SPI_meterDevices[0].transactions : 0;
+    cost->cycles = sim.now;
+}
+
+/**
+ * Function that turns start values into bus cost since sim_kvCostStart().
+ */
+static void sim_kvCostStop(sim_kvCost_t *cost)
+{
+    cost->bytes = SPI_meterDevices[0].bytes - cost->bytes;
+    cost->transactions = SPI_meterDevices[0].transactions - cost->transactions;
+    cost->cycles = sim.now - cost->cycles;
+}
+
+/**
+ * Function that checks every key against the shadow copy.
+ *
+ * @return number of wrong keys
+ */
+static uint32_t sim_kvVerify(SPI_kv_t *kv)
+{
+    uint8_t value[KV_MAX_VALUE_LENGTH];
+    uint32_t errors = 0;
+
+    for(uint16_t k = 0; k < KEYS; k++)
+    {
+        uint8_t length = SPI_kvGet(kv, 0x100 + k, value, sizeof(value));
+
+        if(length != sim.shadowLength[k] || memcmp(value, sim.shadow[k], length) != 0)
+            errors++;
+    }
+
+    return errors;
+}
+
+/**
+ * Function that writes raw bytes into flash model, as a program that was cut off by reset.
+ */
+static void sim_kvInject(uint32_t address, const uint8_t data[], uint16_t numBytes)
+{
+    for(uint16_t i = 0; i < numBytes; i++)
+        sim.model.memory[address + i] &= data[i];
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t operations = 4000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            operations = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n operations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_kvExchange, sim_kvDelay, sim_kvCycles};
+
+    SPI_device_t device = {&PORTB, PB1, DEFAULT_SS_CONTROL, 0, 0};
+    SPI_flash_t flash;
+    SPI_kv_t kv;
+    uint8_t value[KV_MAX_VALUE_LENGTH];
+    uint32_t errors = 0;
+    uint32_t puts = 0, deletes = 0, reboots = 0, compactions = 0;
+    uint32_t scanEnd = 0;
+    sim_kvCost_t boot, lookup, scan;
+    int status = 0;
+
+    flash25_modelInit(&sim.model, false, SIM_F_CPU);
+    SPI_init(MASTER_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+    SPI_meterInit(METER_DIV64);
+
+    if(!SPI_flashInit(&flash, &device))
+    {
+        printf("flash didn't respond\n");
+        return 1;
+    }
+
+    SPI_kvInit(&kv, &flash, KV_ADDRESS);
+    srand(1);
+
+    for(uint32_t n = 0; n < operations; n++)
+    {
+        uint16_t k = rand() % KEYS;
+
+        // calibration keys (upper half) are longer and change less often
+        if(k >= KEYS / 2 && rand() % 4 != 0)
+            k -= KEYS / 2;
+
+        if(rand() % 20 == 0)
+        {
+            if(SPI_kvDelete(&kv, 0x100 + k) != (sim.shadowLength[k] > 0))
+                errors++;
+
+            sim.shadowLength[k] = 0;
+            deletes++;
+        }
+
+        else
+        {
+            uint8_t length = (k < KEYS / 2) ? 4 + rand() % 12 : 24 + rand() % 24;
+
+            for(uint8_t i = 0; i < length; i++)
+                value[i] = rand();
+
+            // unchanged values are common, store doesn't write them again
+            if(rand() % 4 == 0 && sim.shadowLength[k] > 0)
+            {
+                length = sim.shadowLength[k];
+                memcpy(value, sim.shadow[k], length);
+            }
+
+            if(!SPI_kvPut(&kv, 0x100 + k, value, length))
+                errors++;
+
+            memcpy(sim.shadow[k], value, length);
+            sim.shadowLength[k] = length;
+            puts++;
+
+            // the same update in a plain record log: key, length, value, every byte programmed on its own
+            uint8_t header[3] = {0x100 + k, (0x100 + k) >> 8, length};
+
+            for(uint8_t i = 0; i < 3 + length; i++)
+                SPI_flashProgram(&flash, SCAN_ADDRESS + scanEnd++, i < 3 ? &header[i] : &value[i - 3], 1);
+        }
+
+        if((n + 1) % REBOOT_PERIOD == 0)
+        {
+            compactions += kv.compactions;
+
+            if(!SPI_kvInit(&kv, &flash, KV_ADDRESS))
+                errors++;
+
+            errors += sim_kvVerify(&kv);
+            reboots++;
+        }
+    }
+
+    SPI_flashWait(&flash);
+
+    // boot of the plain record log: every record header is read on its own until the erased end
+    uint32_t latest[KEYS];
+    uint32_t position = 0;
+
+    sim_kvCostStart(&scan);
+
+    while(1)
+    {
+        uint8_t header[3];
+
+        SPI_flashRead(&flash, SCAN_ADDRESS + position, header, 3);
+
+        if(header[0] == 0xFF && header[1] == 0xFF)
+            break;
+
+        latest[((header[0] | (header[1] << 8)) - 0x100) % KEYS] = position;
+        position += 3 + header[2];
+    }
+
+    sim_kvCostStop(&scan);
+    (void)latest;
+
+    sim_kvCostStart(&boot);
+    SPI_kvInit(&kv, &flash, KV_ADDRESS);
+    sim_kvCostStop(&boot);
+
+    sim_kvCostStart(&lookup);
+    errors += sim_kvVerify(&kv);
+    sim_kvCostStop(&lookup);
+
+    printf("%u operations (%u puts, %u deletes, %u restarts), %u keys stored, %u compactions\n\n", operations, puts,
+           deletes, reboots, kv.keys, compactions + kv.compactions);
+    printf("operation            bus_bytes  transactions  time_ms\n");
+    printf("%-20s %-10u %-13u %.2f\n", "boot, record scan", scan.bytes, scan.transactions, scan.cycles * 1e3 / SIM_F_CPU);
+    printf("%-20s %-10u %-13u %.2f\n", "boot, kv summary", boot.bytes, boot.transactions, boot.cycles * 1e3 / SIM_F_CPU);
+    printf("%-20s %-10.1f %-13.1f %.3f\n", "kv lookup", (double)lookup.bytes / KEYS, (double)lookup.transactions / KEYS,
+           lookup.cycles * 1e3 / SIM_F_CPU / KEYS);
+
+    // record written, summary entry cut off by reset: old value stays, next put compacts
+    uint16_t k = 0;
+
+    while(sim.shadowLength[k] == 0)
+        k++;
+
+    uint32_t erases = sim.model.erases;
+    uint8_t orphan[8] = {0x00 + k, 0x01, 4, 0x12, 0xAA, 0xBB, 0xCC, 0xDD};
+    uint32_t data = KV_ADDRESS + (uint32_t)kv.bank * (1 + KV_BANK_SECTORS) * FLASH_SECTOR_LENGTH + FLASH_SECTOR_LENGTH;
+
+    sim_kvInject(data + kv.dataEnd, orphan, sizeof(orphan));
+    SPI_kvInit(&kv, &flash, KV_ADDRESS);
+    errors += sim_kvVerify(&kv);
+
+    value[0] = 0x5A;
+    SPI_kvPut(&kv, 0x100 + k, value, 1);
+    sim.shadow[k][0] = 0x5A;
+    sim.shadowLength[k] = 1;
+    SPI_kvInit(&kv, &flash, KV_ADDRESS);
+    errors += sim_kvVerify(&kv);
+
+    // summary entry cut off by reset
+    uint8_t torn[3] = {0x00 + k, 0x01, 0x00};
+    uint32_t summary = KV_ADDRESS + (uint32_t)kv.bank * (1 + KV_BANK_SECTORS) * FLASH_SECTOR_LENGTH;
+
+    sim_kvInject(summary + kv.summaryEnd, torn, sizeof(torn));
+    SPI_kvInit(&kv, &flash, KV_ADDRESS);
+    errors += sim_kvVerify(&kv);
+
+    value[0] = 0xA5;
+    SPI_kvPut(&kv, 0x100 + k, value, 1);
+    sim.shadow[k][0] = 0xA5;
+    SPI_kvInit(&kv, &flash, KV_ADDRESS);
+    errors += sim_kvVerify(&kv);
+
+    printf("\nreset injection: %u erases for recovery, %u errors, %u program faults\n", sim.model.erases - erases,
+           errors, sim.model.programFaults);
+
+    if(errors > 0 || sim.model.programFaults > 0)
+        status = 1;
+
+    flash25_modelFree(&sim.model);
+
+    return status;
+}
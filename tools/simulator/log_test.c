@@ -0,0 +1,374 @@
+/**
+ * @file log_test.c
+ * @author Lukas Ternjej
+ *
+ * Host benchmark of AVR_SPI_log.c on a W25Q32 class flash model. Master firmware runs the real library
+ * on the virtual clock. Compares programming every sample on its own with the logger in a burst and at
+ * sustained rates that wrap the log area several times, then restarts the logger from flash and checks
+ * every record, seeks by time and sector wear. Bus meter (SPI_USE_METER) provides SS edges to the model.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_log.h"
+#include "AVR_SPI_meter.h"
+#include "flash25_model.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU         16000000.0
+#define SIM_BYTE_OVERHEAD 12     // master cycles per byte spent outside of shifting (SPDR write, SPIF poll)
+#define SIM_LOOP_US       10     // main loop period when there is nothing to log
+
+#define AREA_ADDRESS  0x10000     // log area, after 64KB of other data
+#define AREA_SECTORS  32
+#define SAMPLE_LENGTH 16          // bytes in every sample
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    flash25_model_t model;
+    uint64_t now;               // virtual clock, in master cycles
+} sim_log_t;
+
+static sim_log_t sim;
+
+/**
+ * Function that passes SS state from bus meter to the memory model.
+ */
+static void sim_logSync(void)
+{
+    uint32_t transactions = SPI_meterDeviceCount > 0 ? SPI_meterDevices[0].transactions : 0;
+
+    flash25_modelSync(&sim.model, SPI_meterCurrent != NULL, transactions, sim.now);
+}
+
+static uint8_t sim_logExchange(void *context, uint8_t mosi)
+{
+    sim_logSync();
+    sim.now += 8 * 4 + SIM_BYTE_OVERHEAD;     // FOSC_DIV4
+
+    return flash25_modelExchange(&sim.model, mosi, sim.now);
+}
+
+static void sim_logDelay(void *context, double us)
+{
+    sim_logSync();
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+}
+
+static uint64_t sim_logCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that returns virtual time in microseconds, used as record timestamp.
+ */
+static uint32_t sim_logMicros(void)
+{
+    return (uint32_t)(sim.now * 1e6 / SIM_F_CPU);
+}
+
+/**
+ * Function that fills sample data: sample number, then bytes derived from it, so it can be checked after reading.
+ */
+static void sim_logSample(uint32_t n, uint8_t data[SAMPLE_LENGTH])
+{
+    memcpy(data, &n, 4);
+
+    for(int i = 4; i < SAMPLE_LENGTH; i++)
+        data[i] = (uint8_t)(n * 13 + i * 7);
+}
+
+/**
+ * Function that reads the whole log and checks that records are consecutive samples with increasing time.
+ *
+ * @return number of bad records
+ */
+static uint32_t sim_logCheck(SPI_log_t *log, uint32_t *count, uint32_t *first, uint32_t *last)
+{
+    SPI_logCursor_t cursor;
+    uint32_t timestamp;
+    uint32_t previous = 0;
+    uint32_t n = 0;
+    uint32_t errors = 0;
+    uint8_t data[SAMPLE_LENGTH];
+    uint8_t expected[SAMPLE_LENGTH];
+
+    SPI_logSeek(log, 0, &cursor);
+    *count = 0;
+
+    while(SPI_logRead(log, &cursor, &timestamp, data))
+    {
+        // the oldest record can be any sample, following ones are consecutive
+        if(*count == 0)
+        {
+            *first = timestamp;
+            memcpy(&n, data, 4);
+        }
+
+        sim_logSample(n, expected);
+
+        if(memcmp(data, expected, SAMPLE_LENGTH) != 0 || timestamp < previous)
+            errors++;
+
+        previous = timestamp;
+        *last = timestamp;
+        n++;
+        (*count)++;
+    }
+
+    return errors;
+}
+
+/**
+ * Function that runs the logger at a fixed sample rate; between samples the main loop calls SPI_logService().
+ *
+ * @return maximum append latency in microseconds
+ */
+static double sim_logRate(SPI_log_t *log, double rate, double durationMs, uint32_t *samples)
+{
+    uint64_t period = (uint64_t)(SIM_F_CPU / rate);
+    uint64_t next = sim.now;
+    uint64_t end = sim.now + (uint64_t)(durationMs * SIM_F_CPU / 1000.0);
+    uint64_t worst = 0;
+    uint8_t data[SAMPLE_LENGTH];
+
+    while(sim.now < end)
+    {
+        if(sim.now >= next)
+        {
+            uint64_t start = sim.now;
+
+            sim_logSample(*samples, data);
+            SPI_logAppend(log, sim_logMicros(), data);
+            (*samples)++;
+
+            if(sim.now - start > worst)
+                worst = sim.now - start;
+
+            next += period;
+
+            if(next < sim.now)
+                next = sim.now;     // samples that couldn't be taken in time are skipped
+        }
+
+        else
+        {
+            SPI_logService(log);
+            _delay_us(SIM_LOOP_US);
+        }
+    }
+
+    return worst * 1e6 / SIM_F_CPU;
+}
+
+int main(int argc, char *argv[])
+{
+    double durationMs = 2000.0;
+    int option;
+
+    while((option = getopt(argc, argv, "d:")) != -1)
+    {
+        switch(option)
+        {
+        case 'd':
+            durationMs = atof(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-d duration_ms]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_logExchange, sim_logDelay, sim_logCycles};
+
+    SPI_device_t device = {&PORTB, PB1, DEFAULT_SS_CONTROL, 0, 0};
+    SPI_flash_t flash;
+    SPI_log_t log;
+    uint32_t samples = 0;     // sample number, continues through all log modes
+    uint8_t data[SAMPLE_LENGTH];
+    int status = 0;
+
+    flash25_modelInit(&sim.model, false, SIM_F_CPU);
+    SPI_init(MASTER_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+    SPI_meterInit(METER_DIV64);
+
+    if(!SPI_flashInit(&flash, &device) || flash.size != sim.model.size)
+    {
+        printf("flash didn't respond\n");
+        return 1;
+    }
+
+    double recordBytes = SAMPLE_LENGTH + 4;
+    double pageUs = (4 + FLASH_PAGE_LENGTH) * (8 * 4 + SIM_BYTE_OVERHEAD) / 16.0 + 400.0;
+
+    printf("%d byte samples, FOSC_DIV4; page program bandwidth (transfer + tPP) %.1f KB/s\n\n", SAMPLE_LENGTH,
+           FLASH_PAGE_LENGTH / pageUs * 1000.0);
+    printf("mode                rate_smp/s  KB/s     stalls  suspends  max_append_us  page_programs  erases\n");
+
+    // previous approach: every sample programmed on its own into pre-erased flash
+    {
+        uint32_t programs = sim.model.pagePrograms;
+        uint64_t start = sim.now;
+        uint32_t n = 2000;
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            sim_logSample(i, data);
+            uint32_t address = 0x300000 + i * SAMPLE_LENGTH;
+            SPI_flashProgram(&flash, address, data, SAMPLE_LENGTH);
+        }
+
+        SPI_flashWait(&flash);
+        double seconds = (sim.now - start) / SIM_F_CPU;
+
+        printf("%-19s %-11.0f %-8.1f %-7s %-9s %-14s %-14u %s\n", "per-sample program", n / seconds,
+               n * SAMPLE_LENGTH / seconds / 1000.0, "-", "-", "-", sim.model.pagePrograms - programs, "-");
+    }
+
+    // logger burst into sectors that were erased while idle
+    {
+        SPI_logInit(&log, &flash, AREA_ADDRESS, AREA_SECTORS, SAMPLE_LENGTH);
+
+        while(log.erasedAhead < LOG_ERASE_AHEAD)
+            SPI_logService(&log);
+
+        SPI_flashWait(&flash);
+
+        uint32_t n = (LOG_ERASE_AHEAD + 1) * log.sectorRecords - 1;
+        uint64_t start = sim.now;
+        uint64_t worst = 0;
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            uint64_t t = sim.now;
+
+            sim_logSample(samples++, data);
+            SPI_logAppend(&log, sim_logMicros(), data);
+
+            if(sim.now - t > worst)
+                worst = sim.now - t;
+        }
+
+        SPI_logFlush(&log);
+        double seconds = (sim.now - start) / SIM_F_CPU;
+
+        printf("%-19s %-11.0f %-8.1f %-7u %-9u %-14.0f %-14u %u\n", "log burst", n / seconds,
+               n * recordBytes / seconds / 1000.0, log.stalls, log.suspends, worst * 1e6 / SIM_F_CPU, log.pagePrograms,
+               log.erases);
+    }
+
+    // logger at sustained rates, every rate wraps the log area
+    static const double rates[] = {1000, 2000, 3000, 4000};
+
+    SPI_logInit(&log, &flash, AREA_ADDRESS, AREA_SECTORS, SAMPLE_LENGTH);
+
+    for(size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        uint32_t stalls = log.stalls;
+        uint32_t suspends = log.suspends;
+        uint32_t programs = log.pagePrograms;
+        uint32_t erases = log.erases;
+        uint32_t first = samples;
+        uint64_t start = sim.now;
+
+        double worst = sim_logRate(&log, rates[r], durationMs, &samples);
+        double seconds = (sim.now - start) / SIM_F_CPU;
+        char name[32];
+
+        snprintf(name, sizeof(name), "log %.0f/s", rates[r]);
+        printf("%-19s %-11.0f %-8.1f %-7u %-9u %-14.0f %-14u %u\n", name, (samples - first) / seconds,
+               (samples - first) * recordBytes / seconds / 1000.0, log.stalls - stalls, log.suspends - suspends, worst,
+               log.pagePrograms - programs, log.erases - erases);
+    }
+
+    SPI_logFlush(&log);
+
+    // restart from flash: index is rebuilt from sector headers, and appending continues after the newest record
+    uint32_t before, after, first, last, firstAfter, lastAfter;
+    uint32_t errors = sim_logCheck(&log, &before, &first, &last);
+
+    SPI_logInit(&log, &flash, AREA_ADDRESS, AREA_SECTORS, SAMPLE_LENGTH);
+    errors += sim_logCheck(&log, &after, &firstAfter, &lastAfter);
+
+    if(after != before || lastAfter != last)
+        errors++;
+
+    for(int i = 0; i < 100; i++)
+    {
+        sim_logSample(samples++, data);
+        SPI_logAppend(&log, sim_logMicros(), data);
+    }
+
+    SPI_logFlush(&log);
+    errors += sim_logCheck(&log, &after, &firstAfter, &lastAfter);
+
+    printf("\nrestart: %u records kept (%.0f%% of area), %u errors after restart and append\n", before,
+           100.0 * before / (AREA_SECTORS * log.sectorRecords), errors);
+
+    // seek: the first record at or after a random time
+    uint32_t seekErrors = 0;
+    uint32_t seekBytes = SPI_meterDevices[0].bytes;
+    uint32_t seekTransactions = SPI_meterDevices[0].transactions;
+    int seeks = 200;
+
+    srand(1);
+
+    for(int i = 0; i < seeks; i++)
+    {
+        uint32_t target = firstAfter + (uint32_t)((double)rand() / RAND_MAX * (lastAfter - firstAfter));
+        SPI_logCursor_t cursor;
+        uint32_t timestamp, previous;
+
+        SPI_logSeek(&log, target, &cursor);
+
+        // record before cursor has to be earlier than target
+        if(!SPI_logRead(&log, &cursor, &timestamp, data) || timestamp < target)
+            seekErrors++;
+
+        SPI_logCursor_t back = cursor;
+
+        if(back.record >= 2)
+        {
+            back.record -= 2;
+
+            if(SPI_logRead(&log, &back, &previous, data) && previous >= target)
+                seekErrors++;
+        }
+    }
+
+    printf("seek: %d seeks, %u errors, %.1f bus bytes and %.1f transactions per seek\n", seeks, seekErrors,
+           (double)(SPI_meterDevices[0].bytes - seekBytes) / seeks,
+           (double)(SPI_meterDevices[0].transactions - seekTransactions) / seeks);
+
+    // wear: every log sector is erased once per pass
+    uint32_t minErase = UINT32_MAX, maxErase = 0;
+
+    for(int s = 0; s < AREA_SECTORS; s++)
+    {
+        uint32_t count = sim.model.sectorErases[AREA_ADDRESS / 4096 + s];
+
+        if(count < minErase)
+            minErase = count;
+
+        if(count > maxErase)
+            maxErase = count;
+    }
+
+    printf("wear: sector erases min %u, max %u; program faults %u\n", minErase, maxErase, sim.model.programFaults);
+
+    if(errors > 0 || seekErrors > 0 || sim.model.programFaults > 0 || maxErase - minErase > 1)
+        status = 1;
+
+    flash25_modelFree(&sim.model);
+
+    return status;
+}
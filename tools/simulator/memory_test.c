@@ -0,0 +1,340 @@
+/**
+ * @file memory_test.c
+ * @author Lukas Ternjej
+ *
+ * Host test of the 25xx memory personality (AVR_SPI_memory.c) against the 25LC512 class EEPROM model
+ * (flash25_model.c) with the page size and memory map of the slave. Test master clocks the same transactions
+ * into the slave ISR routines and into the model: READ of EEPROM, PROGMEM and unmapped addresses, WRITE that
+ * wraps within a page, WREN/WRDI, commands while write is in progress and RDSR polling. Every byte that a 25xx
+ * memory defines (read data and status) is compared, and the EEPROM content is compared at the end.
+ * ISR routines run between bytes, byte gap timing isn't simulated.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/pgmspace.h>
+
+#include "AVR_SPI_memory.h"
+#include "flash25_model.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU         16000000.0
+#define SIM_BYTE_CYCLES   (8 * 4 + 12)     // FOSC_DIV4 byte and master overhead
+#define SIM_IDLE_US       100              // main loop period, SPI_memoryService() is called once per period
+#define SIM_MAX_BYTES     (3 + 2 * MEMORY_PAGE_LENGTH + 8)
+#define SIM_PROGMEM_BYTES 48
+
+extern volatile uint8_t sim_SPDR, sim_SPSR;
+extern uint8_t sim_eeprom[E2END + 1];
+
+void SPI_STC_vect(void);     // ISR routines of the slave, plain functions in the simulator shim
+void PCINT0_vect(void);
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    flash25_model_t model;
+    uint64_t now;                  // virtual clock, in slave cycles
+    uint32_t transactions;
+    uint32_t errors;               // bytes where slave and model differ
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t wraps;                // writes that wrapped within a page
+    uint32_t busyCommands;         // commands sent while write was in progress
+    uint32_t pendingBytes;         // last bytes decoded by SS pin change ISR routine
+    uint32_t polls;                // RDSR polls until write was finished
+} sim_memory_t;
+
+static sim_memory_t sim;
+
+static const uint8_t progmemTable[SIM_PROGMEM_BYTES] PROGMEM = {
+    0x10, 0x21, 0x32, 0x43, 0x54, 0x65, 0x76, 0x87, 0x98, 0xA9, 0xBA, 0xCB, 0xDC, 0xED, 0xFE, 0x0F,
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF,
+    0x5A, 0xA5, 0x3C, 0xC3, 0x0F, 0xF0, 0x69, 0x96, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+};
+
+static void sim_memoryDelay(void *context, double us)
+{
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+}
+
+static uint64_t sim_memoryCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that runs slave main loop for a time, SPI_memoryService() once per SIM_IDLE_US.
+ *
+ * @param us time in microseconds
+ */
+static void sim_memoryIdle(uint32_t us)
+{
+    for(uint32_t t = 0; t < us; t += SIM_IDLE_US)
+    {
+        SPI_memoryService();
+        sim_memoryDelay(NULL, SIM_IDLE_US);
+    }
+}
+
+/**
+ * Function that clocks a transaction into the slave and the model: SS low, tx[] shifted out, SS high.
+ * Last byte is sometimes left for SS pin change ISR routine, as if SS rose before SPI_STC_vect ran.
+ *
+ * @param tx bytes from master
+ * @param slaveRx bytes that slave shifted out
+ * @param modelRx bytes that the model shifted out
+ * @param size number of bytes
+ */
+static void sim_memoryTransaction(const uint8_t tx[], uint8_t slaveRx[], uint8_t modelRx[], size_t size)
+{
+    sim.transactions++;
+    flash25_modelSync(&sim.model, true, sim.transactions, sim.now);
+
+    PINB &= ~(1 << SS_PIN_PORTxn);
+    PCINT0_vect();
+
+    for(size_t k = 0; k < size; k++)
+    {
+        sim.now += SIM_BYTE_CYCLES;
+        modelRx[k] = flash25_modelExchange(&sim.model, tx[k], sim.now);
+        slaveRx[k] = sim_SPDR;
+        sim_SPDR = tx[k];
+
+        if(k == size - 1 && rand() % 4 == 0)
+        {
+            sim_SPSR |= (1 << SPIF);     // SS pin change has priority over SPI_STC_vect
+            sim.pendingBytes++;
+        }
+
+        else
+            SPI_STC_vect();
+    }
+
+    PINB |= (1 << SS_PIN_PORTxn);
+    PCINT0_vect();
+    sim_SPSR &= ~(1 << SPIF);
+
+    flash25_modelSync(&sim.model, false, sim.transactions, sim.now);
+}
+
+/**
+ * Function that compares bytes from first on, where the command defines MISO.
+ *
+ * @return true if slave and model shifted out the same bytes
+ */
+static bool sim_memoryCompare(const uint8_t slaveRx[], const uint8_t modelRx[], size_t first, size_t size)
+{
+    bool equal = true;
+
+    for(size_t k = first; k < size; k++)
+    {
+        if(slaveRx[k] != modelRx[k])
+        {
+            sim.errors++;
+            equal = false;
+        }
+    }
+
+    return equal;
+}
+
+/**
+ * Function that sends a command with optional 16-bit address and data bytes, and compares data bytes that
+ * slave and model shifted out.
+ *
+ * @param command 25xx command
+ * @param address memory address, used by READ and WRITE
+ * @param data bytes after the address, NULL to clock dummy bytes
+ * @param length number of bytes after command and address
+ * @param status slave status byte, for RDSR; NULL if not needed
+ */
+static void sim_memoryCommand(uint8_t command, uint16_t address, const uint8_t data[], size_t length, uint8_t *status)
+{
+    uint8_t tx[SIM_MAX_BYTES], slaveRx[SIM_MAX_BYTES], modelRx[SIM_MAX_BYTES];
+    size_t header = (command == MEMORY_CMD_READ || command == MEMORY_CMD_WRITE) ? 3 : 1;
+
+    tx[0] = command;
+    tx[1] = address >> 8;
+    tx[2] = address;
+
+    for(size_t i = 0; i < length; i++)
+        tx[header + i] = data != NULL ? data[i] : DUMMY_CHAR;
+
+    sim_memoryTransaction(tx, slaveRx, modelRx, header + length);
+
+    // WRITE and single byte commands have no defined MISO bytes, model shifts out 0xFF
+    if(command == MEMORY_CMD_READ || command == MEMORY_CMD_RDSR)
+        sim_memoryCompare(slaveRx, modelRx, header, header + length);
+
+    if(status != NULL)
+        *status = slaveRx[1];
+}
+
+/**
+ * Function that reads status register, compared with the model.
+ *
+ * @return slave status byte
+ */
+static uint8_t sim_memoryStatus(void)
+{
+    uint8_t status;
+
+    sim_memoryCommand(MEMORY_CMD_RDSR, 0, NULL, 1 + rand() % 3, &status);
+
+    return status;
+}
+
+/**
+ * Function that writes random bytes to a random EEPROM address, as a master does: WREN, WRITE, then RDSR until
+ * write is finished. Commands sent while write is in progress have to be ignored by both.
+ */
+static void sim_memoryWrite(void)
+{
+    uint8_t data[2 * MEMORY_PAGE_LENGTH];
+    uint16_t address = rand() % (E2END + 1);
+    size_t length = rand() % (2 * MEMORY_PAGE_LENGTH + 1);
+
+    for(size_t i = 0; i < length; i++)
+        data[i] = rand();
+
+    sim_memoryCommand(MEMORY_CMD_WREN, 0, NULL, 0, NULL);
+
+    if((sim_memoryStatus() & MEMORY_STATUS_WEL) == 0)
+        sim.errors++;
+
+    sim_memoryCommand(MEMORY_CMD_WRITE, address, data, length, NULL);
+    sim.writes++;
+
+    if((address & (MEMORY_PAGE_LENGTH - 1)) + length > MEMORY_PAGE_LENGTH)
+        sim.wraps++;
+
+    uint8_t status = sim_memoryStatus();
+
+    if(length == 0)
+    {
+        // write without data doesn't start a write cycle, write enable latch stays set
+        if(status != MEMORY_STATUS_WEL)
+            sim.errors++;
+
+        sim_memoryCommand(MEMORY_CMD_WRDI, 0, NULL, 0, NULL);
+        sim_memoryStatus();
+        return;
+    }
+
+    if(status != MEMORY_STATUS_WIP)
+        sim.errors++;
+
+    // busy memory only answers RDSR
+    sim_memoryCommand(MEMORY_CMD_WREN, 0, NULL, 0, NULL);
+    sim_memoryCommand(MEMORY_CMD_READ, rand(), NULL, 4, NULL);
+    sim_memoryStatus();
+    sim.busyCommands += 2;
+
+    // EEPROM of the slave programs a byte in 3.3ms, model page write takes 5ms; WIP is compared once both are ready
+    uint8_t tx[2] = {MEMORY_CMD_RDSR, DUMMY_CHAR}, slaveRx[2], modelRx[2];
+
+    do
+    {
+        sim_memoryIdle(SIM_IDLE_US);
+        sim_memoryTransaction(tx, slaveRx, modelRx, sizeof(tx));
+        sim.polls++;
+
+        if(slaveRx[1] & MEMORY_STATUS_WEL)
+            sim.errors++;
+    }
+    while(slaveRx[1] & MEMORY_STATUS_WIP);
+
+    while(sim.now < sim.model.busyUntil)
+        sim_memoryIdle(SIM_IDLE_US);
+
+    sim_memoryStatus();
+}
+
+/**
+ * Function that reads random bytes from EEPROM, PROGMEM block or unmapped addresses.
+ */
+static void sim_memoryRead(void)
+{
+    static const uint16_t regions[3][2] = {{0, E2END + 1}, {MEMORY_PROGMEM_ADDRESS, SIM_PROGMEM_BYTES}, {0, 0}};
+    uint8_t region = rand() % 3;
+    uint16_t address = region < 2 ? regions[region][0] + rand() % regions[region][1] : rand();
+
+    sim_memoryCommand(MEMORY_CMD_READ, address, NULL, 1 + rand() % (SIM_MAX_BYTES - 3), NULL);
+    sim.reads++;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t operations = 2000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            operations = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n operations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // slave SPI module is clocked by the test; polling SPIF doesn't clock a byte
+    sim_hooks = (sim_hooks_t){NULL, NULL, sim_memoryDelay, sim_memoryCycles, NULL};
+    srand(1);
+
+    flash25_modelInit(&sim.model, true, SIM_F_CPU);
+    sim.model.pageSize = MEMORY_PAGE_LENGTH;
+
+    for(uint16_t i = 0; i <= E2END; i++)
+        sim_eeprom[i] = sim.model.memory[i] = rand();
+
+    memcpy(&sim.model.memory[MEMORY_PROGMEM_ADDRESS], progmemTable, SIM_PROGMEM_BYTES);
+
+    PINB = (1 << SS_PIN_PORTxn);
+    SPI_init(SLAVE_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV4);
+    SPI_memoryInit(progmemTable, SIM_PROGMEM_BYTES);
+
+    // write without WREN and after WRDI is ignored
+    uint8_t data[4] = {1, 2, 3, 4};
+
+    sim_memoryCommand(MEMORY_CMD_WRITE, 0x0010, data, sizeof(data), NULL);
+    sim_memoryCommand(MEMORY_CMD_WREN, 0, NULL, 0, NULL);
+    sim_memoryCommand(MEMORY_CMD_WRDI, 0, NULL, 0, NULL);
+    sim_memoryCommand(MEMORY_CMD_WRITE, 0x0010, data, sizeof(data), NULL);
+
+    if(sim_memoryStatus() != 0)
+        sim.errors++;
+
+    for(uint32_t n = 0; n < operations; n++)
+    {
+        if(rand() % 3 == 0)
+            sim_memoryWrite();
+
+        else
+            sim_memoryRead();
+    }
+
+    uint32_t eepromErrors = 0;
+
+    for(uint16_t i = 0; i <= E2END; i++)
+        eepromErrors += sim_eeprom[i] != sim.model.memory[i];
+
+    printf("operations  reads  writes  wraps  busy_cmds  pending_last  rdsr_polls  byte_errors  eeprom_errors\n");
+    printf("%-11u %-6u %-7u %-6u %-10u %-13u %-11u %-12u %u\n", operations, sim.reads, sim.writes, sim.wraps,
+           sim.busyCommands, sim.pendingBytes, sim.polls, sim.errors, eepromErrors);
+
+    flash25_modelFree(&sim.model);
+
+    return sim.errors != 0 || eepromErrors != 0;
+}
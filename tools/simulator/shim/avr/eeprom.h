@@ -0,0 +1,65 @@
+/**
+ * @file eeprom.h
+ * @author Lukas Ternjej
+ *
+ * Host shim for <avr/eeprom.h>. Addresses 0 - E2END are the simulated EEPROM of the node (sim_node.c),
+ * where a byte write keeps EEPROM busy for its write time on the virtual clock. EEMEM variables are
+ * ordinary variables on host, their writes complete immediately.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_AVR_EEPROM_H_
+#define SIM_AVR_EEPROM_H_
+
+#include <stdint.h>
+
+#include <avr/io.h>
+
+#define EEMEM
+
+#define SIM_EEPROM_ADDRESS(address) ((uintptr_t)(address) <= E2END)     // no host variable is that low
+
+uint8_t sim_eepromRead(uint16_t address);
+void sim_eepromWrite(uint16_t address, uint8_t value);
+int sim_eepromIsReady(void);
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address)
+{
+    if(SIM_EEPROM_ADDRESS(address))
+        return sim_eepromRead((uintptr_t)address);
+
+    return *address;
+}
+
+static inline uint32_t eeprom_read_dword(const uint32_t *address)
+{
+    return *address;
+}
+
+static inline void eeprom_write_byte(uint8_t *address, uint8_t value)
+{
+    if(SIM_EEPROM_ADDRESS(address))
+        sim_eepromWrite((uintptr_t)address, value);
+
+    else
+        *address = value;
+}
+
+static inline void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+    if(eeprom_read_byte(address) != value)
+        eeprom_write_byte(address, value);
+}
+
+static inline void eeprom_update_dword(uint32_t *address, uint32_t value)
+{
+    *address = value;
+}
+
+static inline int eeprom_is_ready(void)
+{
+    return sim_eepromIsReady();
+}
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * @file interrupt.h
+ * @author Lukas Ternjej
+ *
+ * Host shim for <avr/interrupt.h>. Interrupt routines become plain functions
+ * that the simulator calls by name.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_AVR_INTERRUPT_H_
+#define SIM_AVR_INTERRUPT_H_
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+
+#define sei()
+#define cli()
+
+#endif
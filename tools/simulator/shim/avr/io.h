@@ -0,0 +1,112 @@
+/**
+ * @file io.h
+ * @author Lukas Ternjej
+ *
+ * Host shim for <avr/io.h>. Registers are plain variables of the simulated node,
+ * except SPDR, SPSR, UDR0, UCSR0A, TCNT1 and EEDR, which are accessed through functions so the simulator
+ * can clock SPI and USART master SPI transfers, run Timer1 from its virtual clock and read simulated EEPROM.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_AVR_IO_H_
+#define SIM_AVR_IO_H_
+
+#include <stdint.h>
+
+volatile uint8_t *sim_spdr(void);
+volatile uint8_t *sim_spsr(void);
+volatile uint16_t *sim_tcnt1(void);
+volatile uint8_t *sim_udr0(void);
+volatile uint8_t *sim_ucsr0a(void);
+volatile uint8_t *sim_eedr(void);
+
+#define SPDR   (*sim_spdr())
+#define SPSR   (*sim_spsr())
+#define TCNT1  (*sim_tcnt1())
+#define UDR0   (*sim_udr0())
+#define UCSR0A (*sim_ucsr0a())
+#define EEDR   (*sim_eedr())
+
+extern volatile uint8_t SPCR, SREG;
+extern volatile uint8_t PINB, DDRB, PORTB, PINC, DDRC, PORTC, PIND, DDRD, PORTD;
+extern volatile uint8_t TCCR1A, TCCR1B;
+extern volatile uint8_t MCUCR, GICR, EICRA, EIMSK, PCICR, PCMSK0, PCMSK1, PCMSK2;
+extern volatile uint8_t UCSR0B, UCSR0C;
+extern volatile uint16_t UBRR0;
+extern volatile uint8_t EECR;
+extern volatile uint16_t EEAR;
+
+// SPI
+#define SPIE  7
+#define SPE   6
+#define DORD  5
+#define MSTR  4
+#define CPOL  3
+#define CPHA  2
+#define SPR1  1
+#define SPR0  0
+#define SPIF  7
+#define WCOL  6
+#define SPI2X 0
+
+// ports
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// Timer1
+#define CS10 0
+#define CS11 1
+#define CS12 2
+
+// external and pin change interrupts
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+#define INT0  0
+#define INT1  1
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCINT2  2
+#define PCINT8  0
+#define PCINT11 3
+
+// USART in master SPI mode
+#define UMSEL01 7
+#define UMSEL00 6
+#define UDORD0  2
+#define UCPHA0  1
+#define UCPOL0  0
+#define RXEN0   4
+#define TXEN0   3
+#define RXC0    7
+#define TXC0    6
+#define UDRE0   5
+
+// EEPROM
+#define EERE  0
+#define E2END 0x1FF
+
+#endif
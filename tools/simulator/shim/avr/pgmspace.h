@@ -0,0 +1,21 @@
+/**
+ * @file pgmspace.h
+ * @author Lukas Ternjej
+ *
+ * Host shim for <avr/pgmspace.h>. Flash and RAM share one address space on host.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_AVR_PGMSPACE_H_
+#define SIM_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * @file delay.h
+ * @author Lukas Ternjej
+ *
+ * Host shim for <util/delay.h>. Delays advance the simulator virtual clock.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_UTIL_DELAY_H_
+#define SIM_UTIL_DELAY_H_
+
+void sim_delayUs(double us);
+
+#define _delay_us(us) sim_delayUs(us)
+#define _delay_ms(ms) sim_delayUs((ms) * 1000.0)
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file delay_basic.h
+ * @author Lukas Ternjej
+ *
+ * Host shim for <util/delay_basic.h>. Delay loops advance the simulator virtual clock.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_UTIL_DELAY_BASIC_H_
+#define SIM_UTIL_DELAY_BASIC_H_
+
+#include <stdint.h>
+
+void sim_delayUs(double us);
+
+// one _delay_loop_1() iteration takes 3 cycles, 0 means 256 iterations
+#define _delay_loop_1(count) sim_delayUs(((count) == 0 ? 256 : (count)) * 3.0 * 1000000.0 / F_CPU)
+
+// one _delay_loop_2() iteration takes 4 cycles, 0 means 65536 iterations
+#define _delay_loop_2(count) sim_delayUs(((count) == 0 ? 65536.0 : (count)) * 4.0 * 1000000.0 / F_CPU)
+
+#endif
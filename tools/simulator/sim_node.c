@@ -0,0 +1,190 @@
+/**
+ * @file sim_node.c
+ * @author Lukas Ternjej
+ *
+ * Register file and hooks of a single simulated AVR node.
+ * This file is linked with the library sources into a shared object; the simulator
+ * loads one copy of it per node, so every node has its own library state.
+ *
+ * @date 2026-10-18
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avr/io.h>
+
+#include "sim_node.h"
+
+#define SIM_EEPROM_WRITE_US 3300     // EEPROM byte write time (erase and write)
+
+volatile uint8_t SPCR, SREG;
+volatile uint8_t PINB, DDRB, PORTB, PINC, DDRC, PORTC, PIND, DDRD, PORTD;
+volatile uint8_t TCCR1A, TCCR1B;
+volatile uint8_t MCUCR, GICR, EICRA, EIMSK, PCICR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t UCSR0B, UCSR0C;
+volatile uint16_t UBRR0;
+
+// SPI registers, accessed by the library through sim_spdr() and sim_spsr()
+volatile uint8_t sim_SPDR = 0;
+volatile uint8_t sim_SPSR = 0;
+static volatile uint16_t sim_TCNT1 = 0;
+
+// USART registers, accessed by the library through sim_udr0() and sim_ucsr0a()
+static volatile uint8_t sim_UDR0 = 0;
+static volatile uint8_t sim_UCSR0A = 0;
+
+// EEPROM, read by the library through EEAR, EECR and sim_eedr(), written through <avr/eeprom.h>
+volatile uint8_t EECR;
+volatile uint16_t EEAR;
+uint8_t sim_eeprom[E2END + 1];
+static uint64_t sim_eepromBusyUntil = 0;     // virtual time when the last byte write ends
+
+static int spifRead = 0;     // SPSR was read with SPIF set, next SPDR access clears SPIF
+static int rxcRead = 0;      // UCSR0A was read with RXC0 set, next UDR0 access clears RXC0
+
+sim_hooks_t sim_hooks = {NULL, NULL, NULL, NULL, NULL};
+
+/**
+ * Function that returns SPDR register. Accessing SPDR after SPSR was read with SPIF set clears SPIF, as on AVR.
+ *
+ * @return pointer to SPDR register
+ */
+volatile uint8_t *sim_spdr(void)
+{
+    if(spifRead)
+    {
+        sim_SPSR &= ~(1 << 7);
+        spifRead = 0;
+    }
+
+    return &sim_SPDR;
+}
+
+/**
+ * Function that returns SPSR register. Master only polls SPIF after it wrote SPDR,
+ * so polling SPIF while it is clear clocks out SPDR through the simulator.
+ *
+ * @return pointer to SPSR register
+ */
+volatile uint8_t *sim_spsr(void)
+{
+    if(!(sim_SPSR & (1 << 7)) && sim_hooks.exchange != NULL)
+    {
+        sim_SPDR = sim_hooks.exchange(sim_hooks.context, sim_SPDR);
+        sim_SPSR |= (1 << 7);
+    }
+
+    if(sim_SPSR & (1 << 7))
+        spifRead = 1;
+
+    return &sim_SPSR;
+}
+
+/**
+ * Function that returns UDR0 register. Accessing UDR0 after UCSR0A was read with RXC0 set clears RXC0.
+ *
+ * @return pointer to UDR0 register
+ */
+volatile uint8_t *sim_udr0(void)
+{
+    if(rxcRead)
+    {
+        sim_UCSR0A &= ~(1 << 7);
+        rxcRead = 0;
+    }
+
+    return &sim_UDR0;
+}
+
+/**
+ * Function that returns UCSR0A register. USART in master SPI mode is only polled for RXC0 after UDR0 was written,
+ * so polling RXC0 while it is clear clocks out UDR0 through the simulator.
+ *
+ * @return pointer to UCSR0A register
+ */
+volatile uint8_t *sim_ucsr0a(void)
+{
+    if(!(sim_UCSR0A & (1 << 7)) && sim_hooks.usartExchange != NULL)
+    {
+        sim_UDR0 = sim_hooks.usartExchange(sim_hooks.context, sim_UDR0);
+        sim_UCSR0A |= (1 << 7);
+    }
+
+    if(sim_UCSR0A & (1 << 7))
+        rxcRead = 1;
+
+    return &sim_UCSR0A;
+}
+
+/**
+ * Function that returns Timer1 counter, derived from the virtual clock and Timer1 prescaler.
+ *
+ * @return pointer to TCNT1 register
+ */
+volatile uint16_t *sim_tcnt1(void)
+{
+    static const uint16_t prescaler[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+    uint16_t divider = prescaler[TCCR1B & 0x07];
+
+    if(divider != 0 && sim_hooks.cycles != NULL)
+        sim_TCNT1 = (uint16_t)(sim_hooks.cycles(sim_hooks.context) / divider);
+
+    return &sim_TCNT1;
+}
+
+/**
+ * Function that advances the virtual clock of the node.
+ *
+ * @param us delay in microseconds
+ */
+void sim_delayUs(double us)
+{
+    if(sim_hooks.delay != NULL)
+        sim_hooks.delay(sim_hooks.context, us);
+}
+
+/**
+ * Function that returns EEDR register, holding EEPROM byte at EEAR. Read strobe (EERE) takes no time on host.
+ *
+ * @return pointer to EEDR register
+ */
+volatile uint8_t *sim_eedr(void)
+{
+    return &sim_eeprom[EEAR & E2END];
+}
+
+/**
+ * Function that reads a byte of simulated EEPROM.
+ *
+ * @param address EEPROM address
+ * @return EEPROM byte
+ */
+uint8_t sim_eepromRead(uint16_t address)
+{
+    return sim_eeprom[address & E2END];
+}
+
+/**
+ * Function that writes a byte of simulated EEPROM, which stays busy for the write time.
+ *
+ * @param address EEPROM address
+ * @param value byte to write
+ */
+void sim_eepromWrite(uint16_t address, uint8_t value)
+{
+    sim_eeprom[address & E2END] = value;
+
+    if(sim_hooks.cycles != NULL)
+        sim_eepromBusyUntil = sim_hooks.cycles(sim_hooks.context) + (uint64_t)SIM_EEPROM_WRITE_US * (F_CPU / 1000000UL);
+}
+
+/**
+ * Function that checks if simulated EEPROM finished the last byte write.
+ *
+ * @return 1 if EEPROM is ready, 0 while it is writing
+ */
+int sim_eepromIsReady(void)
+{
+    return sim_hooks.cycles == NULL || sim_hooks.cycles(sim_hooks.context) >= sim_eepromBusyUntil;
+}
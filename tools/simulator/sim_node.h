@@ -0,0 +1,29 @@
+/**
+ * @file sim_node.h
+ * @author Lukas Ternjej
+ *
+ * Header file shared by the simulator and simulated nodes.
+ *
+ * @date 2026-10-18
+ */
+
+#ifndef SIM_NODE_H_
+#define SIM_NODE_H_
+
+#include <stdint.h>
+
+/**
+ * Structure with callbacks that the simulator sets in every loaded node.
+ */
+typedef struct
+{
+    void *context;                                       // simulator state of the node
+    uint8_t (*exchange)(void *context, uint8_t mosi);    // master clocks out a byte, returns MISO byte
+    void (*delay)(void *context, double us);             // node busy waits
+    uint64_t (*cycles)(void *context);                   // virtual clock, in CPU cycles
+    uint8_t (*usartExchange)(void *context, uint8_t txd);     // USART in master SPI mode clocks out a byte, returns received byte
+} sim_hooks_t;
+
+extern sim_hooks_t sim_hooks;
+
+#endif
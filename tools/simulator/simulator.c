@@ -0,0 +1,707 @@
+/**
+ * @file simulator.c
+ * @author Lukas Ternjej
+ *
+ * Host simulator of a multi-node SPI bus. One master and many slaves run the real library,
+ * each loaded as its own copy of the node shared object, on a shared virtual clock.
+ * Slave main loops are events on that clock; master firmware advances it by clocking bytes and by delays.
+ * Independent scenarios run in parallel, one per thread.
+ *
+ * @date 2026-10-18
+ */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "AVR_SPI_with_interrupts.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU           16000000.0     // node clock, Hz
+#define SIM_BYTE_OVERHEAD   12             // master cycles per byte spent outside of shifting (SPDR write, SPIF poll)
+#define SIM_SLAVE_ISR       60             // slave cycles per SPI_STC_vect, including interrupt entry and exit
+#define SIM_MAX_SLAVES      64
+#define SIM_SS_BANKS        (SIM_MAX_SLAVES / 8)
+#define SIM_FRAME_LENGTH    16
+#define SIM_RESPONSE_LENGTH 4              // 'R', request number (2 bytes), slave number
+
+/**
+ * Structure that holds library entry points of a loaded node.
+ */
+typedef struct
+{
+    void *handle;
+    sim_hooks_t *hooks;
+    volatile uint8_t *spdr;
+    void (*isr)(void);
+    void (*init)(uint8_t, uint8_t, uint8_t, uint8_t);
+    bool (*readAll)(void);
+    void (*transmitString)(volatile uint8_t *, uint8_t, uint8_t, char *);
+    void (*deviceTransmitString)(SPI_device_t *, char *);
+    void (*deviceReceiveBytes)(SPI_device_t *, uint8_t[], size_t);
+    bool (*pipelineExchange)(SPI_device_t *, const char *, uint8_t[], size_t);
+    bool (*queueResponse)(uint8_t[], size_t);
+    uint8_t *data;                        // SPI_data[], message returned by SPI_readAll()
+    void (*slaveReady)(void);
+    void (*getStats)(SPI_stats_t *);     // NULL if node isn't built with SPI_USE_STATS
+} sim_instance_t;
+
+/**
+ * Structure that holds simulated slave: library instance, main loop model and results.
+ */
+typedef struct
+{
+    sim_instance_t node;
+    uint64_t pollPeriod;     // cycles between two SPI_readAll() calls in slave main loop
+    uint64_t processing;     // cycles that slave spends on a received message
+    uint64_t nextPoll;       // virtual time of next SPI_readAll() call
+    uint64_t isrFreeAt;      // virtual time when slave finishes current ISR routine
+    uint64_t frameEnd;       // virtual time of last [DATA_END_CHAR]
+    uint32_t sent;
+    uint32_t intact;         // messages returned by SPI_readAll() as master sent them
+    uint32_t corrupt;        // messages returned by SPI_readAll() with wrong data or length
+    uint32_t bytesLost;
+    uint64_t latencySum;
+    uint64_t latencyMax;
+    uint8_t response[SIM_RESPONSE_LENGTH];
+    bool responsePending;    // response waits until SS is released, slave doesn't write SPDR during a transfer
+    uint16_t request;        // number of the last request master sent to this slave
+    bool requested;          // master has sent a request whose response it hasn't read yet
+} sim_slave_t;
+
+/**
+ * Structure that describes a scenario.
+ */
+typedef struct
+{
+    int slaves;             // number of slaves on the bus
+    uint8_t clockRate;      // FOSC_DIVx
+    int divider;            // F_CPU / SCK
+    double gapUs;           // master delay after each message
+    double pollMinUs;       // shortest slave main loop period
+    double pollMaxUs;       // longest slave main loop period
+    double durationMs;      // simulated time
+    bool pipelined;         // request/response workload: response is read with the next request
+    unsigned seed;
+} sim_scenario_t;
+
+/**
+ * Structure that holds scenario results.
+ */
+typedef struct
+{
+    uint32_t sent;
+    uint32_t intact;            // messages received as sent
+    uint32_t corrupt;           // messages received with wrong data or length
+    uint32_t overruns;          // reported by slaves through SPI_getStats()
+    uint32_t bytesLost;         // bytes that arrived while slave ISR routine was still busy
+    double latencyMeanUs;       // [DATA_END_CHAR] to SPI_readAll() returning true
+    double latencyMaxUs;
+    double busBusy;             // fraction of time that SCK was running
+    uint32_t requests;          // request/response workload: requests sent by master
+    uint32_t expected;          // responses that master read, every request but the first to each slave
+    uint32_t answered;          // responses that master received for the request it expected
+    uint32_t transactions;      // SS assertions by master
+    uint64_t bytes;             // bytes clocked by master
+    double elapsedMs;
+} sim_result_t;
+
+/**
+ * Structure that holds bus state of a running scenario.
+ */
+typedef struct
+{
+    const sim_scenario_t *scenario;
+    uint64_t now;                      // virtual clock, in CPU cycles
+    uint64_t busyCycles;
+    uint64_t bytes;                    // bytes clocked by master
+    volatile uint8_t ssBank[SIM_SS_BANKS];     // master SS lines, slave n is bit n % 8 of bank n / 8
+    sim_instance_t master;
+    sim_slave_t slaves[SIM_MAX_SLAVES];
+} sim_bus_t;
+
+static const char *nodePath = "./libavrspi_node.so";
+static bool paced = false;     // master paces bytes with SPI_device_t.byteGap so that slave ISR routine keeps up
+static bool requests = false;  // request/response workload instead of one-way messages
+static char tempDir[256];
+
+/**
+ * Function that builds the message that master sends, a status frame or request with its number.
+ *
+ * @param frame message, SIM_FRAME_LENGTH chars and '\0'
+ * @param number request number, not used for status frames
+ */
+static void sim_frame(char frame[], uint16_t number)
+{
+    if(requests)
+    {
+        snprintf(frame, SIM_FRAME_LENGTH + 1, "Q%04X%.*s", number, SIM_FRAME_LENGTH - 5, "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+        return;
+    }
+
+    for(int i = 0; i < SIM_FRAME_LENGTH; i++)
+        frame[i] = 'A' + (i % 26);
+
+    frame[SIM_FRAME_LENGTH] = '\0';
+}
+
+/**
+ * Function that loads a private copy of the node shared object.
+ *
+ * @param instance loaded node
+ * @param path path of the copy
+ * @return true if node is loaded
+ */
+static bool sim_load(sim_instance_t *instance, const char *path)
+{
+    instance->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+
+    if(instance->handle == NULL)
+    {
+        fprintf(stderr, "%s\n", dlerror());
+        return false;
+    }
+
+    instance->hooks = dlsym(instance->handle, "sim_hooks");
+    instance->spdr = dlsym(instance->handle, "sim_SPDR");
+    instance->isr = (void (*)(void))dlsym(instance->handle, "SPI_STC_vect");
+    instance->init = (void (*)(uint8_t, uint8_t, uint8_t, uint8_t))dlsym(instance->handle, "SPI_init");
+    instance->readAll = (bool (*)(void))dlsym(instance->handle, "SPI_readAll");
+    instance->transmitString = (void (*)(volatile uint8_t *, uint8_t, uint8_t, char *))dlsym(instance->handle, "SPI_transmitString");
+    instance->deviceTransmitString = (void (*)(SPI_device_t *, char *))dlsym(instance->handle, "SPI_deviceTransmitString");
+    instance->slaveReady = (void (*)(void))dlsym(instance->handle, "SPI_slaveReady");
+    instance->getStats = (void (*)(SPI_stats_t *))dlsym(instance->handle, "SPI_getStats");
+    instance->deviceReceiveBytes = (void (*)(SPI_device_t *, uint8_t[], size_t))dlsym(instance->handle, "SPI_deviceReceiveBytes");
+    instance->pipelineExchange = (bool (*)(SPI_device_t *, const char *, uint8_t[], size_t))dlsym(instance->handle, "SPI_pipelineExchange");
+    instance->queueResponse = (bool (*)(uint8_t[], size_t))dlsym(instance->handle, "SPI_queueResponse");
+    instance->data = dlsym(instance->handle, "SPI_data");
+
+    return instance->hooks && instance->spdr && instance->isr && instance->init && instance->readAll && instance->transmitString
+           && instance->deviceTransmitString && instance->deviceReceiveBytes && instance->pipelineExchange
+           && instance->queueResponse && instance->data;
+}
+
+/**
+ * Function that copies node shared object, dlopen() loads every path only once.
+ *
+ * @param destination path of the copy
+ * @return true if file is copied
+ */
+static bool sim_copyNode(const char *destination)
+{
+    int in = open(nodePath, O_RDONLY);
+    int out = open(destination, O_WRONLY | O_CREAT | O_TRUNC, 0700);
+    char buffer[65536];
+    ssize_t size;
+    bool ok = in >= 0 && out >= 0;
+
+    while(ok && (size = read(in, buffer, sizeof(buffer))) > 0)
+        ok = write(out, buffer, size) == size;
+
+    if(in >= 0)
+        close(in);
+
+    if(out >= 0)
+        close(out);
+
+    return ok;
+}
+
+/**
+ * Function that advances virtual clock, running slave main loops that are due on the way.
+ *
+ * @param bus bus state
+ * @param cycles number of CPU cycles
+ */
+static void sim_advance(sim_bus_t *bus, uint64_t cycles)
+{
+    uint64_t target = bus->now + cycles;
+
+    while(1)
+    {
+        sim_slave_t *next = NULL;
+
+        for(int i = 0; i < bus->scenario->slaves; i++)
+        {
+            if(bus->slaves[i].nextPoll <= target && (next == NULL || bus->slaves[i].nextPoll < next->nextPoll))
+                next = &bus->slaves[i];
+        }
+
+        if(next == NULL)
+            break;
+
+        if(next->nextPoll > bus->now)
+            bus->now = next->nextPoll;
+
+        int index = next - bus->slaves;
+
+        if(next->responsePending)
+        {
+            // slave queues its response only while it isn't selected
+            if(bus->ssBank[index / 8] & (1 << (index % 8)))
+            {
+                next->node.queueResponse(next->response, SIM_RESPONSE_LENGTH);
+                next->responsePending = false;
+            }
+
+            next->nextPoll = bus->now + next->pollPeriod;
+        }
+
+        else if(next->node.readAll())
+        {
+            const char *data = (const char *)next->node.data;
+            size_t length = strnlen(data, DATA_LENGTH);
+            char expected[SIM_FRAME_LENGTH + 1];
+            uint16_t number = 0;
+
+            if(requests)
+            {
+                // request is "Q" and 4 hex digits of request number
+                char digits[5] = {0};
+                memcpy(digits, &data[1], 4);
+
+                number = (uint16_t)strtoul(digits, NULL, 16);
+            }
+
+            sim_frame(expected, number);
+
+            // message has to be one that master sent to this slave, byte for byte
+            if(length == SIM_FRAME_LENGTH && memcmp(data, expected, length) == 0
+               && (!requests || (number != 0 && (uint16_t)(next->request - number) < 0x8000)))
+                next->intact++;
+
+            else
+                next->corrupt++;
+
+            if(requests)
+            {
+                // response echoes the request number
+                next->response[0] = 'R';
+                next->response[1] = number & 0xFF;
+                next->response[2] = number >> 8;
+                next->response[3] = index;
+                next->responsePending = true;
+            }
+
+            uint64_t latency = bus->now - next->frameEnd;
+
+            next->latencySum += latency;
+
+            if(latency > next->latencyMax)
+                next->latencyMax = latency;
+
+            next->nextPoll = bus->now + next->processing + (next->responsePending ? 0 : next->pollPeriod);
+        }
+
+        else
+            next->nextPoll = bus->now + next->pollPeriod;
+    }
+
+    bus->now = target;
+}
+
+/**
+ * Function that clocks a byte on the bus, it is called by master node when it polls SPIF.
+ *
+ * @param context bus state
+ * @param mosi byte in master SPDR register
+ * @return byte that selected slaves shifted out
+ */
+static uint8_t sim_exchange(void *context, uint8_t mosi)
+{
+    sim_bus_t *bus = context;
+    uint64_t byteCycles = 8 * bus->scenario->divider + SIM_BYTE_OVERHEAD;
+    uint8_t miso = DUMMY_CHAR;     // MISO is pulled up when no slave drives it
+
+    sim_advance(bus, byteCycles);
+    bus->busyCycles += byteCycles;
+    bus->bytes++;
+
+    for(int i = 0; i < bus->scenario->slaves; i++)
+    {
+        if(bus->ssBank[i / 8] & (1 << (i % 8)))
+            continue;     // slave isn't selected
+
+        sim_slave_t *slave = &bus->slaves[i];
+        uint64_t start = slave->isrFreeAt > bus->now ? slave->isrFreeAt : bus->now;
+
+        miso &= *slave->node.spdr;
+
+        if(mosi == DATA_END_CHAR)
+        {
+            slave->frameEnd = bus->now;
+            slave->sent++;
+        }
+
+        if(start - bus->now > byteCycles)
+        {
+            slave->bytesLost++;     // previous byte is still being handled, this one is overwritten
+            continue;
+        }
+
+        *slave->node.spdr = mosi;
+        slave->node.isr();
+        slave->isrFreeAt = start + SIM_SLAVE_ISR;
+    }
+
+    return miso;
+}
+
+static void sim_delay(void *context, double us)
+{
+    sim_bus_t *bus = context;
+    sim_advance(bus, (uint64_t)(us * SIM_F_CPU / 1e6));
+}
+
+static uint64_t sim_cycles(void *context)
+{
+    return ((sim_bus_t *)context)->now;
+}
+
+/**
+ * Function that runs a single scenario.
+ *
+ * @param scenario scenario that is simulated
+ * @param paths paths of node copies owned by the calling thread
+ * @param result scenario results
+ * @return true if scenario has run
+ */
+static bool sim_run(const sim_scenario_t *scenario, char paths[][300], sim_result_t *result)
+{
+    sim_bus_t *bus = calloc(1, sizeof(sim_bus_t));
+    unsigned seed = scenario->seed;
+    bool ok = true;
+
+    bus->scenario = scenario;
+    memset((void *)bus->ssBank, 0xFF, sizeof(bus->ssBank));     // SS lines are high when idle
+
+    for(int i = 0; i <= scenario->slaves && ok; i++)
+    {
+        sim_instance_t *node = (i == 0) ? &bus->master : &bus->slaves[i - 1].node;
+        ok = sim_load(node, paths[i]);
+
+        if(ok)
+            *node->hooks = (sim_hooks_t){bus, (i == 0) ? sim_exchange : NULL, sim_delay, sim_cycles};
+    }
+
+    memset(result, 0, sizeof(*result));
+
+    if(ok)
+    {
+        double usToCycles = SIM_F_CPU / 1e6;
+
+        for(int i = 0; i < scenario->slaves; i++)
+        {
+            sim_slave_t *slave = &bus->slaves[i];
+            double poll = scenario->pollMinUs + (scenario->pollMaxUs - scenario->pollMinUs) * (rand_r(&seed) / (double)RAND_MAX);
+
+            slave->pollPeriod = (uint64_t)(poll * usToCycles);
+            slave->processing = slave->pollPeriod / 2;
+            slave->nextPoll = rand_r(&seed) % (slave->pollPeriod + 1);
+
+            slave->node.init(SLAVE_MODE, MSB_FIRST, SPI_MODE_0, scenario->clockRate);
+
+            if(slave->node.slaveReady != NULL)
+                slave->node.slaveReady();
+        }
+
+        bus->master.init(MASTER_MODE, MSB_FIRST, SPI_MODE_0, scenario->clockRate);
+
+        char frame[SIM_FRAME_LENGTH + 1];
+        uint64_t duration = (uint64_t)(scenario->durationMs * 1000.0 * usToCycles);
+
+        sim_frame(frame, 0);
+
+        // slave device profiles, byte gap covers the part of slave ISR routine that is longer than a byte
+        SPI_device_t devices[SIM_MAX_SLAVES];
+        int byteCycles = 8 * scenario->divider + SIM_BYTE_OVERHEAD;
+        uint8_t byteGap = (paced && SIM_SLAVE_ISR > byteCycles) ? BYTE_GAP_CYCLES(SIM_SLAVE_ISR - byteCycles) : 0;
+
+        for(int i = 0; i < scenario->slaves; i++)
+            devices[i] = (SPI_device_t){&bus->ssBank[i / 8], i % 8, DEFAULT_SS_CONTROL, byteGap, 0};
+
+        uint32_t transactions = 0;
+
+        // master firmware: round robin status frames or requests to every slave
+        while(bus->now < duration)
+        {
+            for(int i = 0; i < scenario->slaves; i++)
+            {
+                if(requests)
+                {
+                    sim_slave_t *slave = &bus->slaves[i];
+                    uint8_t response[SIM_RESPONSE_LENGTH] = {0};
+                    bool expected = slave->requested;
+
+                    slave->request++;
+                    sim_frame(frame, slave->request);
+
+                    if(scenario->pipelined)
+                    {
+                        // response to the previous request comes back while this request is sent
+                        bus->master.pipelineExchange(&devices[i], frame, response, SIM_RESPONSE_LENGTH);
+                        transactions++;
+                    }
+
+                    else
+                    {
+                        // read the response to the previous request, then send this one
+                        if(expected)
+                        {
+                            bus->master.deviceReceiveBytes(&devices[i], response, SIM_RESPONSE_LENGTH);
+                            transactions++;
+                        }
+
+                        bus->master.deviceTransmitString(&devices[i], frame);
+                        transactions++;
+                    }
+
+                    uint16_t previous = slave->request - 1;
+
+                    if(expected)
+                        result->expected++;
+
+                    if(expected && response[0] == 'R' && response[1] == (previous & 0xFF) && response[2] == (previous >> 8)
+                       && response[3] == i)
+                        result->answered++;
+
+                    slave->requested = true;
+                    result->requests++;
+                }
+
+                else if(paced)
+                    bus->master.deviceTransmitString(&devices[i], frame);
+
+                else
+                    bus->master.transmitString(&bus->ssBank[i / 8], i % 8, DEFAULT_SS_CONTROL, frame);
+
+                if(!requests)
+                    transactions++;
+
+                if(scenario->gapUs > 0)
+                    sim_delay(bus, scenario->gapUs);
+            }
+        }
+
+        uint64_t elapsed = bus->now;
+        sim_advance(bus, (uint64_t)(2 * scenario->pollMaxUs * usToCycles));     // let slaves read the last messages
+
+        result->transactions = transactions;
+        result->bytes = bus->bytes;
+        result->elapsedMs = elapsed / usToCycles / 1000.0;
+
+        uint64_t latencySum = 0;
+        uint64_t latencyMax = 0;
+
+        for(int i = 0; i < scenario->slaves; i++)
+        {
+            sim_slave_t *slave = &bus->slaves[i];
+
+            result->sent += slave->sent;
+            result->intact += slave->intact;
+            result->corrupt += slave->corrupt;
+            result->bytesLost += slave->bytesLost;
+            latencySum += slave->latencySum;
+
+            if(slave->latencyMax > latencyMax)
+                latencyMax = slave->latencyMax;
+
+            if(slave->node.getStats != NULL)
+            {
+                SPI_stats_t stats;
+                slave->node.getStats(&stats);
+                result->overruns += stats.overruns;
+            }
+        }
+
+        uint32_t delivered = result->intact + result->corrupt;
+
+        result->latencyMeanUs = delivered ? latencySum / (double)delivered / usToCycles : 0;
+        result->latencyMaxUs = latencyMax / usToCycles;
+        result->busBusy = elapsed ? bus->busyCycles / (double)elapsed : 0;
+    }
+
+    for(int i = 0; i <= scenario->slaves; i++)
+    {
+        sim_instance_t *node = (i == 0) ? &bus->master : &bus->slaves[i - 1].node;
+
+        if(node->handle != NULL)
+            dlclose(node->handle);
+    }
+
+    free(bus);
+
+    return ok;
+}
+
+typedef struct
+{
+    const sim_scenario_t *scenarios;
+    sim_result_t *results;
+    bool *ok;
+    int count;
+    int next;     // index of next scenario, shared between threads
+    int maxSlaves;
+} sim_work_t;
+
+/**
+ * Function that runs scenarios until none is left, every thread owns its own node copies.
+ *
+ * @param argument shared work description
+ * @return NULL
+ */
+static void *sim_worker(void *argument)
+{
+    sim_work_t *work = argument;
+    static int threadCounter = 0;
+    int thread = __atomic_fetch_add(&threadCounter, 1, __ATOMIC_RELAXED);
+    char (*paths)[300] = calloc(work->maxSlaves + 1, sizeof(*paths));
+
+    for(int i = 0; i <= work->maxSlaves; i++)
+    {
+        snprintf(paths[i], sizeof(paths[i]), "%s/node_%d_%d.so", tempDir, thread, i);
+
+        if(!sim_copyNode(paths[i]))
+        {
+            fprintf(stderr, "can't copy %s to %s\n", nodePath, paths[i]);
+            free(paths);
+            return NULL;
+        }
+    }
+
+    int index;
+
+    while((index = __atomic_fetch_add(&work->next, 1, __ATOMIC_RELAXED)) < work->count)
+        work->ok[index] = sim_run(&work->scenarios[index], paths, &work->results[index]);
+
+    for(int i = 0; i <= work->maxSlaves; i++)
+        unlink(paths[i]);
+
+    free(paths);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    double durationMs = 100.0;
+    int option;
+
+    while((option = getopt(argc, argv, "n:t:d:pr")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            nodePath = optarg;
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'd':
+            durationMs = atof(optarg);
+            break;
+        case 'p':
+            paced = true;
+            break;
+        case 'r':
+            requests = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n node.so] [-t threads] [-d duration_ms] [-p] [-r]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(threads < 1)
+        threads = 1;
+
+    // scenario matrix: bus size x SPI clock x master gap between messages (x separate or pipelined response read)
+    static const int slaveCounts[] = {8, 16, 32, 48};
+    static const struct { uint8_t clockRate; int divider; } clocks[] = {{FOSC_DIV4, 4}, {FOSC_DIV16, 16}, {FOSC_DIV64, 64}};
+    static const double gaps[] = {0.0, 100.0};
+
+    // command slaves answer requests from a short main loop
+    double pollMinUs = requests ? 20.0 : 50.0;
+    double pollMaxUs = requests ? 50.0 : 500.0;
+    int modes = requests ? 2 : 1;
+
+    int count = 0;
+    sim_scenario_t scenarios[64];
+
+    for(size_t s = 0; s < sizeof(slaveCounts) / sizeof(slaveCounts[0]); s++)
+        for(size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+            for(size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++)
+                for(int m = 0; m < modes; m++)
+                    scenarios[count++] = (sim_scenario_t){slaveCounts[s], clocks[c].clockRate, clocks[c].divider, gaps[g], pollMinUs, pollMaxUs,
+                                                          durationMs, m == 1, 1234u + count};
+
+    snprintf(tempDir, sizeof(tempDir), "/tmp/avrspi_sim_XXXXXX");
+
+    if(mkdtemp(tempDir) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    sim_result_t results[64];
+    bool ok[64] = {false};
+    sim_work_t work = {scenarios, results, ok, count, 0, 48};
+    pthread_t *workers = calloc(threads, sizeof(pthread_t));
+
+    for(int i = 0; i < threads; i++)
+        pthread_create(&workers[i], NULL, sim_worker, &work);
+
+    for(int i = 0; i < threads; i++)
+        pthread_join(workers[i], NULL);
+
+    free(workers);
+    rmdir(tempDir);
+
+    if(requests)
+        printf("slaves  SCK     gap_us  mode      requests  answer%%  txn/req  bytes/req  req/ms  bus%%\n");
+
+    else
+        printf("slaves  SCK     gap_us  sent    intact  corrupt lost%%   overrun byteLost  lat_mean_us  lat_max_us  bus%%\n");
+
+    int status = 0;
+
+    for(int i = 0; i < count; i++)
+    {
+        if(!ok[i])
+        {
+            printf("%-7d scenario failed\n", scenarios[i].slaves);
+            status = 1;
+            continue;
+        }
+
+        sim_result_t *r = &results[i];
+
+        if(requests)
+        {
+            double answered = r->expected ? 100.0 * r->answered / r->expected : 0;
+
+            printf("%-7d /%-6d %-7.0f %-9s %-9u %-8.2f %-8.2f %-10.1f %-7.1f %.1f\n", scenarios[i].slaves, scenarios[i].divider,
+                   scenarios[i].gapUs, scenarios[i].pipelined ? "pipeline" : "separate", r->requests, answered,
+                   r->requests ? (double)r->transactions / r->requests : 0, r->requests ? (double)r->bytes / r->requests : 0,
+                   r->elapsedMs > 0 ? r->requests / r->elapsedMs : 0, 100.0 * r->busBusy);
+            continue;
+        }
+
+        double lost = r->sent ? 100.0 * (r->sent - r->intact - r->corrupt) / r->sent : 0;
+
+        printf("%-7d /%-6d %-7.0f %-7u %-7u %-7u %-7.2f %-7u %-9u %-12.1f %-11.1f %.1f\n", scenarios[i].slaves, scenarios[i].divider,
+               scenarios[i].gapUs, r->sent, r->intact, r->corrupt, lost, r->overruns, r->bytesLost, r->latencyMeanUs, r->latencyMaxUs,
+               100.0 * r->busBusy);
+    }
+
+    return status;
+}
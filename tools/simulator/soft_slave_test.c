@@ -0,0 +1,412 @@
+/**
+ * @file soft_slave_test.c
+ * @author Lukas Ternjej
+ *
+ * Host benchmark of the bit-banged software slave (AVR_SPI_soft_slave.c). Master waveform (SPI mode 0, MSB first)
+ * is generated on the virtual clock, every SCK and SS edge sets the pin change flag, and the slave pin change ISR
+ * routine runs when the flag is serviced. Pins are read at the cycles where the assembly routine reads them and
+ * every path takes its cycle count, so an edge is lost if the flag is still pending, and a bit is wrong if MOSI or
+ * MISO has changed before it is read. Master sends a frame per transaction and reads the response to the previous
+ * frame on MISO; both are checked. Finds the highest SCK rate without errors, with and without byte gap.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_soft_slave.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU 16000000.0
+
+// cycles of the assembly ISR routine from pin change, see AVR_SPI_soft_slave.c
+#define SIM_SYNC_CYCLES      2      // pin synchronizer, before pin change flag is set
+#define SIM_SS_READ          12     // cycle that reads SS
+#define SIM_SCK_READ         14     // cycle that reads SCK
+#define SIM_MOSI_READ        19     // cycle that reads MOSI
+#define SIM_MISO_WRITE       31     // cycle that writes MISO on falling SCK edge
+#define SIM_MISO_WRITE_IDLE  29     // cycle that writes MISO on falling edge between bytes
+#define SIM_RISING_CYCLES    32
+#define SIM_FALLING_CYCLES   43
+#define SIM_IDLE_CYCLES      41     // falling edge between bytes, or falling SS edge
+#define SIM_RELEASE_CYCLES   32     // rising SS edge
+#define SIM_BYTE_CYCLES      92     // rising edge that completes a byte, without SPI_softSlaveByte()
+#define SIM_RECEIVE_CYCLES   80     // SPI_softSlaveByte(), receive state machine with call-saved registers (estimate)
+
+#define SIM_SS_SETUP_CYCLES  10     // SS falling edge to the first SCK half period
+#define SIM_SS_HOLD_CYCLES   10     // last falling SCK edge to SS rising edge
+#define SIM_FRAME_GAP_US     200    // time between transactions, slave main loop runs in it
+#define SIM_EDGES            1024   // maximum number of pin changes per pin in a transaction
+
+#define RESPONSE_LENGTH 4
+
+/**
+ * Structure that holds pin changes of one pin in a transaction, in time order.
+ */
+typedef struct
+{
+    uint64_t time[SIM_EDGES];
+    uint8_t level[SIM_EDGES];
+    uint16_t count;
+} sim_pin_t;
+
+/**
+ * Structure that holds test state.
+ */
+typedef struct
+{
+    sim_pin_t ss, sck, mosi, miso;
+    uint64_t now;               // virtual clock, in slave cycles
+    uint64_t cpuFree;           // cycle when slave ISR routine returns
+    uint64_t flagStart;         // cycle when pending pin change flag is serviced
+    bool pending;               // pin change flag is set and not serviced yet
+    uint8_t rxBits;             // bits of the current byte seen by ISR routine, mirror of its marker bit
+    uint32_t edgesLost;         // SCK edges while pin change flag was already pending
+} sim_soft_t;
+
+static sim_soft_t sim;
+
+void SOFT_PCINT_vect(void);     // ISR routine of software slave, a plain function in the simulator shim
+
+static uint8_t sim_softExchange(void *context, uint8_t mosi)
+{
+    return DUMMY_CHAR;     // slave doesn't use SPI module
+}
+
+static void sim_softDelay(void *context, double us)
+{
+}
+
+static uint64_t sim_softCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that adds a pin change, changes to the same level are dropped.
+ */
+static void sim_softSet(sim_pin_t *pin, uint64_t time, uint8_t level)
+{
+    if(pin->count > 0 && pin->level[pin->count - 1] == level)
+        return;
+
+    pin->time[pin->count] = time;
+    pin->level[pin->count] = level;
+    pin->count++;
+}
+
+/**
+ * Function that returns pin level at a cycle, pin starts a transaction at level of its first change.
+ */
+static uint8_t sim_softLevel(const sim_pin_t *pin, uint64_t time)
+{
+    uint16_t low = 0, high = pin->count;
+
+    // first change after time
+    while(low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+
+        if(pin->time[middle] <= time)
+            low = middle + 1;
+
+        else
+            high = middle;
+    }
+
+    return low > 0 ? pin->level[low - 1] : !pin->level[0];
+}
+
+/**
+ * Function that runs slave pin change ISR routine from start cycle, with pins as they are on the cycles that read them.
+ */
+static void sim_softHandler(uint64_t start)
+{
+    uint8_t ss = sim_softLevel(&sim.ss, start + SIM_SS_READ);
+    uint8_t sck = sim_softLevel(&sim.sck, start + SIM_SCK_READ);
+    uint8_t mosi = sim_softLevel(&sim.mosi, start + SIM_MOSI_READ);
+    uint8_t misoBefore = (PORTC >> SOFT_MISO_PIN_PORTxn) & 0x01;
+    uint64_t cycles, misoWrite = start + SIM_MISO_WRITE;
+
+    PINC = (ss << SOFT_SS_PIN_PORTxn) | (sck << SOFT_SCK_PIN_PORTxn) | (mosi << SOFT_MOSI_PIN_PORTxn);
+    sim.now = start;
+
+    // path of the assembly routine, rxBits follows its marker bit
+    if(ss)
+    {
+        cycles = SIM_RELEASE_CYCLES;
+        sim.rxBits = 0;
+    }
+
+    else if(sck)
+    {
+        cycles = (sim.rxBits == 7) ? SIM_BYTE_CYCLES + SIM_RECEIVE_CYCLES : SIM_RISING_CYCLES;
+        sim.rxBits = (sim.rxBits + 1) % 8;
+    }
+
+    else if(sim.rxBits == 0)
+    {
+        cycles = SIM_IDLE_CYCLES;
+        misoWrite = start + SIM_MISO_WRITE_IDLE;
+    }
+
+    else
+        cycles = SIM_FALLING_CYCLES;
+
+    SOFT_PCINT_vect();
+
+    uint8_t misoAfter = (PORTC >> SOFT_MISO_PIN_PORTxn) & 0x01;
+
+    if(misoAfter != misoBefore)
+        sim_softSet(&sim.miso, misoWrite, misoAfter);
+
+    sim.cpuFree = start + cycles;
+}
+
+/**
+ * Function that runs the pending ISR routine if it starts before a cycle.
+ */
+static void sim_softService(uint64_t time)
+{
+    if(sim.pending && sim.flagStart <= time)
+    {
+        sim.pending = false;
+        sim_softHandler(sim.flagStart);
+    }
+}
+
+/**
+ * Function that sets pin change flag for an edge. Flag that is already set doesn't count the edge twice;
+ * a rising SS edge merged into a pending SCK edge is harmless, SS is read first.
+ */
+static void sim_softEdge(uint64_t time, bool sck)
+{
+    uint64_t flagTime = time + SIM_SYNC_CYCLES;
+
+    sim_softService(flagTime);
+
+    if(sim.pending)
+    {
+        if(sck)
+            sim.edgesLost++;
+
+        return;
+    }
+
+    sim.pending = true;
+
+    // main loop finishes its instruction (up to 4 cycles); after reti one main loop instruction runs
+    if(flagTime >= sim.cpuFree)
+        sim.flagStart = flagTime + rand() % 4;
+
+    else
+        sim.flagStart = sim.cpuFree + 1;
+}
+
+/**
+ * Function that clocks a transaction: master shifts out tx[] and samples MISO into rx[] on rising SCK edges.
+ *
+ * @param start cycle of falling SS edge
+ * @param halfPeriod SCK half period, in slave cycles
+ * @param gap cycles between the last falling SCK edge of a byte and the first SCK half period of the next one
+ * @return cycle after rising SS edge
+ */
+static uint64_t sim_softTransaction(uint64_t start, uint32_t halfPeriod, uint32_t gap, const uint8_t tx[], uint8_t rx[], size_t size)
+{
+    uint64_t sample[SIM_EDGES / 2];
+    uint64_t edges[SIM_EDGES * 2];
+    bool sckEdge[SIM_EDGES * 2];
+    size_t edgeCount = 0, samples = 0;
+    uint64_t t = start + SIM_SS_SETUP_CYCLES;
+
+    sim.ss.count = sim.sck.count = sim.mosi.count = 0;
+    sim_softSet(&sim.ss, start, 0);
+    sim_softSet(&sim.sck, start, 0);
+    sim_softSet(&sim.mosi, start, 1);
+    sckEdge[edgeCount] = false;
+    edges[edgeCount++] = start;
+
+    for(size_t i = 0; i < size; i++)
+    {
+        for(uint8_t bit = 0; bit < 8; bit++)
+        {
+            sim_softSet(&sim.mosi, t, (tx[i] >> (7 - bit)) & 0x01);     // master shifts out on falling edge
+
+            sim_softSet(&sim.sck, t + halfPeriod, 1);
+            sample[samples++] = t + halfPeriod;
+            sckEdge[edgeCount] = true;
+            edges[edgeCount++] = t + halfPeriod;
+
+            sim_softSet(&sim.sck, t + 2 * halfPeriod, 0);
+            sckEdge[edgeCount] = true;
+            edges[edgeCount++] = t + 2 * halfPeriod;
+
+            t += 2 * halfPeriod;
+        }
+
+        t += gap;
+    }
+
+    uint64_t end = t - gap + SIM_SS_HOLD_CYCLES;
+    sim_softSet(&sim.ss, end, 1);
+    sckEdge[edgeCount] = false;
+    edges[edgeCount++] = end;
+
+    // MISO changes of this transaction, with the level it had before it
+    uint8_t miso = (PORTC >> SOFT_MISO_PIN_PORTxn) & 0x01;
+    sim.miso.count = 0;
+    sim_softSet(&sim.miso, start, miso);
+
+    for(size_t i = 0; i < edgeCount; i++)
+        sim_softEdge(edges[i], sckEdge[i]);
+
+    sim_softService(UINT64_MAX);
+
+    // master samples MISO on rising edges
+    for(size_t i = 0; i < size; i++)
+    {
+        rx[i] = 0;
+
+        for(uint8_t bit = 0; bit < 8; bit++)
+            rx[i] = (rx[i] << 1) | sim_softLevel(&sim.miso, sample[i * 8 + bit]);
+    }
+
+    return end > sim.cpuFree ? end : sim.cpuFree;
+}
+
+/**
+ * Function that sends frames at one SCK rate and byte gap, returns number of frames with a receive or response error.
+ */
+static uint32_t sim_softRun(double sckHz, double gapUs, uint32_t frames, uint32_t *lost)
+{
+    uint32_t halfPeriod = (uint32_t)(SIM_F_CPU / sckHz / 2 + 0.5);
+    uint32_t gap = (uint32_t)(gapUs * SIM_F_CPU / 1e6);
+    uint8_t expected[RESPONSE_LENGTH] = {0};
+    bool responseQueued = false;
+    uint32_t errors = 0;
+    uint64_t t = 0;
+
+    memset(&sim, 0, sizeof(sim));
+    PINC = (1 << SOFT_SS_PIN_PORTxn);
+    PORTC = 0;
+    SPI_softSlaveInit();
+    SPI_readAll();
+
+    for(uint32_t n = 0; n < frames; n++)
+    {
+        uint8_t tx[DATA_LENGTH], rx[DATA_LENGTH];
+        size_t length = RESPONSE_LENGTH + rand() % 13;
+        bool error = false;
+
+        for(size_t i = 0; i < length; i++)
+            tx[i] = ' ' + rand() % 95;
+
+        tx[length] = DATA_END_CHAR;
+
+        t = sim_softTransaction(t, halfPeriod, gap, tx, rx, length + 1);
+        t += (uint64_t)(SIM_FRAME_GAP_US * SIM_F_CPU / 1e6);
+        sim.now = t;
+
+        // response to the previous frame was shifted out at the start of this one
+        if(responseQueued && memcmp(rx, expected, RESPONSE_LENGTH) != 0)
+            error = true;
+
+        // slave main loop: read the frame and queue a response for the next transaction
+        responseQueued = false;
+
+        if(SPI_readAll())
+        {
+            if(memcmp(SPI_data, tx, length) != 0 || SPI_data[length] != 0)
+                error = true;
+
+            expected[0] = 'R';
+            expected[1] = length;
+            expected[2] = SPI_data[0];
+            expected[3] = SPI_data[length - 1];
+            responseQueued = SPI_queueResponse(expected, RESPONSE_LENGTH);
+        }
+
+        else
+            error = true;
+
+        if(error)
+            errors++;
+    }
+
+    *lost = sim.edgesLost;
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    static const double sckRates[] = {50e3, 100e3, 125e3, 150e3, 175e3, 200e3, 225e3, 250e3, 300e3};
+    static const double gaps[] = {0, 4, 8, 12};
+    double maxReliable[sizeof(gaps) / sizeof(gaps[0])] = {0};
+    bool reliable[sizeof(gaps) / sizeof(gaps[0])];
+    uint32_t frames = 2000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n frames]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_softExchange, sim_softDelay, sim_softCycles};
+    srand(1);
+
+    for(size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++)
+        reliable[g] = true;
+
+    printf("frame errors in %u frames (edges lost)\n", frames);
+    printf("SCK_kHz  ");
+
+    for(size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++)
+        printf("gap_%-2.0fus        ", gaps[g]);
+
+    printf("\n");
+
+    for(size_t r = 0; r < sizeof(sckRates) / sizeof(sckRates[0]); r++)
+    {
+        printf("%-8.0f ", sckRates[r] / 1e3);
+
+        for(size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++)
+        {
+            uint32_t lost;
+            uint32_t errors = sim_softRun(sckRates[r], gaps[g], frames, &lost);
+            char cell[32];
+
+            snprintf(cell, sizeof(cell), "%u (%u)", errors, lost);
+            printf("%-16s ", cell);
+
+            // highest rate with every lower rate error free
+            reliable[g] = reliable[g] && (errors == 0);
+
+            if(reliable[g])
+                maxReliable[g] = sckRates[r];
+        }
+
+        printf("\n");
+    }
+
+    printf("\nmax reliable SCK:");
+
+    for(size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++)
+        printf("  %.0fkHz at %.0fus gap", maxReliable[g] / 1e3, gaps[g]);
+
+    printf("\n");
+
+    // rates that library master can generate at 16MHz with SPI_device_t.byteGap must work
+    return maxReliable[sizeof(gaps) / sizeof(gaps[0]) - 1] < 125e3;
+}
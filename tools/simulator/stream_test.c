@@ -0,0 +1,198 @@
+/**
+ * @file stream_test.c
+ * @author Lukas Ternjej
+ *
+ * Host test of point-to-point stream mode (AVR_SPI_stream.c). Master and slave run the real library in one process:
+ * every byte that master clocks out is handled by slave SPI_STC_vect right away, after the link has dropped it
+ * or flipped a bit in it at the given error rate. Every frame is checked in slave SPI_data[] after SPI_readAll().
+ * Built with SPI_USE_STREAM, master sends binary frames in one stream; built without it, master sends the same
+ * number of text frames with SPI_deviceTransmitString() and SS toggled for every frame, for comparison.
+ *
+ * @date 2026-10-18
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AVR_SPI_stream.h"
+#include "sim_node.h"
+
+#define SIM_F_CPU         16000000.0
+#define SIM_BYTE_CYCLES   (8 * 8 + 12)     // FOSC_DIV8 plus master overhead (SPDR write, SPIF poll), longer than slave ISR routine
+#define SIM_SS_CYCLES     24               // SPI_deviceSelect() and SPI_deviceRelease() calls with read-modify-write of SS port
+
+extern volatile uint8_t sim_SPDR;
+extern volatile size_t receivedBytes;
+void SPI_STC_vect(void);
+
+/**
+ * Structure that holds test state of one error rate.
+ */
+typedef struct
+{
+    double errorRate;           // probability that a byte is dropped or has a flipped bit
+    uint64_t now;               // virtual clock, in master cycles
+    uint64_t bytes;             // bytes clocked by master
+    uint32_t linkErrors;        // bytes dropped or corrupted on the link
+    uint32_t intact;            // frames received as sent
+    uint32_t corrupt;           // frames received with wrong data
+} sim_stream_t;
+
+static sim_stream_t sim;
+
+/**
+ * Function that passes a byte over the link to the slave ISR routine, with errors at sim.errorRate.
+ * Dropped and corrupted bytes are split evenly.
+ */
+static uint8_t sim_streamExchange(void *context, uint8_t mosi)
+{
+    sim.now += SIM_BYTE_CYCLES;
+    sim.bytes++;
+
+    if(rand() < sim.errorRate * ((double)RAND_MAX + 1))
+    {
+        sim.linkErrors++;
+
+        if(rand() & 1)
+            return DUMMY_CHAR;     // byte is lost, slave doesn't see it
+
+        mosi ^= 1 << (rand() % 8);
+    }
+
+    sim_SPDR = mosi;
+    SPI_STC_vect();
+
+    return DUMMY_CHAR;
+}
+
+static void sim_streamDelay(void *context, double us)
+{
+    sim.now += (uint64_t)(us * SIM_F_CPU / 1e6);
+}
+
+static uint64_t sim_streamCycles(void *context)
+{
+    return sim.now;
+}
+
+/**
+ * Function that is the slave main loop: reads a frame and compares it with the frame master has sent last.
+ * Called after every frame, so a frame that isn't read before the next one is a lost frame.
+ */
+static void sim_streamSlaveLoop(const uint8_t frame[], size_t size)
+{
+    size_t length = receivedBytes;
+
+    if(!SPI_readAll())
+        return;
+
+    if(length == size && memcmp(SPI_data, frame, size) == 0)
+        sim.intact++;
+
+    else
+        sim.corrupt++;
+}
+
+/**
+ * Function that fills a frame with random bytes. Stream frames are binary, control characters included;
+ * frames that are sent without stream mode are printable text. Frames have at least 2 bytes, so none of them
+ * is a [STATS_QUERY_CHAR] query.
+ *
+ * @return number of bytes in frame
+ */
+static size_t sim_streamFrame(uint8_t frame[])
+{
+    size_t size = 2 + rand() % (DATA_LENGTH - 3);
+
+    for(size_t i = 0; i < size; i++)
+        frame[i] = SPI_USE_STREAM ? rand() % 256 : ' ' + rand() % 95;
+
+    return size;
+}
+
+int main(int argc, char *argv[])
+{
+    static const double errorRates[] = {0, 1e-4, 1e-3, 1e-2};
+    uint32_t frames = 20000;
+    uint32_t failures = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(option)
+        {
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n frames]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_hooks = (sim_hooks_t){NULL, sim_streamExchange, sim_streamDelay, sim_streamCycles};
+
+    SPI_device_t device = {&PORTB, PB1, DEFAULT_SS_CONTROL, 0, 0};
+
+    SPI_init(SLAVE_MODE, MSB_FIRST, SPI_MODE_0, FOSC_DIV8);
+    srand(1);
+
+    printf("mode    err/byte  frames  intact  corrupt  lost  resyncs  crc_err  bytes/frame  frame_us  frames/s\n");
+
+    for(size_t r = 0; r < sizeof(errorRates) / sizeof(errorRates[0]); r++)
+    {
+        uint8_t frame[DATA_LENGTH];
+
+        memset(&sim, 0, sizeof(sim));
+        sim.errorRate = errorRates[r];
+        SPI_streamResyncs = 0;
+        SPI_streamErrors = 0;
+
+#if SPI_USE_STREAM
+        SPI_streamBegin(&device);
+#endif
+
+        for(uint32_t n = 0; n < frames; n++)
+        {
+            size_t size = sim_streamFrame(frame);
+
+#if SPI_USE_STREAM
+            SPI_streamTransmitBytes(frame, size);
+#else
+            char text[DATA_LENGTH];
+
+            memcpy(text, frame, size);
+            text[size] = '\0';
+
+            SPI_deviceTransmitString(&device, text);
+            sim.now += SIM_SS_CYCLES;
+#endif
+
+            sim_streamSlaveLoop(frame, size);
+        }
+
+#if SPI_USE_STREAM
+        SPI_streamEnd(&device);
+#endif
+
+        double frameUs = sim.now * 1e6 / SIM_F_CPU / frames;
+
+        printf("%-7s %-9g %-7u %-7u %-8u %-5u %-8u %-8u %-12.1f %-9.2f %.0f\n", SPI_USE_STREAM ? "stream" : "ss",
+               sim.errorRate, frames, sim.intact, sim.corrupt, frames - sim.intact - sim.corrupt, SPI_streamResyncs,
+               SPI_streamErrors, (double)sim.bytes / frames, frameUs, 1e6 / frameUs);
+
+        // error free link delivers every frame; in stream mode a corrupted frame passes CRC-8 with probability 1/256
+        if(sim.errorRate == 0 && sim.intact != frames)
+            failures++;
+
+        if(SPI_USE_STREAM && sim.corrupt > sim.linkErrors / 256 + 1)
+            failures++;
+    }
+
+    if(failures != 0)
+        printf("\n%u failures\n", failures);
+
+    return failures != 0;
+}